@@ -0,0 +1,364 @@
+/*!
+  Measures the cost of the wire format: encoding and decoding every type of command, and
+  the framing that parser::write_command () and parser::read_command () add on top. For
+  each operation it reports the time per operation, the amount of bytes on the wire and
+  the amount of heap allocations per operation.
+
+  Usage:
+
+  \code
+  codec [--time=milliseconds]
+  \endcode
+ */
+
+#include <stdlib.h>
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/uuid/uuid_generators.hpp>
+
+#include <paxos++/detail/command.hpp>
+#include <paxos++/detail/tcp_connection.hpp>
+#include <paxos++/detail/util/codec.hpp>
+#include <paxos++/detail/util/conversion.hpp>
+
+/*!
+  Every heap allocation inside this process goes through the operators below, which is how
+  we count the allocations of a single operation
+ */
+static std::size_t allocations = 0;
+
+void *
+operator new (
+   std::size_t  size)
+{
+   ++allocations;
+
+   void * result = malloc (size == 0 ? 1 : size);
+   if (result == NULL)
+   {
+      throw std::bad_alloc ();
+   }
+
+   return result;
+}
+
+void
+operator delete (
+   void *       pointer) noexcept
+{
+   free (pointer);
+}
+
+void
+operator delete (
+   void *       pointer,
+   std::size_t  size) noexcept
+{
+   free (pointer);
+}
+
+/*!
+  Prevents the compiler from optimizing away the results of the operations we measure
+ */
+static std::size_t volatile sink = 0;
+
+struct measurement
+{
+   double       ns_per_op;
+   double       allocations_per_op;
+};
+
+/*!
+  Runs \c operation until at least \c duration has passed, in rounds that double in size
+ */
+template <typename Operation>
+static measurement
+measure (
+   Operation                    operation,
+   std::chrono::milliseconds    duration)
+{
+   typedef std::chrono::steady_clock clock;
+
+   /*!
+     Warm up caches and the allocator before we start counting
+    */
+   operation ();
+
+   std::size_t          iterations = 0;
+   std::size_t          allocated  = 0;
+   clock::duration      elapsed    = clock::duration::zero ();
+
+   for (std::size_t round = 1; elapsed < duration; round *= 2)
+   {
+      std::size_t const         before  = allocations;
+      clock::time_point const   started = clock::now ();
+
+      for (std::size_t i = 0; i < round; ++i)
+      {
+         operation ();
+      }
+
+      elapsed    += clock::now () - started;
+      allocated  += allocations - before;
+      iterations += round;
+   }
+
+   measurement result;
+   result.ns_per_op          =
+      std::chrono::duration_cast <std::chrono::duration <double, std::nano> > (elapsed).count ()
+      / iterations;
+   result.allocations_per_op = static_cast <double> (allocated) / iterations;
+
+   return result;
+}
+
+static void
+report (
+   std::string const &  name,
+   std::string const &  operation,
+   std::size_t          bytes,
+   measurement const &  result)
+{
+   std::cout << std::left  << std::setw (28) << name
+             << std::setw (10) << operation
+             << std::right << std::setw (14) << std::fixed << std::setprecision (1) << result.ns_per_op
+             << std::setw (12) << bytes
+             << std::setw (12) << std::setprecision (2) << result.allocations_per_op
+             << std::endl;
+}
+
+static paxos::detail::command
+create (
+   enum paxos::detail::command::type    type)
+{
+   static boost::uuids::uuid const id = boost::uuids::basic_random_generator <boost::mt19937> () ();
+   static boost::asio::ip::tcp::endpoint const endpoint (
+      boost::asio::ip::address::from_string ("127.0.0.1"), 1337);
+
+   paxos::detail::command command;
+   command.set_type (type);
+
+   switch (type)
+   {
+      case paxos::detail::command::type_invalid:
+         break;
+
+      case paxos::detail::command::type_request_initiate:
+      case paxos::detail::command::type_request_read:
+      case paxos::detail::command::type_request_follower_read:
+         command.set_request_id (42);
+         command.set_next_proposal_id (1000);
+         command.set_workload (std::string (64, 'x'));
+         break;
+
+      case paxos::detail::command::type_request_prepare:
+      case paxos::detail::command::type_request_promise:
+         command.set_host_id (id);
+         command.set_host_endpoint (endpoint);
+         command.set_next_proposal_id (1000);
+         command.set_highest_proposal_id (999);
+         break;
+
+      case paxos::detail::command::type_request_fail:
+         command.set_host_id (id);
+         command.set_host_endpoint (endpoint);
+         command.set_error_code (paxos::detail::error_incorrect_proposal);
+         command.set_highest_proposal_id (999);
+         break;
+
+      case paxos::detail::command::type_request_accept:
+      case paxos::detail::command::type_request_accepted:
+         command.set_host_id (id);
+         command.set_host_endpoint (endpoint);
+         command.set_next_proposal_id (1000);
+         command.set_lowest_proposal_id (900);
+         command.add_proposed_workload (1000, std::string (64, 'x'));
+         break;
+
+      case paxos::detail::command::type_request_error:
+         command.set_request_id (42);
+         command.set_error_code (paxos::detail::error_no_leader);
+         break;
+
+      case paxos::detail::command::type_request_catch_up:
+         command.set_host_id (id);
+         command.set_host_endpoint (endpoint);
+         command.set_next_proposal_id (900);
+         command.set_highest_proposal_id (999);
+         for (int64_t i = 900; i < 1000; ++i)
+         {
+            command.add_proposed_workload (i, std::string (64, 'x'));
+         }
+         break;
+
+      case paxos::detail::command::type_request_caught_up:
+         command.set_host_id (id);
+         command.set_host_endpoint (endpoint);
+         command.set_highest_proposal_id (999);
+         break;
+
+      case paxos::detail::command::type_request_snapshot:
+         command.set_host_id (id);
+         command.set_host_endpoint (endpoint);
+         command.set_next_proposal_id (1000);
+         command.set_workload (std::string (4096, 'x'));
+         break;
+   };
+
+   return command;
+}
+
+static void
+run (
+   std::string const &                  name,
+   paxos::detail::command const &       command,
+   std::chrono::milliseconds            duration)
+{
+   std::string const encoded = paxos::detail::command::to_string (command);
+   std::size_t const bytes   = 4 + encoded.size ();
+
+   report (name, "encode", encoded.size (), measure (
+              [& command]
+              {
+                 sink = sink + paxos::detail::command::to_string (command).size ();
+              },
+              duration));
+
+   report (name, "decode", encoded.size (), measure (
+              [& encoded]
+              {
+                 sink = sink + paxos::detail::command::from_string (encoded).type ();
+              },
+              duration));
+
+   /*!
+     Same as parser::write_command (), up to the point where the frame is handed to the
+     connection
+    */
+   report (name, "frame", bytes, measure (
+              [& command]
+              {
+                 boost::shared_ptr <paxos::detail::tcp_connection::frame> frame (
+                    new paxos::detail::tcp_connection::frame ());
+
+                 frame->body = paxos::detail::command::to_string (command);
+
+                 paxos::detail::util::encoder encoder (frame->header);
+                 encoder.put_uint32 (static_cast <uint32_t> (frame->body.size ()));
+
+                 sink = sink + frame->header.size () + frame->body.size ();
+              },
+              duration));
+
+   /*!
+     Same as parser::parse_buffer (), which decodes straight from a connection's receive
+     buffer
+    */
+   std::string buffer;
+   paxos::detail::util::encoder encoder (buffer);
+   encoder.put_uint32 (static_cast <uint32_t> (encoded.size ()));
+   buffer += encoded;
+
+   report (name, "unframe", bytes, measure (
+              [& buffer]
+              {
+                 char const * data = buffer.data ();
+                 uint32_t     size = paxos::detail::util::decoder (data, 4).get_uint32 ();
+
+                 sink = sink + paxos::detail::command::from_string (data + 4, size).type ();
+              },
+              duration));
+}
+
+int main (int argc, char ** argv)
+{
+   std::chrono::milliseconds duration (200);
+
+   for (int i = 1; i < argc; ++i)
+   {
+      std::string const argument (argv[i]);
+
+      try
+      {
+         if (argument.compare (0, 7, "--time=") != 0)
+         {
+            throw boost::bad_lexical_cast ();
+         }
+
+         duration = std::chrono::milliseconds (
+            boost::lexical_cast <uint32_t> (argument.substr (7)));
+      }
+      catch (boost::bad_lexical_cast const &)
+      {
+         std::cerr << "usage: " << argv[0] << " [--time=milliseconds]" << std::endl;
+         return 1;
+      }
+   }
+
+   std::cout << std::left  << std::setw (28) << "command"
+             << std::setw (10) << "operation"
+             << std::right << std::setw (14) << "ns/op"
+             << std::setw (12) << "bytes"
+             << std::setw (12) << "allocs/op"
+             << std::endl;
+
+   static char const * names[] =
+      {
+         "invalid",
+         "request_initiate",
+         "request_prepare",
+         "request_promise",
+         "request_fail",
+         "request_accept",
+         "request_accepted",
+         "request_error",
+         "request_catch_up",
+         "request_caught_up",
+         "request_snapshot",
+         "request_read",
+         "request_follower_read"
+      };
+
+   for (int type = paxos::detail::command::type_invalid;
+        type <= paxos::detail::command::type_request_follower_read;
+        ++type)
+   {
+      run (names[type],
+           create (static_cast <enum paxos::detail::command::type> (type)),
+           duration);
+   }
+
+   /*!
+     The proposed workload of an accept grows with the batch size, see
+     configuration::set_batch_size ()
+    */
+   for (int64_t entries : {1, 100, 10000})
+   {
+      paxos::detail::command command = create (paxos::detail::command::type_request_accept);
+
+      for (int64_t i = 1; i < entries; ++i)
+      {
+         command.add_proposed_workload (1000 + i, std::string (64, 'x'));
+      }
+
+      run ("proposed_workload/" + boost::lexical_cast <std::string> (entries),
+           command,
+           duration);
+   }
+
+   report ("conversion<int64_t>", "encode", sizeof (int64_t), measure (
+              []
+              {
+                 sink = sink + paxos::detail::util::conversion::to_byte_array <int64_t> (sink).size ();
+              },
+              duration));
+
+   return 0;
+}
@@ -0,0 +1,394 @@
+/*!
+  Measures the throughput and commit latency of the consensus path. Starts an in-process
+  quorum on the loopback interface, lets a number of application threads share a single
+  client, and reports the amount of operations per second and the p50/p99/p999 latency
+  for every combination of quorum size and durable storage backend.
+
+  Usage:
+
+  \code
+  consensus [--servers=3,5,7] [--storage=heap,sqlite] [--payload=bytes]
+            [--concurrency=threads] [--requests=count] [--port=port]
+  \endcode
+ */
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <paxos++/client.hpp>
+#include <paxos++/server.hpp>
+#include <paxos++/configuration.hpp>
+#include <paxos++/durable/heap.hpp>
+
+#ifdef PAXOS_HAVE_SQLITE
+#include <paxos++/durable/sqlite.hpp>
+#endif
+
+struct options
+{
+   std::vector <uint16_t>       servers;
+   std::vector <std::string>    storage;
+   std::size_t                  payload;
+   std::size_t                  concurrency;
+   std::size_t                  requests;
+   uint16_t                     port;
+};
+
+struct result
+{
+   double                       ops_per_second;
+   uint64_t                     p50;
+   uint64_t                     p99;
+   uint64_t                     p999;
+   std::size_t                  failures;
+};
+
+static std::vector <std::string>
+split (
+   std::string const &  input)
+{
+   std::vector <std::string> output;
+   std::string::size_type    begin = 0;
+
+   while (begin <= input.size ())
+   {
+      std::string::size_type end = input.find (',', begin);
+      if (end == std::string::npos)
+      {
+         end = input.size ();
+      }
+
+      output.push_back (input.substr (begin, end - begin));
+      begin = end + 1;
+   }
+
+   return output;
+}
+
+static void
+usage (
+   char const * program)
+{
+   std::cerr << "usage: " << program
+             << " [--servers=3,5,7] [--storage=heap,sqlite] [--payload=bytes]"
+             << " [--concurrency=threads] [--requests=count] [--port=port]"
+             << std::endl;
+}
+
+static bool
+parse (
+   int                  argc,
+   char **              argv,
+   options &            opts)
+{
+   opts.servers     = {3, 5, 7};
+   opts.storage     = {"heap"};
+   opts.payload     = 64;
+   opts.concurrency = 16;
+   opts.requests    = 10000;
+   opts.port        = 1337;
+
+#ifdef PAXOS_HAVE_SQLITE
+   opts.storage.push_back ("sqlite");
+#endif
+
+   try
+   {
+      for (int i = 1; i < argc; ++i)
+      {
+         std::string const      argument (argv[i]);
+         std::string::size_type separator = argument.find ('=');
+
+         if (separator == std::string::npos)
+         {
+            return false;
+         }
+
+         std::string const      key   = argument.substr (0, separator);
+         std::string const      value = argument.substr (separator + 1);
+
+         if (key == "--servers")
+         {
+            opts.servers.clear ();
+            for (std::string const & servers : split (value))
+            {
+               opts.servers.push_back (boost::lexical_cast <uint16_t> (servers));
+            }
+         }
+         else if (key == "--storage")
+         {
+            opts.storage = split (value);
+         }
+         else if (key == "--payload")
+         {
+            opts.payload = boost::lexical_cast <std::size_t> (value);
+         }
+         else if (key == "--concurrency")
+         {
+            opts.concurrency = boost::lexical_cast <std::size_t> (value);
+         }
+         else if (key == "--requests")
+         {
+            opts.requests = boost::lexical_cast <std::size_t> (value);
+         }
+         else if (key == "--port")
+         {
+            opts.port = boost::lexical_cast <uint16_t> (value);
+         }
+         else
+         {
+            return false;
+         }
+      }
+   }
+   catch (boost::bad_lexical_cast const &)
+   {
+      return false;
+   }
+
+   for (std::string const & storage : opts.storage)
+   {
+#ifdef PAXOS_HAVE_SQLITE
+      if (storage != "heap" && storage != "sqlite")
+#else
+      if (storage != "heap")
+#endif
+      {
+         std::cerr << "unsupported storage backend: " << storage << std::endl;
+         return false;
+      }
+   }
+
+   return opts.concurrency > 0 && opts.requests > 0 && opts.servers.empty () == false;
+}
+
+/*!
+  Returns the latency below which \c fraction of all samples fall, \c samples must be sorted
+ */
+static uint64_t
+percentile (
+   std::vector <uint64_t> const &       samples,
+   double                               fraction)
+{
+   if (samples.empty () == true)
+   {
+      return 0;
+   }
+
+   std::size_t index = static_cast <std::size_t> (fraction * samples.size ());
+   return samples[std::min (index, samples.size () - 1)];
+}
+
+static std::string
+database (
+   uint16_t     port)
+{
+   return "consensus-" + boost::lexical_cast <std::string> (port) + ".sqlite";
+}
+
+static paxos::durable::storage *
+create_storage (
+   std::string const &  storage,
+   uint16_t             port)
+{
+#ifdef PAXOS_HAVE_SQLITE
+   if (storage == "sqlite")
+   {
+      remove (database (port).c_str ());
+      return new paxos::durable::sqlite (database (port));
+   }
+#endif
+
+   return new paxos::durable::heap ();
+}
+
+static result
+run (
+   options const &      opts,
+   uint16_t             servers,
+   std::string const &  storage,
+   uint16_t             port)
+{
+   paxos::server::callback_type callback =
+      [](int64_t proposal_id, std::string const & workload) -> std::string
+      {
+         return "ok";
+      };
+
+   std::vector <std::pair <std::string, uint16_t> > endpoints;
+   for (uint16_t i = 0; i < servers; ++i)
+   {
+      endpoints.push_back (std::make_pair ("127.0.0.1", port + i));
+   }
+
+   result output = {0, 0, 0, 0, 0};
+
+   {
+      /*!
+        Servers keep a reference to their configuration, so it has to outlive them
+       */
+      std::vector <paxos::configuration>                configurations (endpoints.size ());
+      std::vector <std::unique_ptr <paxos::server> >    quorum;
+
+      for (std::size_t i = 0; i < endpoints.size (); ++i)
+      {
+         configurations[i].set_durable_storage (create_storage (storage, endpoints[i].second));
+
+         quorum.emplace_back (new paxos::server (endpoints[i].first,
+                                                 endpoints[i].second,
+                                                 callback,
+                                                 configurations[i]));
+      }
+
+      for (std::unique_ptr <paxos::server> & server : quorum)
+      {
+         for (auto const & endpoint : endpoints)
+         {
+            server->add (endpoint.first, endpoint.second);
+         }
+      }
+
+      paxos::client client;
+      for (auto const & endpoint : endpoints)
+      {
+         client.add (endpoint.first, endpoint.second);
+      }
+
+      /*!
+        Ensure everyone agrees on a leader before we start measuring
+       */
+      client.send ("warmup").get ();
+
+      std::string const                 payload (opts.payload, 'x');
+      std::atomic <std::size_t>         issued (0);
+      std::atomic <std::size_t>         failures (0);
+      std::vector <uint64_t>            latencies;
+      boost::mutex                      mutex;
+
+      latencies.reserve (opts.requests);
+
+      std::chrono::steady_clock::time_point const started = std::chrono::steady_clock::now ();
+
+      boost::thread_group threads;
+      for (std::size_t thread = 0; thread < opts.concurrency; ++thread)
+      {
+         threads.create_thread (
+            [& opts, & client, & payload, & issued, & failures, & latencies, & mutex]
+            {
+               std::vector <uint64_t> samples;
+
+               while (issued++ < opts.requests)
+               {
+                  std::chrono::steady_clock::time_point const sent =
+                     std::chrono::steady_clock::now ();
+
+                  try
+                  {
+                     client.send (payload).get ();
+                  }
+                  catch (std::exception const &)
+                  {
+                     ++failures;
+                     continue;
+                  }
+
+                  samples.push_back (
+                     std::chrono::duration_cast <std::chrono::microseconds> (
+                        std::chrono::steady_clock::now () - sent).count ());
+               }
+
+               boost::mutex::scoped_lock lock (mutex);
+               latencies.insert (latencies.end (), samples.begin (), samples.end ());
+            });
+      }
+
+      threads.join_all ();
+
+      double const elapsed = std::chrono::duration_cast <std::chrono::duration <double> > (
+         std::chrono::steady_clock::now () - started).count ();
+
+      std::sort (latencies.begin (), latencies.end ());
+
+      output.ops_per_second = latencies.size () / elapsed;
+      output.p50            = percentile (latencies, 0.50);
+      output.p99            = percentile (latencies, 0.99);
+      output.p999           = percentile (latencies, 0.999);
+      output.failures       = failures;
+   }
+
+#ifdef PAXOS_HAVE_SQLITE
+   if (storage == "sqlite")
+   {
+      for (auto const & endpoint : endpoints)
+      {
+         remove (database (endpoint.second).c_str ());
+      }
+   }
+#endif
+
+   return output;
+}
+
+int main (int argc, char ** argv)
+{
+   options opts;
+
+   if (parse (argc, argv, opts) == false)
+   {
+      usage (argv[0]);
+      return 1;
+   }
+
+   std::cout << std::setw (8)  << "servers"
+             << std::setw (8)  << "storage"
+             << std::setw (9)  << "payload"
+             << std::setw (13) << "concurrency"
+             << std::setw (10) << "requests"
+             << std::setw (12) << "ops/s"
+             << std::setw (10) << "p50(us)"
+             << std::setw (10) << "p99(us)"
+             << std::setw (11) << "p999(us)"
+             << std::setw (10) << "failures"
+             << std::endl;
+
+   /*!
+     Every run gets its own range of ports, so that sockets of the previous run that
+     linger in TIME_WAIT do not get in the way
+    */
+   uint16_t port = opts.port;
+
+   for (std::string const & storage : opts.storage)
+   {
+      for (uint16_t servers : opts.servers)
+      {
+         result const output = run (opts, servers, storage, port);
+         port += servers;
+
+         std::cout << std::setw (8)  << servers
+                   << std::setw (8)  << storage
+                   << std::setw (9)  << opts.payload
+                   << std::setw (13) << opts.concurrency
+                   << std::setw (10) << opts.requests
+                   << std::setw (12) << std::fixed << std::setprecision (0) << output.ops_per_second
+                   << std::setw (10) << output.p50
+                   << std::setw (10) << output.p99
+                   << std::setw (11) << output.p999
+                   << std::setw (10) << output.failures
+                   << std::endl;
+      }
+   }
+
+   return 0;
+}
@@ -68,6 +68,12 @@ int main ()
    configuration.set_durable_storage (
       new paxos::durable::sqlite ("paxos.sqlite"));
 
+   /*!
+     Our datastore writes to disk for every operation, so make sure it doesn't stall
+     the network traffic of our server.
+    */
+   configuration.set_apply_thread (true);
+
    paxos::server server ("127.0.0.1", 1337, callback, configuration);
    server.add ("127.0.0.1", 1337);
 
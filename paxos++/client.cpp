@@ -1,3 +1,5 @@
+#include <functional>
+
 #include <boost/thread/condition.hpp>
 
 #include <boost/asio/placeholders.hpp>
@@ -13,31 +15,60 @@
 namespace paxos {
 
 client::client ()
-   : client (io_thread_.io_service ())
+   : client (default_configuration_)
+{
+}
+
+client::client (
+   paxos::configuration &       configuration)
+   : client (io_thread_.io_service (),
+             configuration)
 {
    io_thread_.launch ();
 }
 
 client::client (
    boost::asio::io_service &    io_service)
+   : client (io_service,
+             default_configuration_)
+{
+}
+
+client::client (
+   boost::asio::io_service &    io_service,
+   paxos::configuration &       configuration)
    : io_service_ (io_service),
-     quorum_ (io_service),
      request_queue_ (
         []
         (detail::client::protocol::request const &                                              request,
          detail::request_queue::queue <detail::client::protocol::request>::guard::pointer       guard)
         {
-           detail::client::protocol::initiate_request::step1 (request.byte_array_,
-                                                              request.quorum_,
-                                                              request.callback_,
-                                                              guard);
-        })
+           /*!
+             This callback runs on whichever thread pushes a request or completes one, so
+             move into the quorum's strand, which is where all responses are handled as well.
+            */
+           request.quorum_.strand ().dispatch (
+              std::bind (&detail::client::protocol::initiate_request::step1,
+                         request.byte_array_,
+                         request.type_,
+                         std::ref (request.quorum_),
+                         request.callback_,
+                         guard));
+        },
+
+        /*!
+          Requests are tagged with a request id, which allows this many of them to be in
+          flight over the connection with the leader at the same time.
+         */
+        configuration.request_window ()),
+     quorum_ (io_service)
 {
 }
 
 client::~client ()
 {
    io_thread_.stop ();
+   io_thread_.join ();
 }
 
 void
@@ -72,6 +103,41 @@ client::send (
 
    this->do_request (promise,
                      byte_array,
+                     detail::command::type_request_initiate,
+                     retries);
+   
+   return promise->get_future ();
+}
+
+std::future <std::string>
+client::read (
+   std::string const &  byte_array,
+   uint16_t             retries)
+   throw ()
+{
+   boost::shared_ptr <std::promise <std::string> > promise (
+      new std::promise <std::string> ());
+
+   this->do_request (promise,
+                     byte_array,
+                     detail::command::type_request_read,
+                     retries);
+   
+   return promise->get_future ();
+}
+
+std::future <std::string>
+client::follower_read (
+   std::string const &  byte_array,
+   uint16_t             retries)
+   throw ()
+{
+   boost::shared_ptr <std::promise <std::string> > promise (
+      new std::promise <std::string> ());
+
+   this->do_request (promise,
+                     byte_array,
+                     detail::command::type_request_follower_read,
                      retries);
    
    return promise->get_future ();
@@ -81,10 +147,11 @@ void
 client::do_request (
    boost::shared_ptr <std::promise <std::string> >      promise,
    std::string const &                                  byte_array,
+   enum detail::command::type                           type,
    uint16_t                                             retries)
 {
    request_queue_.push (
-      {byte_array, quorum_, 
+      {byte_array, type, quorum_, 
 
             /*!
               This callback handles the response we get from the paxos leader. It automatically
@@ -93,6 +160,7 @@ client::do_request (
             [this,
              promise,
              byte_array,
+             type,
              retries] (
                 boost::optional <enum detail::error_code>       error,
                 std::string const &                             response)
@@ -131,6 +199,7 @@ client::do_request (
                         [this, 
                          promise,
                          byte_array,
+                         type,
                          retries,
                          timer]
                         (boost::system::error_code const & error)
@@ -142,6 +211,7 @@ client::do_request (
                               */
                               this->do_request (promise,
                                                 byte_array,
+                                                type,
                                                 retries - 1);
                            }
                         });
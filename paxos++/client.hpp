@@ -27,7 +27,8 @@ namespace paxos {
 
   \par Thread Safety
   \e Distinct \e objects: Safe\n
-  \e Shared \e objects: Unsafe\n
+  \e Shared \e objects: Safe for send (), which many threads can call at the same time: all
+  their requests are multiplexed over a single connection with the leader.\n
 
   \par Examples
 
@@ -101,6 +102,15 @@ public:
     */
    client ();
 
+   /*!
+     \brief Opens client
+     \param configuration Runtime configuration
+
+     This constructor launches its own background thread with i/o context
+    */
+   client (
+      paxos::configuration &            configuration);
+
    /*!
      \brief Opens client
      \param io_service  Boost.Asio io_service object, which represents the link to the OS'es i/o services
@@ -108,6 +118,15 @@ public:
    client (
       boost::asio::io_service &         io_service);
 
+   /*!
+     \brief Opens client
+     \param io_service    Boost.Asio io_service object, which represents the link to the OS'es i/o services
+     \param configuration Runtime configuration
+   */
+   client (
+      boost::asio::io_service &         io_service,
+      paxos::configuration &            configuration);
+
    /*!
      \brief Destructor
      
@@ -157,22 +176,68 @@ public:
       uint16_t                  retries = 10) 
       throw ();
 
+   /*!
+     \brief Asynchronously send a read-only request to the leader and return result in a future
+     \param byte_array  Data to sent. Binary-safe.
+     \param retries     Amount of times to retry failed operations
+     \returns Future to the result
+
+     Unlike send (), the request is not proposed to the quorum, but answered by the leader
+     from its local state, see paxos::server::set_read (). The result reflects at least all
+     requests of which the result was available before this call.
+
+     \note Errors are handled the same way as by send ().
+   */
+   std::future <std::string>
+   read (
+      std::string const &       byte_array,
+      uint16_t                  retries = 10) 
+      throw ();
+
+   /*!
+     \brief Asynchronously send a read-only request to any server and return result in a future
+     \param byte_array  Data to sent. Binary-safe.
+     \param retries     Amount of times to retry failed operations
+     \returns Future to the result
+
+     Like read (), but the request is answered by the next server in turn instead of the
+     leader, which spreads reads across the quorum. The result might be stale: it reflects
+     at least all requests of which this client has received the result, but not
+     necessarily the requests of other clients.
+
+     \note Errors are handled the same way as by send ().
+   */
+   std::future <std::string>
+   follower_read (
+      std::string const &       byte_array,
+      uint16_t                  retries = 10) 
+      throw ();
+
 private:
 
    void
    do_request (
       boost::shared_ptr <std::promise <std::string> >   promise,
       std::string const &                               byte_array,
+      enum detail::command::type                        type,
       uint16_t                                          retries);
 
 private:
 
 
+   paxos::configuration                                                 default_configuration_;
    detail::io_thread                                                    io_thread_;
    boost::asio::io_service &                                            io_service_;
-   detail::quorum::client_view                                          quorum_;
    detail::request_queue::queue <detail::client::protocol::request>     request_queue_;
 
+   /*!
+     \brief Our view on the quorum
+
+     Declared after request_queue_, since the requests still pending inside this view hold
+     on to guards of that queue.
+    */
+   detail::quorum::client_view                                          quorum_;
+
 };
 
 }
@@ -10,6 +10,14 @@ namespace paxos {
 configuration::configuration ()
    : timeout_ (3000),
      majority_factor_ (0.5),
+     pipeline_window_ (1),
+     request_window_ (64),
+     batch_size_ (1),
+     batch_bytes_ (65536),
+     majority_commit_ (false),
+     apply_thread_ (false),
+     io_threads_ (1),
+     leader_leases_ (false),
      durable_storage_ (new durable::heap ()),
      strategy_factory_ (new detail::strategy::basic_paxos::factory (*this))
 {
@@ -41,6 +49,114 @@ configuration::majority_factor () const
    return majority_factor_;
 }
 
+void
+configuration::set_pipeline_window (
+   uint32_t  window)
+{
+   PAXOS_ASSERT (window > 0);
+   pipeline_window_ = window;
+}
+
+uint32_t
+configuration::pipeline_window () const
+{
+   return pipeline_window_;
+}
+
+void
+configuration::set_request_window (
+   uint32_t  window)
+{
+   PAXOS_ASSERT (window > 0);
+   request_window_ = window;
+}
+
+uint32_t
+configuration::request_window () const
+{
+   return request_window_;
+}
+
+void
+configuration::set_batch_size (
+   uint32_t  size)
+{
+   PAXOS_ASSERT (size > 0);
+   batch_size_ = size;
+}
+
+uint32_t
+configuration::batch_size () const
+{
+   return batch_size_;
+}
+
+void
+configuration::set_batch_bytes (
+   uint32_t  bytes)
+{
+   batch_bytes_ = bytes;
+}
+
+uint32_t
+configuration::batch_bytes () const
+{
+   return batch_bytes_;
+}
+
+void
+configuration::set_majority_commit (
+   bool      enabled)
+{
+   majority_commit_ = enabled;
+}
+
+bool
+configuration::majority_commit () const
+{
+   return majority_commit_;
+}
+
+void
+configuration::set_apply_thread (
+   bool      enabled)
+{
+   apply_thread_ = enabled;
+}
+
+bool
+configuration::apply_thread () const
+{
+   return apply_thread_;
+}
+
+void
+configuration::set_io_threads (
+   uint32_t  threads)
+{
+   PAXOS_ASSERT (threads > 0);
+   io_threads_ = threads;
+}
+
+uint32_t
+configuration::io_threads () const
+{
+   return io_threads_;
+}
+
+void
+configuration::set_leader_leases (
+   bool      enabled)
+{
+   leader_leases_ = enabled;
+}
+
+bool
+configuration::leader_leases () const
+{
+   return leader_leases_;
+}
+
 void
 configuration::set_strategy_factory (
    detail::strategy::factory *  factory)
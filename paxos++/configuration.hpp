@@ -36,6 +36,10 @@ public:
    /*!
      \brief Adjusts timeout (in milliseconds) before marking a host as dead
 
+     This also bounds how long a leader waits for the followers to reply to a Paxos
+     instance: a follower that has not replied in time is considered dead, and the instance
+     fails or commits without it.
+
      Default is 3000 (3 seconds)
     */
    void
@@ -65,6 +69,177 @@ public:
    double
    majority_factor () const;
 
+   /*!
+     \brief Adjusts the amount of proposals a leader can have in flight at the same time
+     \param window The maximum amount of concurrent proposals
+     \pre window > 0
+
+     Proposals are assigned consecutive proposal ids and sent to the followers back to
+     back, without waiting for the previous proposal to complete. Followers still process
+     them strictly in order.
+
+     Defaults to 1, which means a new proposal is only started once the previous one has
+     completed.
+    */
+   void
+   set_pipeline_window (
+      uint32_t  window);
+
+   /*!
+     \brief Access to the amount of proposals a leader can have in flight at the same time
+    */
+   uint32_t
+   pipeline_window () const;
+
+   /*!
+     \brief Adjusts the amount of requests a client can have in flight at the same time
+     \param window The maximum amount of concurrent requests per client
+     \pre window > 0
+
+     Requests are tagged with a request id, which allows a client to send them to the
+     leader over the same connection without waiting for earlier responses. Requests beyond
+     this window wait inside the client until an earlier request completes.
+
+     Defaults to 64
+    */
+   void
+   set_request_window (
+      uint32_t  window);
+
+   /*!
+     \brief Access to the amount of requests a client can have in flight at the same time
+    */
+   uint32_t
+   request_window () const;
+
+   /*!
+     \brief Adjusts the maximum amount of client requests a leader proposes at once
+     \param size The maximum amount of requests per proposal
+     \pre size > 0
+
+     Requests that are waiting in line while the leader's pipeline window is full are
+     batched into a single proposal. Every request is still assigned its own proposal id,
+     and followers still process every request separately.
+
+     Defaults to 1, which disables batching.
+    */
+   void
+   set_batch_size (
+      uint32_t  size);
+
+   /*!
+     \brief Access to the maximum amount of client requests a leader proposes at once
+    */
+   uint32_t
+   batch_size () const;
+
+   /*!
+     \brief Adjusts the maximum size (in bytes) of the workloads of a batch of requests
+
+     A single request that is larger than this limit is always proposed on its own.
+
+     Defaults to 65536 (64 KiB)
+    */
+   void
+   set_batch_bytes (
+      uint32_t  bytes);
+
+   /*!
+     \brief Access to the maximum size (in bytes) of the workloads of a batch of requests
+    */
+   uint32_t
+   batch_bytes () const;
+
+   /*!
+     \brief Controls whether the leader commits a proposal as soon as a majority agrees
+     \param enabled Whether majority commit is enabled
+
+     By default, the leader waits for every live server to accept a proposal before it replies
+     to the client, so a single slow server determines the latency of every request. When this
+     is enabled, the leader replies as soon as enough servers (see majority_factor ()) have
+     accepted a proposal and agree on its response. Servers that lag behind are caught up in
+     the background.
+
+     Defaults to false
+    */
+   void
+   set_majority_commit (
+      bool      enabled);
+
+   /*!
+     \brief Access to whether the leader commits a proposal as soon as a majority agrees
+    */
+   bool
+   majority_commit () const;
+
+   /*!
+     \brief Controls whether workloads are processed on a separate apply thread
+     \param enabled Whether the apply thread is enabled
+
+     By default, a server calls its processor callback on its I/O thread, so a slow
+     processor stalls all network traffic of that server. When this is enabled, accepted
+     values are stored right away, and then handed to a dedicated thread that calls the
+     processor in order; the response is sent once the workload has been processed.
+
+     Defaults to false
+    */
+   void
+   set_apply_thread (
+      bool      enabled);
+
+   /*!
+     \brief Access to whether workloads are processed on a separate apply thread
+    */
+   bool
+   apply_thread () const;
+
+   /*!
+     \brief Adjusts the amount of threads that run the I/O service of a server
+     \param threads The amount of threads
+     \pre threads > 0
+
+     Commands received from different connections are decoded in parallel, while the
+     protocol itself still handles one command at a time, in the order in which they were
+     received on each connection.
+
+     Only applies to servers that provide their own I/O service. Defaults to 1.
+    */
+   void
+   set_io_threads (
+      uint32_t  threads);
+
+   /*!
+     \brief Access to the amount of threads that run the I/O service of a server
+    */
+   uint32_t
+   io_threads () const;
+
+   /*!
+     \brief Controls whether the leader holds a lease to answer reads locally
+     \param enabled Whether leader leases are enabled
+
+     Read-only requests, see client::read (), are answered by the leader from its local
+     state, but only once it has confirmed that a majority of the quorum still considers it
+     the leader. By default, every read is confirmed with a round of 'prepare' commands.
+
+     When this is enabled, every proposal (and every such round) that a majority accepts
+     also grants the leader a lease of timeout () milliseconds, during which those servers
+     refuse any other leader. While its lease lasts, the leader answers reads right away.
+     Note that this relies on the clocks of all servers running at roughly the same rate,
+     and that it delays a leader failover by up to timeout () milliseconds.
+
+     Defaults to false
+    */
+   void
+   set_leader_leases (
+      bool      enabled);
+
+   /*!
+     \brief Access to whether the leader holds a lease to answer reads locally
+    */
+   bool
+   leader_leases () const;
+
    /*!
      \brief Adjusts the strategy used for internal paxos protocol
      \note Takes over ownership of \c factory
@@ -97,6 +272,14 @@ private:
 
    uint32_t                                             timeout_;
    double                                               majority_factor_;
+   uint32_t                                             pipeline_window_;
+   uint32_t                                             request_window_;
+   uint32_t                                             batch_size_;
+   uint32_t                                             batch_bytes_;
+   bool                                                 majority_commit_;
+   bool                                                 apply_thread_;
+   uint32_t                                             io_threads_;
+   bool                                                 leader_leases_;
 
    boost::shared_ptr <durable::storage>                 durable_storage_;
    boost::shared_ptr <detail::strategy::factory>        strategy_factory_;
@@ -1,3 +1,5 @@
+#include <functional>
+
 #include <boost/uuid/uuid_io.hpp>
 
 #include "../../util/debug.hpp"
@@ -13,11 +15,19 @@ namespace paxos { namespace detail { namespace client { namespace protocol {
 /*! static */ void
 initiate_request::step1 (      
    std::string const &                  byte_array,
+   enum detail::command::type           type,
    detail::quorum::client_view &        quorum,
    callback_type                        callback,
    queue_guard_type                     guard)
 {
-   boost::optional <boost::asio::ip::tcp::endpoint> leader = quorum.select_leader ();
+   /*!
+     Follower reads can be answered by any server, which spreads them across the quorum.
+    */
+   boost::optional <boost::asio::ip::tcp::endpoint> leader = 
+      type == command::type_request_follower_read
+      ? quorum.select_server ()
+      : quorum.select_leader ();
+
    if (leader.is_initialized () == false)
    {
       PAXOS_DEBUG ("leader.is_initialized () == false");
@@ -34,72 +44,137 @@ initiate_request::step1 (
    {
       PAXOS_DEBUG ("server.has_connection () == false");
       callback (detail::error_no_leader, "");
-      quorum.advance_leader ();
+      quorum.advance_leader (*leader);
       return;
    }
 
    PAXOS_DEBUG ("server.has_connection () == true");
    PAXOS_DEBUG ("sending request to host " << server.endpoint () << " with id = " << server.id ());
 
-   detail::tcp_connection_ptr connection = server.connection ();
+   detail::tcp_connection_ptr     connection = server.connection ();
+   boost::asio::ip::tcp::endpoint endpoint   = server.endpoint ();
  
    /*!
      Now that we have our leader's connection, let's send it our command to initiate
      the request. 
    */
    command command;
-   command.set_type (command::type_request_initiate);
+   command.set_type (type);
+   command.set_request_id (
+      quorum.add_pending_request (connection,
+                                  std::bind (&initiate_request::step2,
+                                             std::ref (quorum),
+                                             endpoint,
+                                             std::placeholders::_1,
+                                             std::placeholders::_2,
+                                             callback,
+                                             guard)));
    command.set_workload (byte_array);
+
+   if (type == command::type_request_follower_read)
+   {
+      /*!
+        The server must have processed everything we have seen the result of.
+       */
+      command.set_next_proposal_id (quorum.observed_proposal_id ());
+   }
+
    connection->write_command (command);
 
-   PAXOS_INFO ("client initiating request!");
+   PAXOS_INFO ("client initiating request with id = " << command.request_id ());
 
+   /*!
+     Every request issues a read for a single response, but since the leader can respond
+     to our requests in any order, that response does not necessarily belong to this
+     request.
+    */
    connection->read_command (
       [connection, 
-       & quorum,
-       & server,
-       callback,
-       guard] (
+       endpoint,
+       & quorum] (
           boost::optional <enum detail::error_code>     error,
           detail::command const &                       c)
       {
          if (error)
          {
+            /*!
+              The reads of all other requests pending on this connection fail as well, so
+              the first one to get here fails all of them.
+             */
+            std::vector <detail::quorum::client_view::response_callback> requests = 
+               quorum.remove_pending_requests (connection);
+
+            if (requests.empty () == true)
+            {
+               return;
+            }
+
             PAXOS_WARN ("client had problems communicating with leader: " << detail::to_string (*error));
-            quorum.connection_died (server.endpoint ());
-            quorum.advance_leader ();
+            quorum.connection_died (endpoint);
+            quorum.advance_leader (endpoint);
+
+            for (auto const & i : requests)
+            {
+               i (*error, detail::command ());
+            }
 
-            callback (*error, "");
+            return;
          }
-         else
-         {
-            quorum.lookup_server (c.host_endpoint ()).set_id (c.host_id ());
-            quorum.lookup_server (c.host_endpoint ()).set_highest_proposal_id (c.highest_proposal_id ());
 
-            switch (c.type ())
-            {
-                  case command::type_request_accepted:
-                     PAXOS_DEBUG ("received command with workload = " << c.workload () << ", "
-                                  "now calling callback!");
-                     callback (boost::none, c.workload ());
-                     break;
-                  
-                  case command::type_request_error:
-                     if (c.error_code () == detail::error_no_leader)
-                     {
-                        quorum.advance_leader ();
-                     }
-
-                     PAXOS_WARN ("request error occured");
-                     callback (c.error_code (), c.workload ());
-                     break;
-
-                  default:
-                     PAXOS_UNREACHABLE ();
-            };
+         quorum.lookup_server (c.host_endpoint ()).set_id (c.host_id ());
+         quorum.lookup_server (c.host_endpoint ()).set_highest_proposal_id (c.highest_proposal_id ());
+
+         boost::optional <detail::quorum::client_view::response_callback> request =
+            quorum.remove_pending_request (c.request_id ());
+
+         if (request.is_initialized () == false)
+         {
+            PAXOS_WARN ("received response to unknown request with id = " << c.request_id ());
+            return;
          }
+
+         (*request) (boost::none, c);
       });
 }
 
+/*! static */ void
+initiate_request::step2 (
+   detail::quorum::client_view &                quorum,
+   boost::asio::ip::tcp::endpoint const &       leader,
+   boost::optional <enum detail::error_code>    error,
+   detail::command const &                      command,
+   callback_type                                callback,
+   queue_guard_type                             guard)
+{
+   if (error)
+   {
+      callback (*error, "");
+      return;
+   }
+
+   switch (command.type ())
+   {
+         case command::type_request_accepted:
+            PAXOS_DEBUG ("received command with workload = " << command.workload () << ", "
+                         "now calling callback!");
+            quorum.observe_proposal_id (command.next_proposal_id ());
+            callback (boost::none, command.workload ());
+            break;
+                  
+         case command::type_request_error:
+            if (command.error_code () == detail::error_no_leader)
+            {
+               quorum.advance_leader (leader);
+            }
+
+            PAXOS_WARN ("request error occured");
+            callback (command.error_code (), command.workload ());
+            break;
+
+         default:
+            PAXOS_UNREACHABLE ();
+   };
+}
+
 
 }; }; }; };
@@ -9,7 +9,9 @@
 
 #include <boost/function.hpp>
 #include <boost/optional.hpp>
+#include <boost/asio/ip/tcp.hpp>
 
+#include "../../command.hpp"
 #include "../../error.hpp"
 #include "../../request_queue/queue.hpp"
 
@@ -34,19 +36,38 @@ public:
    /*!
      \brief Send request to leader
      \param byte_array  Binary data that holds the request
+     \param type        Either command::type_request_initiate, command::type_request_read or
+                        command::type_request_follower_read
      \param quorum      Quorum that contains all information
      \param callback    Callback where results are stored
      \throws exception::not_ready Thrown when the quorum doesn't have a leader yet
+
+     Must be called from within the quorum's strand. The request is tagged with a request
+     id, so that many requests can be in flight over the connection with the leader at the
+     same time; the leader's responses are matched with their requests by this id.
     */
    static void
    step1 (      
       std::string const &               byte_array,
+      enum detail::command::type        type,
       detail::quorum::client_view &     quorum,
       callback_type                     callback,
       queue_guard_type                  guard);
 
 private:   
 
+   /*!
+     \brief Handles the leader's response to a request sent by step1 ()
+    */
+   static void
+   step2 (
+      detail::quorum::client_view &             quorum,
+      boost::asio::ip::tcp::endpoint const &    leader,
+      boost::optional <enum detail::error_code> error,
+      detail::command const &                   command,
+      callback_type                             callback,
+      queue_guard_type                          guard);
+
 };
 
 }; }; }; };
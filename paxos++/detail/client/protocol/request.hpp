@@ -10,6 +10,7 @@
 #include <boost/function.hpp>
 #include <boost/optional.hpp>
 
+#include "../../command.hpp"
 #include "../../error.hpp"
 
 namespace paxos { namespace detail { namespace quorum {
@@ -24,6 +25,7 @@ namespace paxos { namespace detail { namespace client { namespace protocol {
 struct request
 {
    std::string                                                                                  byte_array_;
+   enum detail::command::type                                                                   type_;
    detail::quorum::client_view &                                                                quorum_;
    boost::function <void (boost::optional <enum detail::error_code>, std::string const &)>      callback_;
 
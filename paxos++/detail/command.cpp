@@ -1,76 +1,235 @@
-#include <sstream>
-
 #include <boost/uuid/uuid_io.hpp>
 #include <boost/uuid/string_generator.hpp>
 
+#ifdef PAXOS_TEXT_CODEC
+#include <sstream>
+
+#include <boost/serialization/map.hpp>
+#include <boost/serialization/string.hpp>
+
 #include <boost/archive/text_oarchive.hpp>
 #include <boost/archive/text_iarchive.hpp>
+#endif //! PAXOS_TEXT_CODEC
+
+#include "../exception/exception.hpp"
 
+#include "util/codec.hpp"
 #include "util/debug.hpp"
 #include "command.hpp"
 
-namespace paxos { namespace detail { 
+namespace paxos { namespace detail {
 
 
 /*! static */ std::string
 command::to_string (
    command const &      command)
 {
+#ifdef PAXOS_TEXT_CODEC
+
    std::stringstream               value;
    boost::archive::text_oarchive oa (value);
    oa << command;
 
    return value.str ();
+
+#else //! PAXOS_TEXT_CODEC
+
+   /*!
+     Since we know exactly how large the encoded command will be, we can make sure
+     that encoding a command results in only a single allocation.
+    */
+   std::string result;
+   result.reserve (command.encoded_size ());
+
+   util::encoder encoder (result);
+
+   encoder.put_uint8  (wire_version);
+   encoder.put_uint8  (command.type_);
+   encoder.put_uint8  (command.error_code_);
+
+   encoder.put_uuid     (command.host_id_);
+   encoder.put_endpoint (command.host_endpoint_);
+
+   encoder.put_int64  (command.next_proposal_id_);
+   encoder.put_int64  (command.highest_proposal_id_);
+   encoder.put_int64  (command.lowest_proposal_id_);
+
+   encoder.put_uint64 (command.request_id_);
+
+   encoder.put_bytes  (command.workload_);
+
+   encoder.put_uint32 (command.proposed_workload_.size ());
+   for (auto const & i : command.proposed_workload_)
+   {
+      encoder.put_int64 (i.first);
+      encoder.put_bytes (i.second);
+   }
+
+   PAXOS_ASSERT_EQ (result.size (), command.encoded_size ());
+
+   return result;
+
+#endif //! PAXOS_TEXT_CODEC
 }
 
 
 /*! static */ command
 command::from_string (
    std::string const &  string)
+{
+   return from_string (string.data (),
+                       string.size ());
+}
+
+/*! static */ command
+command::from_string (
+   char const *         data,
+   std::size_t          size)
 {
    command ret;
 
-   std::stringstream value (string);
+#ifdef PAXOS_TEXT_CODEC
+
+   std::stringstream value (std::string (data, size));
    boost::archive::text_iarchive ia (value);
    ia >> ret;
 
+#else //! PAXOS_TEXT_CODEC
+
+   util::decoder decoder (data, size);
+
+   PAXOS_CHECK_THROW (decoder.get_uint8 () != wire_version, exception::protocol_error ());
+
+   uint8_t type             = decoder.get_uint8 ();
+   uint8_t error_code       = decoder.get_uint8 ();
+
+   /*!
+     Values outside of our enums would otherwise end up in places that assume every value
+     has been handled.
+    */
+   PAXOS_CHECK_THROW (type > type_request_follower_read, exception::protocol_error ());
+   PAXOS_CHECK_THROW (error_code > error_no_majority, exception::protocol_error ());
+
+   ret.type_                = static_cast <enum type> (type);
+   ret.error_code_          = static_cast <enum error_code> (error_code);
+
+   ret.host_id_             = decoder.get_uuid ();
+   ret.host_endpoint_       = decoder.get_endpoint ();
+
+   ret.next_proposal_id_    = decoder.get_int64 ();
+   ret.highest_proposal_id_ = decoder.get_int64 ();
+   ret.lowest_proposal_id_  = decoder.get_int64 ();
+
+   ret.request_id_          = decoder.get_uint64 ();
+
+   decoder.get_bytes (ret.workload_);
+
+   uint32_t count = decoder.get_uint32 ();
+   for (uint32_t i = 0; i < count; ++i)
+   {
+      int64_t proposal_id = decoder.get_int64 ();
+
+      /*!
+        Since ids are encoded in ascending order, we can always hint the insert at the end
+        of the map.
+       */
+      auto pos = ret.proposed_workload_.insert (ret.proposed_workload_.end (),
+                                                std::make_pair (proposal_id, std::string ()));
+      decoder.get_bytes (pos->second);
+   }
+
+   PAXOS_CHECK_THROW (decoder.remaining () != 0, exception::protocol_error ());
+
+#endif //! PAXOS_TEXT_CODEC
+
    return ret;
 }
 
 
-void
-command::set_host_id (
-   boost::uuids::uuid const &        id)
+std::size_t
+command::encoded_size () const
 {
-   std::stringstream str;
-   str << id;
-
-   host_id_ = str.str ();
+   std::size_t size =
+      3 * sizeof (uint8_t)
+      + host_id_.size ()
+      + util::encoder::endpoint_size (host_endpoint_)
+      + 3 * sizeof (int64_t)
+      + sizeof (uint64_t)
+      + util::encoder::bytes_size (workload_)
+      + sizeof (uint32_t);
+
+   for (auto const & i : proposed_workload_)
+   {
+      size += sizeof (int64_t) + util::encoder::bytes_size (i.second);
+   }
+
+   return size;
 }
 
-boost::uuids::uuid
-command::host_id () const
+
+template <class Archive>
+void
+command::save (
+   Archive &                 ar,
+   unsigned int const        version) const
 {
-   boost::uuids::string_generator gen;
-   return gen (host_id_);
+   /*!
+     The text archive is a debugging aid, so we write the host information in its
+     human-readable form.
+    */
+   std::string host_id      = boost::uuids::to_string (host_id_);
+   std::string host_address = host_endpoint_.address ().to_string ();
+   uint16_t    host_port    = host_endpoint_.port ();
+
+   ar & type_;
+   ar & error_code_;
+
+   ar & host_id;
+   ar & host_address;
+   ar & host_port;
+
+   ar & next_proposal_id_;
+   ar & highest_proposal_id_;
+   ar & lowest_proposal_id_;
+
+   ar & request_id_;
+
+   ar & workload_;
+   ar & proposed_workload_;
 }
 
+template <class Archive>
 void
-command::set_host_endpoint (
-   boost::asio::ip::tcp::endpoint const &       endpoint)
+command::load (
+   Archive &                 ar,
+   unsigned int const        version)
 {
-   host_address_ = endpoint.address ().to_string ();
-   host_port_    = endpoint.port ();
-}
+   std::string host_id;
+   std::string host_address;
+   uint16_t    host_port;
 
+   ar & type_;
+   ar & error_code_;
 
-boost::asio::ip::tcp::endpoint
-command::host_endpoint () const
-{
-   return boost::asio::ip::tcp::endpoint (boost::asio::ip::address::from_string (host_address_), 
-                                          host_port_);
+   ar & host_id;
+   ar & host_address;
+   ar & host_port;
+
+   ar & next_proposal_id_;
+   ar & highest_proposal_id_;
+   ar & lowest_proposal_id_;
+
+   ar & request_id_;
+
+   ar & workload_;
+   ar & proposed_workload_;
+
+   host_id_       = boost::uuids::string_generator () (host_id);
+   host_endpoint_ = boost::asio::ip::tcp::endpoint (
+      boost::asio::ip::address::from_string (host_address), host_port);
 }
 
+
 void
 command::add_proposed_workload (
    int64_t              proposal_id,
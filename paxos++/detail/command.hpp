@@ -5,13 +5,19 @@
 #ifndef LIBPAXOS_CPP_DETAIL_PROTOCOL_COMMAND_HPP
 #define LIBPAXOS_CPP_DETAIL_PROTOCOL_COMMAND_HPP
 
+#include <stdint.h>
+
+#include <map>
+#include <string>
+
 #include <boost/function.hpp>
 #include <boost/uuid/uuid.hpp>
+#include <boost/uuid/nil_generator.hpp>
 #include <boost/asio/ip/address.hpp>
 #include <boost/asio/ip/tcp.hpp>
 
 #include <boost/serialization/access.hpp>
-#include <boost/serialization/map.hpp>
+#include <boost/serialization/split_member.hpp>
 
 #include "quorum/server.hpp"
 
@@ -53,7 +59,35 @@ public:
 
 
       //! Sent back to client when an error has occured. This will mean that error_code is also set
-      type_request_error
+      type_request_error,
+
+
+      //! Sent by leader to a follower that lags behind, outside of any proposal, with a range of history
+      type_request_catch_up,
+
+      //! Sent by a follower to the leader after it has processed a range of history
+      type_request_caught_up,
+
+      /*!
+        Sent by leader to a follower that lags behind on history that is no longer available.
+        The workload contains a snapshot of the leader's state at next_proposal_id, optionally
+        followed by the history since.
+       */
+      type_request_snapshot,
+
+      /*!
+        Sent by a client to the leader for a read-only request, which the leader answers from
+        its local state once it has confirmed it is still the leader
+       */
+      type_request_read,
+
+      /*!
+        Sent by a client to any server for a read-only request, which the server answers from
+        its local state once it has processed next_proposal_id
+
+        This must remain the last type, see from_string ().
+       */
+      type_request_follower_read
    };
 
 
@@ -64,10 +98,39 @@ public:
     */
    command ();
 
+   /*!
+     \brief Version of the binary wire format written by to_string ()
+
+     This is the first byte of every encoded command; from_string () refuses to decode
+     commands with a different version.
+    */
+   static uint8_t const wire_version = 2;
+
+   /*!
+     \brief Decodes command from its wire representation
+     \throws exception::protocol_error Thrown when \c string is not a valid command
+    */
    static command
    from_string (
       std::string const &               string);
 
+   /*!
+     \brief Decodes command from a block of memory, without copying the block first
+     \throws exception::protocol_error Thrown when the block is not a valid command
+    */
+   static command
+   from_string (
+      char const *                      data,
+      std::size_t                       size);
+
+   /*!
+     \brief Encodes command into its wire representation
+
+     By default this uses a compact, versioned binary format with fixed-width integers.
+     When libpaxos-cpp is configured with --enable-text-codec, a Boost.Serialization text
+     archive is used instead, which is slow but human-readable. Note that all hosts inside
+     the quorum must use the same format.
+    */
    static std::string
    to_string (
       command const &                   command);
@@ -136,6 +199,23 @@ public:
    lowest_proposal_id () const;
 
 
+   /*!
+     \brief Sets the id a client assigned to its request
+
+     The leader copies this id into its response, which allows a client to have multiple
+     requests in flight over the same connection, of which the responses may arrive in
+     any order.
+    */
+   void
+   set_request_id (
+      uint64_t                  request_id);
+
+   /*!
+     \brief The id a client assigned to its request
+    */
+   uint64_t
+   request_id () const;
+
    /*!
      \brief Sets a single workload entry
 
@@ -176,24 +256,38 @@ public:
 
 private:
 
+   /*!
+     \brief Exact amount of bytes the binary encoding of this command occupies
+    */
+   std::size_t
+   encoded_size () const;
+
    template <class Archive>
-   void serialize (
+   void save (
+      Archive &                 ar,
+      unsigned int const        version) const;
+
+   template <class Archive>
+   void load (
       Archive &                 ar,
       unsigned int const        version);
+
+   BOOST_SERIALIZATION_SPLIT_MEMBER ()
    
 private:
 
    enum type                                            type_;
    enum detail::error_code                              error_code_;
 
-   std::string                                          host_id_;
-   std::string                                          host_address_;
-   uint16_t                                             host_port_;
+   boost::uuids::uuid                                   host_id_;
+   boost::asio::ip::tcp::endpoint                       host_endpoint_;
 
    int64_t                                              next_proposal_id_;
    int64_t                                              highest_proposal_id_;
    int64_t                                              lowest_proposal_id_;
 
+   uint64_t                                             request_id_;
+
    std::string                                          workload_;
    std::map <int64_t, std::string>                      proposed_workload_;
 };
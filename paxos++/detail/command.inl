@@ -4,9 +4,11 @@ namespace paxos { namespace detail {
 inline command::command ()
    : type_ (type_invalid),
      error_code_ (no_error),
+     host_id_ (boost::uuids::nil_uuid ()),
      next_proposal_id_ (-1),
      highest_proposal_id_ (-1),
-     lowest_proposal_id_ (-1)
+     lowest_proposal_id_ (-1),
+     request_id_ (0)
 {
 }
 
@@ -77,6 +79,19 @@ command::lowest_proposal_id () const
    return lowest_proposal_id_;
 }
 
+inline void
+command::set_request_id (
+   uint64_t    request_id)
+{
+   request_id_ = request_id;
+}
+
+inline uint64_t
+command::request_id () const
+{
+   return request_id_;
+}
+
 inline void
 command::set_workload (
    std::string const &       byte_array)
@@ -104,26 +119,30 @@ command::proposed_workload () const
    return proposed_workload_;
 }
 
-
-template <class Archive>
 inline void
-command::serialize (
-   Archive &                 ar,
-   unsigned int const        version) 
+command::set_host_id (
+   boost::uuids::uuid const &   id)
 {
-   ar & type_;
-   ar & error_code_;
+   host_id_ = id;
+}
 
-   ar & host_id_;
-   ar & host_address_;
-   ar & host_port_;
+inline boost::uuids::uuid
+command::host_id () const
+{
+   return host_id_;
+}
 
-   ar & next_proposal_id_;
-   ar & highest_proposal_id_;
-   ar & lowest_proposal_id_;
+inline void
+command::set_host_endpoint (
+   boost::asio::ip::tcp::endpoint const &       endpoint)
+{
+   host_endpoint_ = endpoint;
+}
 
-   ar & workload_;
-   ar & proposed_workload_;
+inline boost::asio::ip::tcp::endpoint
+command::host_endpoint () const
+{
+   return host_endpoint_;
 }
 
 
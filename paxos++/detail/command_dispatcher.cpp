@@ -35,6 +35,20 @@ command_dispatcher::dispatch_command (
                });
             break;
 
+         case command::type_request_read:
+            state.strategy ().read (connection,
+                                    command,
+                                    quorum,
+                                    state);
+            break;
+
+         case command::type_request_follower_read:
+            state.strategy ().follower_read (connection,
+                                             command,
+                                             quorum,
+                                             state);
+            break;
+
          case command::type_request_prepare:
             state.strategy ().prepare (connection,
                                        command,
@@ -49,11 +63,22 @@ command_dispatcher::dispatch_command (
                                       state);
             break;
 
+         case command::type_request_catch_up:
+         case command::type_request_snapshot:
+            state.strategy ().catch_up (connection,
+                                        command,
+                                        quorum,
+                                        state);
+            break;
+
          default:
             /*!
-              This means an unexpected command was received!
+              This means an unexpected command was received! There is no way to tell what
+              the other side expects from us, so treat it as a protocol error.
              */
-            PAXOS_UNREACHABLE ();
+            PAXOS_WARN ("received unexpected command of type " << command.type () << ", closing connection");
+            connection->close ();
+            break;
    };
 };
 
@@ -43,6 +43,8 @@ enum error_code
    /*!
      This error is sent back when there is no majority of servers arelive; for more information
      on why this error is sent, see the description of paxos::exception::no_majority
+
+     This must remain the last error, see command::from_string ().
     */
    error_no_majority
 };
@@ -12,11 +12,14 @@ io_thread::io_thread ()
 }
 
 void
-io_thread::launch ()
+io_thread::launch (
+   std::size_t          threads)
 {
-   thread_ = std::move (
-      boost::thread (std::bind (&io_thread::run,
-                                this)));
+   for (std::size_t i = 0; i < threads; ++i)
+   {
+      threads_.create_thread (std::bind (&io_thread::run,
+                                         this));
+   }
 }
 
 void
@@ -29,7 +32,7 @@ io_thread::run ()
 void
 io_thread::join ()
 {
-   thread_.join ();
+   threads_.join_all ();
 }
 
 void
@@ -12,7 +12,7 @@
 namespace paxos { namespace detail {
 
 /*!
-  \brief Helper class which provides its own I/O context and worker thread
+  \brief Helper class which provides its own I/O context and worker threads
  */
 class io_thread
 {
@@ -27,10 +27,12 @@ public:
    io_service ();
 
    /*!
-     \brief Launches background thread which continues
+     \brief Launches background threads which all run io_service ()
+     \param threads The amount of threads to launch
     */
    void
-   launch ();
+   launch (
+      std::size_t       threads = 1);
 
    /*!
      \brief Thread control function
@@ -39,20 +41,20 @@ public:
    run ();
 
    /*!
-     \brief Blocks until thread_ has exited
+     \brief Blocks until all threads_ have exited
     */
    void
    join ();
 
    /*!
-     \brief Stops thread, if any
+     \brief Stops threads, if any
     */
    void
    stop ();
 
 private:
 
-   boost::thread                        thread_;
+   boost::thread_group                  threads_;
    boost::asio::io_service              io_service_;
    boost::asio::io_service::work        work_;
 };
@@ -0,0 +1,43 @@
+/*!
+  Copyright (c) 2012, Leon Mergen, all rights reserved.
+ */
+
+#ifndef LIBPAXOS_CPP_DETAIL_METRICS_COUNTER_HPP
+#define LIBPAXOS_CPP_DETAIL_METRICS_COUNTER_HPP
+
+#include <stdint.h>
+
+#include <atomic>
+
+#include <boost/noncopyable.hpp>
+
+namespace paxos { namespace detail { namespace metrics {
+
+/*!
+  \brief Value that only ever increases
+
+  Can be updated by many threads at the same time without taking a lock.
+ */
+class counter : private boost::noncopyable
+{
+public:
+
+   counter ();
+
+   void
+   add (
+      uint64_t          amount = 1);
+
+   uint64_t
+   value () const;
+
+private:
+
+   std::atomic <uint64_t>       value_;
+};
+
+}; }; };
+
+#include "counter.inl"
+
+#endif  //! LIBPAXOS_CPP_DETAIL_METRICS_COUNTER_HPP
@@ -0,0 +1,21 @@
+namespace paxos { namespace detail { namespace metrics {
+
+inline counter::counter ()
+   : value_ (0)
+{
+}
+
+inline void
+counter::add (
+   uint64_t             amount)
+{
+   value_.fetch_add (amount, std::memory_order_relaxed);
+}
+
+inline uint64_t
+counter::value () const
+{
+   return value_.load (std::memory_order_relaxed);
+}
+
+}; }; };
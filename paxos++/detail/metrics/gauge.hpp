@@ -0,0 +1,47 @@
+/*!
+  Copyright (c) 2012, Leon Mergen, all rights reserved.
+ */
+
+#ifndef LIBPAXOS_CPP_DETAIL_METRICS_GAUGE_HPP
+#define LIBPAXOS_CPP_DETAIL_METRICS_GAUGE_HPP
+
+#include <stdint.h>
+
+#include <atomic>
+
+#include <boost/noncopyable.hpp>
+
+namespace paxos { namespace detail { namespace metrics {
+
+/*!
+  \brief Value that goes up and down
+
+  Can be updated by many threads at the same time without taking a lock.
+ */
+class gauge : private boost::noncopyable
+{
+public:
+
+   gauge ();
+
+   void
+   set (
+      int64_t           value);
+
+   void
+   add (
+      int64_t           amount);
+
+   int64_t
+   value () const;
+
+private:
+
+   std::atomic <int64_t>        value_;
+};
+
+}; }; };
+
+#include "gauge.inl"
+
+#endif  //! LIBPAXOS_CPP_DETAIL_METRICS_GAUGE_HPP
@@ -0,0 +1,28 @@
+namespace paxos { namespace detail { namespace metrics {
+
+inline gauge::gauge ()
+   : value_ (0)
+{
+}
+
+inline void
+gauge::set (
+   int64_t              value)
+{
+   value_.store (value, std::memory_order_relaxed);
+}
+
+inline void
+gauge::add (
+   int64_t              amount)
+{
+   value_.fetch_add (amount, std::memory_order_relaxed);
+}
+
+inline int64_t
+gauge::value () const
+{
+   return value_.load (std::memory_order_relaxed);
+}
+
+}; }; };
@@ -0,0 +1,118 @@
+#include <limits>
+
+#include "../util/debug.hpp"
+
+#include "histogram.hpp"
+
+namespace paxos { namespace detail { namespace metrics {
+
+/*! static */ std::size_t const histogram::sub_bucket_bits;
+/*! static */ std::size_t const histogram::sub_buckets;
+/*! static */ std::size_t const histogram::buckets;
+
+histogram::histogram ()
+   : count_ (0),
+     sum_ (0),
+     min_ (std::numeric_limits <uint64_t>::max ()),
+     max_ (0)
+{
+   for (std::size_t i = 0; i < buckets; ++i)
+   {
+      counts_[i].store (0, std::memory_order_relaxed);
+   }
+}
+
+void
+histogram::record (
+   uint64_t                             value)
+{
+   counts_[bucket (value)].fetch_add (1, std::memory_order_relaxed);
+   count_.fetch_add (1, std::memory_order_relaxed);
+   sum_.fetch_add (value, std::memory_order_relaxed);
+
+   uint64_t current = min_.load (std::memory_order_relaxed);
+   while (value < current
+          && min_.compare_exchange_weak (current, value, std::memory_order_relaxed) == false)
+   {
+   }
+
+   current = max_.load (std::memory_order_relaxed);
+   while (value > current
+          && max_.compare_exchange_weak (current, value, std::memory_order_relaxed) == false)
+   {
+   }
+}
+
+void
+histogram::record_since (
+   std::chrono::steady_clock::time_point        started)
+{
+   this->record (
+      std::chrono::duration_cast <std::chrono::microseconds> (
+         std::chrono::steady_clock::now () - started).count ());
+}
+
+paxos::metrics::histogram
+histogram::snapshot () const
+{
+   paxos::metrics::histogram result;
+
+   for (std::size_t i = 0; i < buckets; ++i)
+   {
+      uint64_t count = counts_[i].load (std::memory_order_relaxed);
+
+      if (count > 0)
+      {
+         result.buckets.push_back (std::make_pair (upper_bound (i), count));
+         result.count += count;
+      }
+   }
+
+   if (result.count > 0)
+   {
+      result.sum = sum_.load (std::memory_order_relaxed);
+      result.min = min_.load (std::memory_order_relaxed);
+      result.max = max_.load (std::memory_order_relaxed);
+   }
+
+   return result;
+}
+
+/*! static */ std::size_t
+histogram::bucket (
+   uint64_t                             value)
+{
+   if (value < sub_buckets)
+   {
+      return static_cast <std::size_t> (value);
+   }
+
+   /*!
+     Position of the most significant bit, which is at least sub_bucket_bits; the bits right
+     below it select the bucket within this power of two.
+    */
+   std::size_t const exponent = 63 - __builtin_clzll (value);
+   std::size_t const shift    = exponent - sub_bucket_bits;
+
+   return ((exponent - sub_bucket_bits + 1) << sub_bucket_bits)
+      + static_cast <std::size_t> ((value >> shift) & (sub_buckets - 1));
+}
+
+/*! static */ uint64_t
+histogram::upper_bound (
+   std::size_t                          bucket)
+{
+   PAXOS_ASSERT (bucket < buckets);
+
+   if (bucket < sub_buckets)
+   {
+      return bucket;
+   }
+
+   std::size_t const shift = (bucket >> sub_bucket_bits) - 1;
+   uint64_t const    lower = static_cast <uint64_t> (sub_buckets + (bucket & (sub_buckets - 1))) << shift;
+
+   return lower + ((static_cast <uint64_t> (1) << shift) - 1);
+}
+
+}; }; };
@@ -0,0 +1,85 @@
+/*!
+  Copyright (c) 2012, Leon Mergen, all rights reserved.
+ */
+
+#ifndef LIBPAXOS_CPP_DETAIL_METRICS_HISTOGRAM_HPP
+#define LIBPAXOS_CPP_DETAIL_METRICS_HISTOGRAM_HPP
+
+#include <stdint.h>
+
+#include <atomic>
+#include <chrono>
+
+#include <boost/noncopyable.hpp>
+
+#include "../../metrics.hpp"
+
+namespace paxos { namespace detail { namespace metrics {
+
+/*!
+  \brief Distribution of values, such as latencies
+
+  Values below 16 each have their own bucket. Every power of two above that is divided into
+  16 buckets of equal width, which keeps the error of each value below 1/16th, while a
+  fixed amount of buckets covers the full range of 64 bits. This is the same scheme HDR
+  histograms use.
+
+  Can be updated by many threads at the same time without taking a lock.
+ */
+class histogram : private boost::noncopyable
+{
+public:
+
+   histogram ();
+
+   void
+   record (
+      uint64_t                                  value);
+
+   /*!
+     \brief Records the amount of microseconds that have passed since \c started
+
+     A monotonic clock is used, so that adjusting the wall clock does not distort our
+     measurements.
+    */
+   void
+   record_since (
+      std::chrono::steady_clock::time_point     started);
+
+   /*!
+     \brief Copies the current distribution
+
+     Values that are recorded while a copy is taken might be partially included.
+    */
+   paxos::metrics::histogram
+   snapshot () const;
+
+private:
+
+   static std::size_t
+   bucket (
+      uint64_t                                  value);
+
+   /*!
+     \brief Returns the largest value that is counted in \c bucket
+    */
+   static uint64_t
+   upper_bound (
+      std::size_t                               bucket);
+
+private:
+
+   static std::size_t const     sub_bucket_bits = 4;
+   static std::size_t const     sub_buckets     = 1 << sub_bucket_bits;
+   static std::size_t const     buckets         = (64 - sub_bucket_bits + 1) * sub_buckets;
+
+   std::atomic <uint64_t>       counts_[buckets];
+   std::atomic <uint64_t>       count_;
+   std::atomic <uint64_t>       sum_;
+   std::atomic <uint64_t>       min_;
+   std::atomic <uint64_t>       max_;
+};
+
+}; }; };
+
+#endif  //! LIBPAXOS_CPP_DETAIL_METRICS_HISTOGRAM_HPP
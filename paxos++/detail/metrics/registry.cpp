@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <sstream>
+
+#include "../tcp_connection.hpp"
+
+#include "registry.hpp"
+
+namespace paxos { namespace detail { namespace metrics {
+
+metrics::counter &
+registry::lookup_counter (
+   std::string const &  name)
+{
+   boost::mutex::scoped_lock lock (mutex_);
+   return lookup (counters_, name);
+}
+
+metrics::gauge &
+registry::lookup_gauge (
+   std::string const &  name)
+{
+   boost::mutex::scoped_lock lock (mutex_);
+   return lookup (gauges_, name);
+}
+
+metrics::histogram &
+registry::lookup_histogram (
+   std::string const &  name)
+{
+   boost::mutex::scoped_lock lock (mutex_);
+   return lookup (histograms_, name);
+}
+
+template <typename Type>
+/*! static */ Type &
+registry::lookup (
+   std::map <std::string, boost::shared_ptr <Type> > &  metrics,
+   std::string const &                                  name)
+{
+   boost::shared_ptr <Type> & result = metrics[name];
+
+   if (!result)
+   {
+      result.reset (new Type ());
+   }
+
+   return *result;
+}
+
+void
+registry::add_connection (
+   tcp_connection_ptr   connection)
+{
+   boost::system::error_code error;
+   boost::asio::ip::tcp::endpoint endpoint = connection->socket ().remote_endpoint (error);
+
+   if (error)
+   {
+      /*!
+        The connection has been closed already, there is nothing left to measure.
+       */
+      return;
+   }
+
+   std::ostringstream name;
+   name << endpoint;
+
+   boost::mutex::scoped_lock lock (mutex_);
+
+   /*!
+     Forget about the connections that are gone, so that short-lived client connections do
+     not pile up.
+    */
+   connections_.erase (
+      std::remove_if (connections_.begin (),
+                      connections_.end (),
+                      [] (std::pair <std::string, boost::weak_ptr <tcp_connection> > const & i)
+                      {
+                         return i.second.expired ();
+                      }),
+      connections_.end ());
+
+   connections_.push_back (std::make_pair (name.str (),
+                                           boost::weak_ptr <tcp_connection> (connection)));
+}
+
+paxos::metrics
+registry::snapshot ()
+{
+   paxos::metrics result;
+
+   boost::mutex::scoped_lock lock (mutex_);
+
+   for (auto const & i : counters_)
+   {
+      result.counters[i.first] = i.second->value ();
+   }
+
+   for (auto const & i : gauges_)
+   {
+      result.gauges[i.first] = i.second->value ();
+   }
+
+   for (auto const & i : histograms_)
+   {
+      result.histograms[i.first] = i.second->snapshot ();
+   }
+
+   for (auto const & i : connections_)
+   {
+      tcp_connection_ptr connection = i.second.lock ();
+
+      if (connection)
+      {
+         result.counters["connection." + i.first + ".bytes_in"]  += connection->bytes_read ();
+         result.counters["connection." + i.first + ".bytes_out"] += connection->bytes_written ();
+      }
+   }
+
+   return result;
+}
+
+}; }; };
@@ -0,0 +1,90 @@
+/*!
+  Copyright (c) 2012, Leon Mergen, all rights reserved.
+ */
+
+#ifndef LIBPAXOS_CPP_DETAIL_METRICS_REGISTRY_HPP
+#define LIBPAXOS_CPP_DETAIL_METRICS_REGISTRY_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include "../../metrics.hpp"
+#include "../tcp_connection_fwd.hpp"
+
+#include "counter.hpp"
+#include "gauge.hpp"
+#include "histogram.hpp"
+
+namespace paxos { namespace detail { namespace metrics {
+
+/*!
+  \brief Keeps track of all metrics of a single paxos::server
+
+  Metrics are created the first time they are looked up, and live as long as the registry
+  does. Looking up a metric takes a lock, so callers on a hot path look up a metric once and
+  hold on to the reference: updating the metric itself never takes a lock.
+ */
+class registry : private boost::noncopyable
+{
+public:
+
+   metrics::counter &
+   lookup_counter (
+      std::string const &       name);
+
+   metrics::gauge &
+   lookup_gauge (
+      std::string const &       name);
+
+   metrics::histogram &
+   lookup_histogram (
+      std::string const &       name);
+
+   /*!
+     \brief Reports the amount of bytes received and sent over \c connection for as long
+            as it lives
+    */
+   void
+   add_connection (
+      tcp_connection_ptr        connection);
+
+   /*!
+     \brief Copies the current value of all metrics
+    */
+   paxos::metrics
+   snapshot ();
+
+private:
+
+   template <typename Type>
+   static Type &
+   lookup (
+      std::map <std::string, boost::shared_ptr <Type> > &       metrics,
+      std::string const &                                       name);
+
+private:
+
+   /*!
+     \brief Synchronizes access to all members below
+    */
+   boost::mutex                                                         mutex_;
+
+   std::map <std::string, boost::shared_ptr <metrics::counter> >        counters_;
+   std::map <std::string, boost::shared_ptr <metrics::gauge> >          gauges_;
+   std::map <std::string, boost::shared_ptr <metrics::histogram> >      histograms_;
+
+   /*!
+     \brief Connections added by add_connection (), by the name of the remote endpoint
+    */
+   std::vector <std::pair <std::string, boost::weak_ptr <tcp_connection> > >    connections_;
+};
+
+}; }; };
+
+#endif  //! LIBPAXOS_CPP_DETAIL_METRICS_REGISTRY_HPP
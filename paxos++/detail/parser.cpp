@@ -1,6 +1,13 @@
-#include <boost/asio/read.hpp>
+#include <string.h>
 
-#include "util/conversion.hpp"
+#include <algorithm>
+#include <functional>
+
+#include <boost/asio/io_service.hpp>
+
+#include "../exception/exception.hpp"
+
+#include "util/codec.hpp"
 #include "util/debug.hpp"
 
 #include "tcp_connection.hpp"
@@ -15,99 +22,211 @@ parser::write_command (
    tcp_connection_ptr   connection,
    command const &      command)
 {
-   std::string binary_string = command::to_string (command);
-   uint32_t size             = binary_string.size ();
+   boost::shared_ptr <tcp_connection::frame> frame (new tcp_connection::frame ());
+
+   frame->body = command::to_string (command);
+
+   util::encoder encoder (frame->header);
+   encoder.put_uint32 (static_cast <uint32_t> (frame->body.size ()));
 
-   std::string buffer        = util::conversion::to_byte_array (size) + binary_string;
+   connection->bytes_written_.fetch_add (frame->header.size () + frame->body.size (),
+                                         std::memory_order_relaxed);
 
-   connection->write (buffer);
+   connection->write (frame);
 }
 
 
+/*! static */ std::size_t const parser::receive_buffer_size;
+
+
 /*! static */ void
 parser::read_command (
    tcp_connection_ptr   connection,
    callback_function    callback)
 {
-   boost::shared_array <char> buffer (new char[4]);
-
-   PAXOS_DEBUG ("reading command size from connection = " << connection.get ());
-
-   boost::asio::async_read (
-      connection->socket (), 
-      boost::asio::buffer (buffer.get (), 4), 
-      std::bind (&parser::read_command_parse_size,
-                   
-                 connection,
-                   
-                 std::placeholders::_1,
-                 std::placeholders::_2,
-                   
-                 buffer,
-                   
-                 callback));
+   boost::optional <command> result;
+
+   if (parse_buffer (*connection,
+                     result) == true)
+   {
+      /*!
+        A previous read already received this command. We are usually called while another
+        command is about to be dispatched, so post the callback to ensure commands are always
+        dispatched in the order they were received.
+       */
+      connection->strand ().post (
+         std::bind (&parser::dispatch,
+                    result,
+                    callback));
+      return;
+   }
+
+   read_some (connection,
+              callback);
 }
 
 /*! static */ void
-parser::read_command_parse_size (
-   tcp_connection_ptr                   connection,
-   boost::system::error_code const &    error,
-   size_t                               bytes_transferred,
-   boost::shared_array <char>           bytes_buffer,
-   callback_function                    callback)
+parser::read_some (
+   tcp_connection_ptr   connection,
+   callback_function    callback)
 {
-   if (error)
+   std::vector <char> & buffer = connection->read_buffer_;
+
+   /*!
+     Move the part of a command we have already received to the front of the buffer, and
+     ensure there is enough room for the remainder of the command.
+    */
+   if (connection->read_begin_ > 0)
    {
-      callback (detail::error_connection_close,
-                command ());
+      memmove (buffer.data (),
+               buffer.data () + connection->read_begin_,
+               connection->read_end_ - connection->read_begin_);
+
+      connection->read_end_   -= connection->read_begin_;
+      connection->read_begin_  = 0;
    }
-   else
+
+   std::size_t required = connection->read_end_ + receive_buffer_size;
+
+   if (connection->read_end_ >= 4)
    {
-      PAXOS_ASSERT (bytes_transferred == 4);
-      
-      std::string bytes_raw (bytes_buffer.get (), 4);
-      uint32_t    bytes = util::conversion::from_byte_array <uint32_t> (bytes_raw);
+      util::decoder decoder (buffer.data (), 4);
+      required = std::max <std::size_t> (required, 4 + decoder.get_uint32 ());
+   }
 
-      boost::shared_array <char> command_buffer (new char[bytes]);   
+   if (buffer.size () < required)
+   {
+      buffer.resize (std::max (required, 2 * buffer.size ()));
+   }
 
-      PAXOS_DEBUG ("reading command data from connection = " << connection.get ());
+   PAXOS_DEBUG ("reading command data from connection = " << connection.get ());
 
-      //! Now send a request for the amount of bytes we just parsed
-      boost::asio::async_read (
-         connection->socket (), 
-         boost::asio::buffer (command_buffer.get (), bytes), 
-         std::bind (&parser::read_command_parse_command,
+   connection->socket ().async_read_some (
+      boost::asio::buffer (buffer.data () + connection->read_end_,
+                           buffer.size () - connection->read_end_),
+      connection->socket_strand ().wrap (
+         std::bind (&parser::read_command_parse_buffer,
                     connection,
                     std::placeholders::_1,
                     std::placeholders::_2,
-                    command_buffer,
-                    callback));
-   }
+                    callback)));
 }
 
 /*! static */ void
-parser::read_command_parse_command (
+parser::read_command_parse_buffer (
    tcp_connection_ptr                   connection,
    boost::system::error_code const &    error,
    size_t                               bytes_transferred,
-   boost::shared_array <char>           buffer,
    callback_function                    callback)
 {
    if (error)
    {
-      callback (detail::error_connection_close,
-                command ());
+      connection->strand ().post (
+         std::bind (&parser::dispatch,
+                    boost::optional <command> (),
+                    callback));
+      return;
    }
-   else
+
+   connection->read_end_ += bytes_transferred;
+   connection->bytes_read_.fetch_add (bytes_transferred,
+                                      std::memory_order_relaxed);
+
+   PAXOS_ASSERT (connection->read_end_ <= connection->read_buffer_.size ());
+
+   boost::optional <command> result;
+
+   if (parse_buffer (*connection,
+                     result) == false)
+   {
+      /*!
+        We have not received the whole command yet
+       */
+      read_some (connection,
+                 callback);
+      return;
+   }
+
+   PAXOS_DEBUG ("callback for connection = " << connection.get ());
+
+   /*!
+     We decoded the command inside the connection's own strand, so that other threads can
+     decode the commands received on other connections in the meantime. Only the decoded
+     command enters the strand that serializes the protocol, and it is posted so that the
+     protocol never runs nested inside the connection's strand.
+    */
+   connection->strand ().post (
+      std::bind (&parser::dispatch,
+                 result,
+                 callback));
+}
+
+/*! static */ bool
+parser::parse_buffer (
+   tcp_connection &                     connection,
+   boost::optional <command> &          result)
+{
+   std::size_t available = connection.read_end_ - connection.read_begin_;
+
+   if (available < 4)
+   {
+      return false;
+   }
+
+   char const * data = connection.read_buffer_.data () + connection.read_begin_;
+   uint32_t     size = util::decoder (data, 4).get_uint32 ();
+
+   if (available - 4 < size)
+   {
+      return false;
+   }
+
+   try
    {
-      std::string byte_array (buffer.get (),
-                              bytes_transferred);
+      result = command::from_string (data + 4,
+                                     size);
+   }
+   catch (exception::protocol_error const &)
+   {
+      /*!
+        There is no way to resynchronize with the other side once we received a
+        command we cannot decode, so treat this the same as a closed connection.
+       */
+      PAXOS_WARN ("received malformed command from connection = " << &connection);
+   }
 
-      PAXOS_DEBUG ("callback for connection = " << connection.get ());
+   connection.read_begin_ += 4 + size;
 
-      callback (boost::none,
-                command::from_string (byte_array));
+   if (connection.read_begin_ == connection.read_end_)
+   {
+      connection.read_begin_ = connection.read_end_ = 0;
+
+      /*!
+        Don't hold on to the memory of an exceptionally large command
+       */
+      if (connection.read_buffer_.size () > receive_buffer_size)
+      {
+         std::vector <char> (receive_buffer_size).swap (connection.read_buffer_);
+      }
    }
+
+   return true;
+}
+
+/*! static */ void
+parser::dispatch (
+   boost::optional <command> const &    result,
+   callback_function                    callback)
+{
+   if (result.is_initialized () == false)
+   {
+      callback (detail::error_connection_close,
+                command ());
+      return;
+   }
+
+   callback (boost::none,
+             *result);
 }
 
 
@@ -5,7 +5,7 @@
 #ifndef LIBPAXOS_CPP_DETAIL_PARSER_HPP
 #define LIBPAXOS_CPP_DETAIL_PARSER_HPP
 
-#include <boost/shared_array.hpp>
+#include <boost/optional.hpp>
 
 #include "error.hpp"
 #include "tcp_connection_fwd.hpp"
@@ -37,6 +37,13 @@ public:
      \brief Reads single command from input stream and dispatches to callback function 
      \param connection  Connection to read from
      \param callback    Callback function object
+
+     Data is read into the connection's receive buffer, as much as is available at once. Any
+     commands received beyond the first stay inside the buffer, and the next read_command ()
+     dispatches them without touching the socket.
+
+     Must be called from within the connection's socket_strand (); the callback is dispatched
+     through its strand ().
     */
    static void
    read_command (
@@ -46,20 +53,41 @@ public:
 
 private:
 
+   /*!
+     \brief Initial size of a connection's receive buffer, and the minimum amount of space
+            available for a single read
+    */
+   static std::size_t const receive_buffer_size = 8192;
+
+   /*!
+     \brief Issues a read of as much data as is available into the connection's receive buffer
+    */
    static void
-   read_command_parse_size (
+   read_some (
       tcp_connection_ptr                connection,
-      boost::system::error_code const & error,
-      size_t                            bytes_transferred,
-      boost::shared_array <char>        buffer,
       callback_function                 callback);
 
    static void
-   read_command_parse_command (
+   read_command_parse_buffer (
       tcp_connection_ptr                connection,
       boost::system::error_code const & error,
       size_t                            bytes_transferred,
-      boost::shared_array <char>        buffer,
+      callback_function                 callback);
+
+   /*!
+     \brief Decodes the first command inside the connection's receive buffer, if it has been
+            received completely
+     \returns True if a command was consumed from the buffer, in which case \c result is only
+              empty when that command was malformed
+    */
+   static bool
+   parse_buffer (
+      tcp_connection &                  connection,
+      boost::optional <command> &       result);
+
+   static void
+   dispatch (
+      boost::optional <command> const & result,
       callback_function                 callback);
 
 
@@ -12,19 +12,99 @@ paxos_context::paxos_context (
    processor_type const &               processor,
    paxos::configuration &               configuration)
    : processor_ (processor),
+     queue_wait_ (metrics_.lookup_histogram ("request_queue.wait_us")),
      strategy_ (configuration.strategy_factory ().create ()),
      request_queue_ (
-        []
+        [this]
         (strategy::request const &                                                      request,
          detail::request_queue::queue <detail::strategy::request>::guard::pointer       guard)
         {
-           request.global_state_.strategy ().initiate (request.connection_,
-                                                       request.command_,
+           queue_wait_.record_since (request.queued_);
+
+           detail::strategy::batch requests;
+           requests.push_back (std::make_pair (request.connection_,
+                                               request.command_));
+           requests.insert (requests.end (),
+                            request.batch_.begin (),
+                            request.batch_.end ());
+
+           request.global_state_.strategy ().initiate (requests,
                                                        request.quorum_,
                                                        request.global_state_,
                                                        guard);
-        })
+        },
+        configuration.pipeline_window (),
+        paxos_context::merge_function (configuration.batch_size (),
+                                       configuration.batch_bytes (),
+                                       queue_wait_))
+{
+   strategy_->set_metrics (metrics_);
+}
+
+void
+paxos_context::set_snapshot (
+   snapshot_type const &                snapshot,
+   restore_type const &                 restore)
 {
+   snapshot_ = snapshot;
+   restore_  = restore;
+}
+
+void
+paxos_context::set_read (
+   read_type const &                    read)
+{
+   read_ = read;
+}
+
+/*! static */ request_queue::queue <strategy::request>::merge_callback
+paxos_context::merge_function (
+   uint32_t                             batch_size,
+   uint32_t                             batch_bytes,
+   metrics::histogram &                 queue_wait)
+{
+   if (batch_size <= 1)
+   {
+      /*!
+        Batching is disabled, every request is proposed on its own.
+       */
+      return request_queue::queue <strategy::request>::merge_callback ();
+   }
+
+   return 
+      [batch_size,
+       batch_bytes,
+       & queue_wait]
+      (strategy::request &              request,
+       strategy::request const &        pending) -> bool
+      {
+         if (request.batch_.size () + 1 >= batch_size)
+         {
+            return false;
+         }
+
+         std::size_t bytes = request.command_.workload ().size () + pending.command_.workload ().size ();
+
+         for (auto const & i : request.batch_)
+         {
+            bytes += i.second.workload ().size ();
+         }
+
+         if (bytes > batch_bytes)
+         {
+            return false;
+         }
+
+         request.batch_.push_back (std::make_pair (pending.connection_,
+                                                   pending.command_));
+
+         /*!
+           The pending request is proposed along with the request it is merged into, so
+           this is where its wait ends.
+          */
+         queue_wait.record_since (pending.queued_);
+         return true;
+      };
 }
 
 paxos_context::~paxos_context ()
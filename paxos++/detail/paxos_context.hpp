@@ -10,6 +10,7 @@
 
 #include <boost/function.hpp>
 
+#include "metrics/registry.hpp"
 #include "strategy/request.hpp"
 #include "request_queue/queue.hpp"
 
@@ -32,6 +33,9 @@ class paxos_context : private boost::noncopyable
 public:
 
    typedef boost::function <std::string (int64_t, std::string const &)>  processor_type;
+   typedef boost::function <std::string ()>                             snapshot_type;
+   typedef boost::function <void (int64_t, std::string const &)>        restore_type;
+   typedef boost::function <std::string (std::string const &)>          read_type;
 
 public:
 
@@ -44,22 +48,87 @@ public:
    processor_type const &
    processor () const;
 
+   /*!
+     \brief Adjusts the functions used to take and install snapshots of the application's state
+    */
+   void
+   set_snapshot (
+      snapshot_type const &     snapshot,
+      restore_type const &      restore);
+
+   /*!
+     \brief Function that returns the application's state, which might be empty
+    */
+   snapshot_type const &
+   snapshot () const;
+
+   /*!
+     \brief Function that replaces the application's state with a snapshot
+    */
+   restore_type const &
+   restore () const;
+
+   /*!
+     \brief Adjusts the function used to answer read-only requests
+    */
+   void
+   set_read (
+      read_type const &         read);
+
+   /*!
+     \brief Function that answers a read-only request from the application's state, which
+            might be empty
+    */
+   read_type const &
+   read () const;
+
    detail::strategy::strategy &
    strategy ();
 
    /*!
      \brief This is our request queue where pending Paxos requests are queued
 
-     Since our paxos protocol only allows one proposal at the same time, this queue ensures
-     that this guarantee is provided.
+     This queue ensures that no more proposals are in flight at the same time than the
+     configured pipeline window allows, which defaults to one.
     */
 
    request_queue::queue <strategy::request> &
    request_queue ();
 
+   /*!
+     \brief Registry in which all measurements of this server are recorded
+    */
+   metrics::registry &
+   metrics ();
+
+private:
+
+   /*!
+     \brief Returns the function used to batch pending requests, if batching is enabled
+    */
+   static request_queue::queue <strategy::request>::merge_callback
+   merge_function (
+      uint32_t                                  batch_size,
+      uint32_t                                  batch_bytes,
+      metrics::histogram &                      queue_wait);
+
 private:
 
    processor_type                               processor_;
+   snapshot_type                                snapshot_;
+   restore_type                                 restore_;
+   read_type                                    read_;
+
+   /*!
+     \brief Declared before all members that record their measurements in it
+    */
+   metrics::registry                            metrics_;
+
+   /*!
+     \brief Time requests spend on request_queue_ before they are proposed
+    */
+   metrics::histogram &                         queue_wait_;
+
    detail::strategy::strategy *                 strategy_;
    request_queue::queue <strategy::request>     request_queue_;
 };
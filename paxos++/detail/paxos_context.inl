@@ -6,6 +6,24 @@ paxos_context::processor () const
    return processor_;
 }
 
+inline paxos_context::snapshot_type const &
+paxos_context::snapshot () const
+{
+   return snapshot_;
+}
+
+inline paxos_context::restore_type const &
+paxos_context::restore () const
+{
+   return restore_;
+}
+
+inline paxos_context::read_type const &
+paxos_context::read () const
+{
+   return read_;
+}
+
 inline detail::strategy::strategy &
 paxos_context::strategy ()
 {
@@ -19,4 +37,10 @@ paxos_context::request_queue ()
    return request_queue_;
 }
 
+inline metrics::registry &
+paxos_context::metrics ()
+{
+   return metrics_;
+}
+
 }; };
@@ -7,7 +7,10 @@ namespace paxos { namespace detail { namespace quorum {
 
 client_view::client_view (
    boost::asio::io_service &    io_service)
-   : view::view (io_service)
+   : view::view (io_service),
+     next_request_id_ (1),
+     next_server_ (0),
+     observed_proposal_id_ (0)
 {
 }
 
@@ -55,12 +58,104 @@ client_view::select_leader ()
 }
 
 
+boost::optional <boost::asio::ip::tcp::endpoint>
+client_view::select_server ()
+{
+   std::vector <boost::asio::ip::tcp::endpoint> servers = this->live_servers ();
+
+   if (servers.empty () == true)
+   {
+      return boost::none;
+   }
+
+   return servers[next_server_++ % servers.size ()];
+}
+
+void
+client_view::observe_proposal_id (
+   int64_t                      proposal_id)
+{
+   observed_proposal_id_ = std::max (observed_proposal_id_,
+                                     proposal_id);
+}
+
+int64_t
+client_view::observed_proposal_id () const
+{
+   return observed_proposal_id_;
+}
+
 void
 client_view::advance_leader ()
 {
    advance_leader (this->live_servers ());
 }
 
+void
+client_view::advance_leader (
+   boost::asio::ip::tcp::endpoint const &       leader)
+{
+   if (next_leader_.is_initialized () == true
+       && *next_leader_ == leader)
+   {
+      advance_leader ();
+   }
+}
+
+uint64_t
+client_view::add_pending_request (
+   detail::tcp_connection_ptr   connection,
+   response_callback            callback)
+{
+   /*!
+     Request id 0 is reserved for commands that are not tagged with a request id
+    */
+   uint64_t request_id = next_request_id_++;
+
+   pending_requests_[request_id] = {connection, callback};
+
+   return request_id;
+}
+
+boost::optional <client_view::response_callback>
+client_view::remove_pending_request (
+   uint64_t                     request_id)
+{
+   auto pos = pending_requests_.find (request_id);
+   if (pos == pending_requests_.end ())
+   {
+      return boost::none;
+   }
+
+   response_callback callback = pos->second.callback_;
+   pending_requests_.erase (pos);
+
+   return callback;
+}
+
+std::vector <client_view::response_callback>
+client_view::remove_pending_requests (
+   detail::tcp_connection_ptr   connection)
+{
+   std::vector <response_callback> callbacks;
+
+   auto i = pending_requests_.begin ();
+   while (i != pending_requests_.end ())
+   {
+      if (i->second.connection_ == connection)
+      {
+         callbacks.push_back (i->second.callback_);
+         i = pending_requests_.erase (i);
+      }
+      else
+      {
+         ++i;
+      }
+   }
+
+   return callbacks;
+}
+
 void
 client_view::advance_leader (
    std::vector <boost::asio::ip::tcp::endpoint> const & live_servers)
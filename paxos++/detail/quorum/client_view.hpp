@@ -5,8 +5,15 @@
 #ifndef LIBPAXOS_CPP_DETAIL_QUORUM_CLIENT_VIEW_HPP
 #define LIBPAXOS_CPP_DETAIL_QUORUM_CLIENT_VIEW_HPP
 
+#include <boost/function.hpp>
+
+#include "../error.hpp"
 #include "view.hpp"
 
+namespace paxos { namespace detail {
+class command;
+}; };
+
 namespace paxos { namespace detail { namespace quorum {
 
 /*!
@@ -19,6 +26,9 @@ class client_view : public view
 {
 public:   
 
+   typedef boost::function <void (boost::optional <enum error_code>,
+                                  detail::command const &)>                     response_callback;
+
    /*!
      \brief Constructor for clients
      \param io_service  References the OS'es underlying I/O services
@@ -34,6 +44,13 @@ public:
    boost::optional <boost::asio::ip::tcp::endpoint>
    select_leader ();
 
+   /*!
+     \brief Selects the next live server in a round-robin fashion, regardless of whether it
+            is the leader
+    */
+   boost::optional <boost::asio::ip::tcp::endpoint>
+   select_server ();
+
    /*!
      \brief Advances to the next leader
 
@@ -44,6 +61,59 @@ public:
    void
    advance_leader ();
 
+   /*!
+     \brief Advances to the next leader, but only if \c leader is still our candidate
+
+     When many requests are in flight, several of them can report the same server not to be
+     the leader; this ensures we only skip that server once.
+    */
+   void
+   advance_leader (
+      boost::asio::ip::tcp::endpoint const &    leader);
+
+   /*!
+     \brief Records that we have seen the result of proposal \c proposal_id
+    */
+   void
+   observe_proposal_id (
+      int64_t                                   proposal_id);
+
+   /*!
+     \brief Most recent proposal id we have seen the result of
+
+     Follower reads must reflect at least this proposal.
+    */
+   int64_t
+   observed_proposal_id () const;
+
+   /*!
+     \brief Registers a request that is about to be sent over \c connection
+     \returns Returns the id the request should be tagged with
+
+     The leader echoes this id in its response, which is how responses are matched with
+     their requests when many requests are in flight over the same connection.
+    */
+   uint64_t
+   add_pending_request (
+      detail::tcp_connection_ptr                connection,
+      response_callback                         callback);
+
+   /*!
+     \brief Removes the request with id \c request_id
+     \returns Returns the callback of the request, if it was still pending
+    */
+   boost::optional <response_callback>
+   remove_pending_request (
+      uint64_t                                  request_id);
+
+   /*!
+     \brief Removes all requests pending on \c connection
+     \returns Returns the callbacks of these requests
+    */
+   std::vector <response_callback>
+   remove_pending_requests (
+      detail::tcp_connection_ptr                connection);
+
 private:
 
    void
@@ -55,6 +125,24 @@ private:
 
    boost::optional <boost::asio::ip::tcp::endpoint>     next_leader_;
 
+   struct pending_request
+   {
+      detail::tcp_connection_ptr        connection_;
+      response_callback                 callback_;
+   };
+
+   /*!
+     \brief Requests we are awaiting a response for, by request id
+
+     Only accessed from within strand (), so this does not need a lock of its own.
+    */
+   std::map <uint64_t, pending_request>                 pending_requests_;
+
+   uint64_t                                             next_request_id_;
+
+   std::size_t                                          next_server_;
+
+   int64_t                                              observed_proposal_id_;
 
 };
 
@@ -9,8 +9,10 @@ namespace paxos { namespace detail { namespace quorum {
 
 server::server (
    boost::asio::io_service &                    io_service,
+   boost::asio::io_service::strand &            strand,
    boost::asio::ip::tcp::endpoint const &       endpoint)
    : io_service_ (io_service),
+     strand_ (strand),
      endpoint_ (endpoint),
      highest_proposal_id_ (-1)
 {
@@ -104,23 +106,25 @@ server::establish_connection ()
    most_recent_connection_attempt_ = boost::posix_time::second_clock::local_time ();
 
    PAXOS_INFO ("attempting to establish connection with " << endpoint_);
-   tcp_connection_ptr connection = tcp_connection::create (io_service_);
+   tcp_connection_ptr connection = tcp_connection::create (io_service_,
+                                                           strand_);
    connection->socket ().async_connect (
       endpoint_,
-      [this, 
-       connection] 
-      (boost::system::error_code const & error)
-      {
-         if (error)
-         {
-            PAXOS_WARN ("Unable to connect to remote host: " << error.message ());
-            PAXOS_ASSERT (this->has_connection () == false);
-         }
-         else
+      strand_.wrap (
+         [this, 
+          connection] 
+         (boost::system::error_code const & error)
          {
-            this->connection_ = connection;
-         }
-      });
+            if (error)
+            {
+               PAXOS_WARN ("Unable to connect to remote host: " << error.message ());
+               PAXOS_ASSERT (this->has_connection () == false);
+            }
+            else
+            {
+               this->connection_ = connection;
+            }
+         }));
 }
 
 
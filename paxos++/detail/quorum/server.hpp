@@ -10,6 +10,7 @@
 
 #include <boost/optional.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/strand.hpp>
 
 #include "../tcp_connection_fwd.hpp"
 
@@ -24,6 +25,7 @@ public:
 
    server (
       boost::asio::io_service &                 io_service,
+      boost::asio::io_service::strand &         strand,
       boost::asio::ip::tcp::endpoint const &    endpoint);
 
    /*!
@@ -105,6 +107,7 @@ public:
 private:
 
    boost::asio::io_service &                            io_service_;
+   boost::asio::io_service::strand &                    strand_;
 
    boost::asio::ip::tcp::endpoint                       endpoint_;
    boost::uuids::uuid                                   id_;
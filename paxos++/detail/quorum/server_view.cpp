@@ -43,8 +43,15 @@ server_view::has_majority ()
 {
    PAXOS_DEBUG ("has_majority live_servers.size () = " << this->live_servers ().size () << ", servers_.size () = " << servers_.size ());
 
+   return this->is_majority (this->live_servers ().size ());
+}
+
+bool
+server_view::is_majority (
+   std::size_t                                  count) const
+{
    return
-      static_cast <double> (this->live_servers ().size ()) 
+      static_cast <double> (count) 
       >= (static_cast <double> (servers_.size ()) * majority_factor_);
 }
 
@@ -9,7 +9,8 @@ namespace paxos { namespace detail { namespace quorum {
 
 view::view (
    boost::asio::io_service &    io_service)
-   : io_service_ (io_service)
+   : io_service_ (io_service),
+     strand_ (io_service)
 {
 }
 
@@ -20,6 +21,7 @@ view::add (
 {
    servers_.insert (std::make_pair (endpoint, 
                                     detail::quorum::server (io_service_,
+                                                            strand_,
                                                             endpoint)));
 }
 
@@ -106,4 +108,10 @@ view::lowest_proposal_id () const
    return lowest_proposal_id;
 }
 
+boost::asio::io_service::strand &
+view::strand ()
+{
+   return strand_;
+}
+
 }; }; };
@@ -11,6 +11,7 @@
 #include <boost/noncopyable.hpp>
 #include <boost/optional.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/strand.hpp>
 
 #include "../../configuration.hpp"
 #include "server.hpp"
@@ -80,6 +81,16 @@ public:
    int64_t
    lowest_proposal_id () const;
 
+   /*!
+     \brief Strand that serializes all handlers that access the state of this view
+
+     The io_service might be run by multiple threads: every command received on any of our
+     connections is dispatched through this strand. The connections perform their socket
+     operations and decode commands inside strands of their own, see tcp_connection.
+    */
+   boost::asio::io_service::strand &
+   strand ();
+
 protected:
 
    std::map <boost::asio::ip::tcp::endpoint, detail::quorum::server>    servers_;
@@ -87,6 +98,7 @@ protected:
 private:
 
    boost::asio::io_service &                                            io_service_;
+   boost::asio::io_service::strand                                      strand_;
 
 
 };
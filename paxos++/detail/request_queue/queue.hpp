@@ -5,6 +5,7 @@
 #ifndef LIBPAXOS_CPP_DETAIL_PAXOS_REQUEST_QUEUE_HPP
 #define LIBPAXOS_CPP_DETAIL_PAXOS_REQUEST_QUEUE_HPP
 
+#include <list>
 #include <queue>
 
 #include <boost/function.hpp>
@@ -42,6 +43,14 @@ namespace paxos { namespace detail { namespace request_queue {
   gets this guard as part of its function parameters, and as soon as this guard goes out of scope,
   a new request is processed.
 
+  The leader can optionally pipeline its proposals: in that case, the queue is constructed with
+  a window larger than one, and up to that many requests are processed at the same time. Guards
+  may then go out of scope in any order.
+
+  The leader can also batch its proposals: in that case, a merge function is provided, and
+  whenever a request is started, the requests waiting in line behind it are merged into it for
+  as long as the merge function accepts them.
+
   Since the thread putting new requests on the queue doesn't necessarily have to be the same
   thread as the one that pulls requests off the queue, this class is thread safe.
  */
@@ -52,6 +61,8 @@ class queue
 
 public:
 
+   typedef typename std::list <Type>::iterator                                  iterator;
+
    class guard
    {
    public:
@@ -61,49 +72,73 @@ public:
       
       static pointer
       create (
-         queue <Type> &    queue);
+         queue <Type> &    queue,
+         iterator          request);
    
    private:
       guard (
-         queue <Type> &    queue);
+         queue <Type> &    queue,
+         iterator          request);
       
    private:
       
       queue <Type> &       queue_;
+      iterator             request_;
    };
 
    typedef boost::function <void (Type const &, typename guard::pointer)>       callback;
 
+   /*!
+     \brief Merges the second request into the first, returns false if it cannot be merged
+    */
+   typedef boost::function <bool (Type &, Type const &)>                        merge_callback;
+
 public:
 
+   /*!
+     \param callback    Callback executed for each request that is started
+     \param window      Maximum amount of requests that are processed at the same time
+     \param merge       Optional function to merge pending requests into a started request
+     \pre window > 0
+    */
    queue (
-      callback  callback);
+      callback          callback,
+      std::size_t       window = 1,
+      merge_callback    merge = merge_callback ());
 
    void
    push (
       Type &&  request);
 
+   /*!
+     \brief Called by guard when \c request has been processed
+    */
    void
-   pop ();
+   pop (
+      iterator request);
 
 private:
 
    /*!
      \returns Returns request that callback should be executed on, if any
     */
-   boost::optional <Type const &>
+   boost::optional <iterator>
    push_locked (
       Type &&  request);
 
    /*!
      \returns Returns request that callback should be executed on, if any
     */
-   boost::optional <Type const &>
-   pop_locked ();
+   boost::optional <iterator>
+   pop_locked (
+      iterator  request);
 
-   void
-   start_request_locked (
-      Type &    request);
+   /*!
+     \brief Moves the next pending request in flight, if our window allows it
+     \returns Returns request that callback should be executed on, if any
+    */
+   boost::optional <iterator>
+   start_request_locked ();
 
    
 
@@ -111,16 +146,27 @@ private:
 
    callback             callback_;
 
+   std::size_t          window_;
+
+   merge_callback       merge_;
+
    /*!
-     \brief Synchronizes access to request_being_processed_ and queue_
+     \brief Synchronizes access to in_flight_ and queue_
 
-     We need a recursive_mutex since the callback is executed within a locked environment,
-     but can in turn generate a push () request within that callback. When that occurs, if
-     we would use regular mutexes, a deadlock would occur.
+     Note that the callback is always executed outside of this lock, since it can in turn
+     generate a push () request within that callback. If we would execute the callback within
+     the lock, a deadlock would occur.
     */
    boost::mutex         mutex_;
 
-   bool                 request_being_processed_;
+   /*!
+     \brief Requests currently being processed
+
+     A std::list is used so that references handed to the callback, and iterators held by
+     guards, stay valid while other requests start and finish.
+    */
+   std::list <Type>     in_flight_;
+
    std::queue <Type>    queue_;
 };
 
@@ -4,15 +4,18 @@ namespace paxos { namespace detail { namespace request_queue {
 template <typename Type>
 /*! static */ typename queue <Type>::guard::pointer
 queue <Type>::guard::create (
-   queue <Type> &       queue)
+   queue <Type> &       queue,
+   iterator             request)
 {
-   return pointer (new guard (queue));
+   return pointer (new guard (queue, request));
 }
 
 template <typename Type>
 inline queue <Type>::guard::guard (
-   queue <Type> &       queue)
-   : queue_ (queue)
+   queue <Type> &       queue,
+   iterator             request)
+   : queue_ (queue),
+     request_ (request)
 {
 }
 
@@ -20,15 +23,19 @@ inline queue <Type>::guard::guard (
 template <typename Type>
 inline queue <Type>::guard::~guard ()
 {
-   queue_.pop ();
+   queue_.pop (request_);
 }
 
 template <typename Type>
 inline queue <Type>::queue (
-   callback  callback)
+   callback             callback,
+   std::size_t          window,
+   merge_callback       merge)
    : callback_ (callback),
-     request_being_processed_ (false)
+     window_ (window),
+     merge_ (merge)
 {
+   PAXOS_ASSERT (window_ > 0);
 }
 
 
@@ -37,7 +44,7 @@ inline void
 queue <Type>::push (
    Type &&      input)
 {
-   boost::optional <Type const &> request;
+   boost::optional <iterator> request;
 
    {
       PAXOS_DEBUG ("push acquiring lock");
@@ -48,81 +55,82 @@ queue <Type>::push (
 
    if (request)
    {
-      callback_ (*request,
-                 guard::create (*this));
+      callback_ (**request,
+                 guard::create (*this, *request));
    }
 }
 
 
 template <typename Type>
-inline boost::optional <Type const &>
+inline boost::optional <typename queue <Type>::iterator>
 queue <Type>::push_locked (
    Type &&      request)
 {
-   queue_.push (request);
+   queue_.push (std::forward <Type &&> (request));
 
-   if (request_being_processed_ == false)
-   {
-      this->start_request_locked (request);
-      return request;
-   }
-
-   return boost::none;
+   return this->start_request_locked ();
 }
 
 
 
 template <typename Type>
 inline void
-queue <Type>::pop ()
+queue <Type>::pop (
+   iterator     input)
 {
-   boost::optional <Type const &> request;
+   boost::optional <iterator> request;
    {
       PAXOS_DEBUG ("pop acquiring lock");
       boost::mutex::scoped_lock lock (mutex_);
-      request = pop_locked ();
+      request = pop_locked (input);
       PAXOS_DEBUG ("pop releasing lock");
    }
 
    if (request)
    {
-      callback_ (*request,
-                 guard::create (*this));
+      callback_ (**request,
+                 guard::create (*this, *request));
    }
 }
 
 template <typename Type>
-inline boost::optional <Type const &>
-queue <Type>::pop_locked ()
+inline boost::optional <typename queue <Type>::iterator>
+queue <Type>::pop_locked (
+   iterator     request)
 {
-   PAXOS_ASSERT (queue_.empty () == false);
-   PAXOS_ASSERT (request_being_processed_ == true);
+   PAXOS_ASSERT (in_flight_.empty () == false);
 
-   queue_.pop ();
-   request_being_processed_ = false;
+   in_flight_.erase (request);
 
-   if (queue_.empty () == false)
+   /*!
+     If we still have requests waiting in line, this starts the next one
+    */
+   return this->start_request_locked ();
+}
+
+template <typename Type>
+inline boost::optional <typename queue <Type>::iterator>
+queue <Type>::start_request_locked ()
+{
+   if (queue_.empty () == true
+       || in_flight_.size () >= window_)
    {
-      /*!
-        This means we still have requests waiting in line
-      */
-      Type & request = queue_.front ();
+      return boost::none;
+   }
 
-      this->start_request_locked (request);
+   in_flight_.push_back (std::move (queue_.front ()));
+   queue_.pop ();
 
-      return request;
-   }
+   Type & request = in_flight_.back ();
 
-   return boost::none;
-}
-template <typename Type>
-inline void
-queue <Type>::start_request_locked (
-   Type &       request)
-{
-   PAXOS_ASSERT (request_being_processed_ == false);
+   while (merge_
+          && queue_.empty () == false
+          && merge_ (request, queue_.front ()) == true)
+   {
+      queue_.pop ();
+   }
 
-   request_being_processed_ = true;     
+   return --in_flight_.end ();
 }
 
 }; }; };
@@ -14,7 +14,11 @@ factory::factory (
 /*! virtual */ strategy *
 factory::create () const
 {
-   return new protocol::strategy (configuration_.durable_storage ());
+   return new protocol::strategy (configuration_.durable_storage (),
+                                  configuration_.majority_commit (),
+                                  configuration_.apply_thread (),
+                                  configuration_.leader_leases () ? configuration_.timeout () : 0,
+                                  configuration_.timeout ());
 }
 
 }; }; }; };
@@ -1,14 +1,19 @@
+#include <algorithm>
 #include <functional>
+#include <sstream>
 
 #include <boost/uuid/uuid_io.hpp>
 
 #include "../../../../durable/storage.hpp"
+#include "../../../metrics/registry.hpp"
 #include "../../../quorum/server_view.hpp"
 #include "../../../paxos_context.hpp"
 #include "../../../command.hpp"
 #include "../../../parser.hpp"
 #include "../../../tcp_connection.hpp"
+#include "../../../io_thread.hpp"
 #include "../../../util/debug.hpp"
+#include "../../../util/trace.hpp"
 
 #include "strategy.hpp"
 
@@ -16,84 +21,584 @@ namespace paxos { namespace detail { namespace strategy { namespace basic_paxos
 
 
 strategy::strategy (
-   durable::storage &   storage)
-   : storage_ (storage)
+   durable::storage &   storage,
+   bool                 majority_commit,
+   bool                 apply_thread,
+   uint32_t             lease_timeout,
+   uint32_t             timeout)
+   : storage_ (storage),
+     majority_commit_ (majority_commit),
+     proposals_in_flight_ (0),
+     highest_assigned_proposal_id_ (0),
+     highest_sent_proposal_id_ (0),
+     highest_replied_proposal_id_ (0),
+     lease_timeout_ (lease_timeout),
+     timeout_ (timeout),
+     lease_expiry_ (std::chrono::steady_clock::time_point::min ()),
+     granted_expiry_ (std::chrono::steady_clock::time_point::min ()),
+     lease_round_in_flight_ (false),
+     flush_scheduled_ (false),
+     pending_applies_ (0),
+     proposals_ (NULL),
+     proposed_requests_ (NULL),
+     proposals_in_flight_gauge_ (NULL),
+     proposal_latency_ (NULL),
+     storage_accept_latency_ (NULL),
+     storage_flush_latency_ (NULL)
 {
+   if (apply_thread == true)
+   {
+      apply_thread_.reset (new detail::io_thread ());
+      apply_thread_->launch ();
+   }
+}
+
+/*! virtual */ strategy::~strategy ()
+{
+   if (apply_thread_)
+   {
+      apply_thread_->stop ();
+      apply_thread_->join ();
+   }
+}
+
+/*! virtual */ void
+strategy::set_metrics (
+   detail::metrics::registry &  metrics)
+{
+   detail::strategy::strategy::set_metrics (metrics);
+
+   proposals_                 = &metrics.lookup_counter ("proposals");
+   proposed_requests_         = &metrics.lookup_counter ("proposals.requests");
+   proposals_in_flight_gauge_ = &metrics.lookup_gauge ("proposals.in_flight");
+   proposal_latency_          = &metrics.lookup_histogram ("proposals.latency_us");
+   storage_accept_latency_    = &metrics.lookup_histogram ("storage.accept.latency_us");
+   storage_flush_latency_     = &metrics.lookup_histogram ("storage.flush.latency_us");
 }
 
 /*! virtual */ void
 strategy::initiate (      
-   tcp_connection_ptr                   client_connection,
-   detail::command const &              command,
+   detail::strategy::batch const &              requests,
    detail::quorum::server_view &        quorum,
    detail::paxos_context &              global_state,
    queue_guard_type                     queue_guard)
 {
+   PAXOS_ASSERT (requests.empty () == false);
+
    /*!
      If we do not have a the majority of servers alive, it is likely we are having a netsplit 
      and we should never make any progress, to prevent the situation where there are multiple
      representations of the truth in multiple datacenters.
     */
+   boost::optional <enum detail::error_code> error;
+
+   std::vector <boost::asio::ip::tcp::endpoint> live_servers = quorum.live_servers ();
+
    if (quorum.has_majority () == false)
    {
-      this->handle_error (detail::error_no_majority,
-                          quorum,
-                          client_connection);
+      error = detail::error_no_majority;
+   }
+   else if (live_servers.empty () == true)
+   {
+      error = detail::error_no_leader;
+   }
+   else
+   {
+      live_servers = this->participating_servers (quorum,
+                                                  global_state);
+
+      if (quorum.is_majority (live_servers.size ()) == false)
+      {
+         /*!
+           Too many followers are still being caught up; once they are, we have a majority
+           again.
+          */
+         error = detail::error_no_majority;
+      }
+   }
+
+   if (error.is_initialized () == true)
+   {
+      for (auto const & i : requests)
+      {
+         this->handle_error (*error,
+                             quorum,
+                             i.first,
+                             i.second);
+      }
+
       return;
    }
 
    /*!
      Keeps track of the current state / which servers have responded, etc.
     */
-   boost::shared_ptr <struct state> state (new struct state ());
+   boost::shared_ptr <struct state> state = this->create_state (requests,
+                                                                queue_guard);
+
+   /*!
+     Tell all nodes within this quorum to prepare this request.
+    */
+   for (boost::asio::ip::tcp::endpoint const & endpoint : live_servers)
+   {
+      detail::quorum::server & server = quorum.lookup_server (endpoint);
+
+      PAXOS_ASSERT (server.has_connection () == true);
+
+      send_prepare (server.endpoint (),
+                    server.connection (),
+                    quorum,
+                    global_state,
+                    state);
+   }
+}
+
+
+std::vector <boost::asio::ip::tcp::endpoint>
+strategy::participating_servers (
+   detail::quorum::server_view &        quorum,
+   detail::paxos_context &              global_state)
+{
+   std::vector <boost::asio::ip::tcp::endpoint> result;
+
+   for (boost::asio::ip::tcp::endpoint const & endpoint : quorum.live_servers ())
+   {
+      if (catching_up_.find (endpoint) != catching_up_.end ())
+      {
+         continue;
+      }
+
+      if (endpoint != quorum.our_endpoint ()
+          && (this->proposal_id () - this->follower_highest_proposal_id (endpoint, quorum)
+              > storage_.catch_up_size ()
+              || this->needs_snapshot (endpoint, quorum) == true))
+      {
+         PAXOS_WARN ("follower " << endpoint << " lags behind, catching up in the background");
+
+         detail::quorum::server & server = quorum.lookup_server (endpoint);
+
+         send_catch_up (endpoint,
+                        server.connection (),
+                        quorum,
+                        global_state);
+         continue;
+      }
+
+      result.push_back (endpoint);
+   }
+
+   return result;
+}
+
+
+boost::shared_ptr <struct strategy::state>
+strategy::create_state (
+   detail::strategy::batch const &              requests,
+   queue_guard_type                     queue_guard)
+{
+   if (proposals_in_flight_ == 0)
+   {
+      /*!
+        None of our previous proposals are still in flight, so our storage is authorative
+        again. This also discards any bookkeeping of proposals that failed.
+       */
+      highest_assigned_proposal_id_ = 0;
+      highest_sent_proposal_id_     = 0;
+      follower_proposal_ids_.clear ();
+   }
+
+   ++proposals_in_flight_;
+
+   proposals_->add ();
+   proposed_requests_->add (requests.size ());
+   proposals_in_flight_gauge_->set (proposals_in_flight_);
+
+   boost::shared_ptr <struct state> state (
+      new struct state (),
+      [this] (struct state * state)
+      {
+         /*!
+           Note that the queue guard inside the state might immediately start the next
+           proposal, so we must finish our bookkeeping first.
+          */
+         this->finish_proposal ();
+         delete state;
+      });
 
    /*!
      Note that this will ensure the queue guard is in place for as long as the request is
      being processed.
     */
-   state->queue_guard = queue_guard;
+   state->queue_guard    = queue_guard;
+   state->requests       = requests;
+   state->proposal_id    = std::max (this->proposal_id (),
+                                     highest_assigned_proposal_id_) + 1;
+   state->started        = std::chrono::steady_clock::now ();
 
-   std::vector <boost::asio::ip::tcp::endpoint> live_servers = quorum.live_servers ();
-   if (live_servers.empty () == true)
+   highest_assigned_proposal_id_ = this->last_proposal_id (*state);
+
+   PAXOS_TRACE_EVENT (proposal_start,
+                      state->proposal_id,
+                      state->requests.size ());
+
+   return state;
+}
+
+/*! static */ int64_t
+strategy::last_proposal_id (
+   struct state const &                 state)
+{
+   return state.proposal_id + static_cast <int64_t> (state.requests.size ()) - 1;
+}
+
+void
+strategy::finish_proposal ()
+{
+   PAXOS_ASSERT (proposals_in_flight_ > 0);
+   --proposals_in_flight_;
+
+   proposals_in_flight_gauge_->set (proposals_in_flight_);
+}
+
+struct strategy::follower_metrics &
+strategy::lookup_follower_metrics (
+   boost::asio::ip::tcp::endpoint const &       follower_endpoint,
+   tcp_connection_ptr                           follower_connection)
+{
+   auto pos = follower_metrics_.find (follower_endpoint);
+
+   if (pos == follower_metrics_.end ())
+   {
+      std::ostringstream name;
+      name << follower_endpoint;
+
+      struct follower_metrics metrics;
+      metrics.prepare_latency = &this->metrics ().lookup_histogram ("prepare." + name.str () + ".latency_us");
+      metrics.accept_latency  = &this->metrics ().lookup_histogram ("accept." + name.str () + ".latency_us");
+
+      pos = follower_metrics_.insert (std::make_pair (follower_endpoint, metrics)).first;
+   }
+
+   if (pos->second.connection.lock () != follower_connection)
+   {
+      pos->second.connection = follower_connection;
+      this->metrics ().add_connection (follower_connection);
+   }
+
+   return pos->second;
+}
+
+
+bool
+strategy::has_lease () const
+{
+   return 
+      lease_timeout_ > 0
+      && std::chrono::steady_clock::now () < lease_expiry_;
+}
+
+void
+strategy::extend_lease (
+   std::chrono::steady_clock::time_point        started)
+{
+   if (lease_timeout_ == 0)
    {
-      handle_error (detail::error_no_leader,
-                    quorum,
-                    client_connection);
       return;
    }
 
    /*!
-     Tell all nodes within this quorum to prepare this request.
+     Our followers granted the lease when they received our command, so by starting it
+     when we sent that command, our lease always expires before theirs do.
+    */
+   lease_expiry_ = std::max (lease_expiry_,
+                             started + std::chrono::milliseconds (lease_timeout_));
+}
+
+bool
+strategy::may_lead (
+   boost::asio::ip::tcp::endpoint const &       leader) const
+{
+   return
+      lease_timeout_ == 0
+      || leader == granted_leader_
+      || std::chrono::steady_clock::now () >= granted_expiry_;
+}
+
+void
+strategy::grant_lease (
+   boost::asio::ip::tcp::endpoint const &       leader)
+{
+   if (lease_timeout_ == 0)
+   {
+      return;
+   }
+
+   granted_leader_ = leader;
+   granted_expiry_ = 
+      std::chrono::steady_clock::now ()
+      + std::chrono::milliseconds (lease_timeout_);
+}
+
+
+void
+strategy::process_reads (
+   detail::quorum::server_view &        quorum,
+   detail::paxos_context &              global_state)
+{
+   if (pending_reads_.empty () == false)
+   {
+      if (this->has_lease () == true)
+      {
+         confirmed_reads_.insert (confirmed_reads_.end (),
+                                  pending_reads_.begin (),
+                                  pending_reads_.end ());
+         pending_reads_.clear ();
+      }
+      else if (lease_round_in_flight_ == false)
+      {
+         this->send_lease_prepares (quorum,
+                                    global_state);
+      }
+   }
+
+   if (confirmed_reads_.empty () == true
+       || this->proposal_id () < highest_replied_proposal_id_)
+   {
+      /*!
+        With majority commit, a client might have received the response to a proposal
+        we have not processed ourselves yet; accept () calls us again once we have.
+       */
+      return;
+   }
+
+   detail::strategy::batch reads;
+   reads.swap (confirmed_reads_);
+
+   for (auto const & i : reads)
+   {
+      this->answer_read (i.first,
+                         i.second,
+                         quorum,
+                         global_state);
+   }
+}
+
+
+void
+strategy::send_lease_prepares (
+   detail::quorum::server_view &        quorum,
+   detail::paxos_context &              global_state)
+{
+   /*!
+     Reads that arrive while this round is in flight might have been preceded by a write
+     we do not know about yet, so they have to wait for the next round.
     */
+   boost::shared_ptr <struct lease_state> state (new struct lease_state ());
+   state->reads.swap (pending_reads_);
+   state->started   = std::chrono::steady_clock::now ();
+   state->promises  = 0;
+   state->responses = 0;
+   state->finished  = false;
+
+   if (quorum.has_majority () == false)
+   {
+      for (auto const & i : state->reads)
+      {
+         this->handle_error (detail::error_no_majority,
+                             quorum,
+                             i.first,
+                             i.second);
+      }
+
+      return;
+   }
+
+   std::vector <boost::asio::ip::tcp::endpoint> live_servers = quorum.live_servers ();
+   state->servers = live_servers.size ();
+
+   lease_round_in_flight_ = true;
+
+   /*!
+     Followers only promise a proposal id beyond their history, which also covers any
+     proposals we still have in flight.
+    */
+   command command;
+   command.set_type (command::type_request_prepare);
+   command.set_next_proposal_id (std::max (this->proposal_id (),
+                                           highest_assigned_proposal_id_) + 1);
+
+   this->add_local_host_information (quorum, command);
+
    for (boost::asio::ip::tcp::endpoint const & endpoint : live_servers)
    {
       detail::quorum::server & server = quorum.lookup_server (endpoint);
 
       PAXOS_ASSERT (server.has_connection () == true);
 
-      PAXOS_DEBUG ("sending paxos request to server " << endpoint);
+      /*!
+        A follower that is being caught up only replies once it has processed the catch-up,
+        which can take arbitrarily long; see write_catch_up ().
+       */
+      std::chrono::steady_clock::time_point deadline =
+         catching_up_.find (endpoint) == catching_up_.end ()
+         ? this->deadline (state->started)
+         : std::chrono::steady_clock::time_point::max ();
+
+      server.connection ()->write_command (command);
+      server.connection ()->read_command (
+         std::bind (&strategy::receive_lease_promise,
+                    this,
+                    std::placeholders::_1,
+                    endpoint,
+                    std::ref (quorum),
+                    std::ref (global_state),
+                    std::placeholders::_2,
+                    state),
+         deadline);
+   }
+}
 
-      send_prepare (client_connection,
-                    command,
-                    server.endpoint (),
-                    server.connection (),
-                    quorum,
-                    global_state,
-                    command.workload (),
-                    state);
+
+void
+strategy::receive_lease_promise (
+   boost::optional <enum detail::error_code>    error,
+   boost::asio::ip::tcp::endpoint const &       follower_endpoint,
+   detail::quorum::server_view &                quorum,
+   detail::paxos_context &                      global_state,
+   detail::command const &                      command,
+   boost::shared_ptr <struct lease_state>       state)
+{
+   ++state->responses;
+
+   if (error)
+   {
+      PAXOS_WARN ("An error occured while receiving promise from " << follower_endpoint << ": " << detail::to_string (*error));
+
+      quorum.connection_died (follower_endpoint);
+      state->error = *error;
+   }
+   else
+   {
+      this->process_remote_host_information (command,
+                                             quorum);
+
+      if (command.type () == command::type_request_promise)
+      {
+         ++state->promises;
+      }
+      else
+      {
+         PAXOS_ASSERT_EQ (command.type (), command::type_request_fail);
+         state->error = command.error_code ();
+      }
+   }
+
+   if (state->finished == true)
+   {
+      return;
+   }
+
+   if (quorum.is_majority (state->promises) == true)
+   {
+      state->finished        = true;
+      lease_round_in_flight_ = false;
+
+      this->extend_lease (state->started);
+
+      confirmed_reads_.insert (confirmed_reads_.end (),
+                               state->reads.begin (),
+                               state->reads.end ());
+   }
+   else if (state->responses == state->servers)
+   {
+      state->finished        = true;
+      lease_round_in_flight_ = false;
+
+      for (auto const & i : state->reads)
+      {
+         this->handle_error (state->error.is_initialized () == true
+                             ? *state->error
+                             : detail::error_no_majority,
+                             quorum,
+                             i.first,
+                             i.second);
+      }
+   }
+   else
+   {
+      return;
+   }
+
+   this->process_reads (quorum,
+                        global_state);
+}
+
+
+void
+strategy::process_follower_reads (
+   detail::quorum::server_view &        quorum,
+   detail::paxos_context &              global_state)
+{
+   auto end = follower_reads_.upper_bound (this->proposal_id ());
+
+   detail::strategy::batch reads;
+
+   for (auto i = follower_reads_.begin (); i != end; ++i)
+   {
+      reads.push_back (i->second);
+   }
+
+   follower_reads_.erase (follower_reads_.begin (),
+                          end);
+
+   for (auto const & i : reads)
+   {
+      this->answer_read (i.first,
+                         i.second,
+                         quorum,
+                         global_state);
    }
 }
 
 
+void
+strategy::answer_read (
+   tcp_connection_ptr                   client_connection,
+   detail::command const &              command,
+   detail::quorum::server_view &        quorum,
+   detail::paxos_context &              global_state)
+{
+   boost::shared_ptr <detail::command> response (new detail::command ());
+   response->set_type (command::type_request_accepted);
+   response->set_request_id (command.request_id ());
+   response->set_next_proposal_id (this->proposal_id ());
+
+   std::string workload = command.workload ();
+
+   /*!
+     This ensures the read is answered after all proposals we have stored so far have
+     been processed.
+    */
+   this->apply (client_connection,
+                [response, workload, & global_state] ()
+                {
+                   response->set_workload (global_state.read () (workload));
+                },
+                [this, client_connection, & quorum, response] ()
+                {
+                   this->add_local_host_information (quorum, *response);
+
+                   client_connection->write_command (*response);
+                });
+}
+
+
 /*! virtual */ void
 strategy::send_prepare (
-   tcp_connection_ptr                           client_connection,
-   detail::command const &                      client_command,
    boost::asio::ip::tcp::endpoint const &       follower_endpoint,
    tcp_connection_ptr                           follower_connection,
    detail::quorum::server_view &                quorum,
    detail::paxos_context &                      global_state,
-   std::string const &                          byte_array,
    boost::shared_ptr <struct state>             state)
 {
 
@@ -103,6 +608,10 @@ strategy::send_prepare (
     */
    PAXOS_ASSERT (state->connections.find (follower_endpoint) == state->connections.end ());
    state->connections[follower_endpoint] = follower_connection;
+   state->sent[follower_endpoint]        = std::chrono::steady_clock::now ();
+
+   this->lookup_follower_metrics (follower_endpoint,
+                                  follower_connection);
 
 
    /*!
@@ -112,17 +621,17 @@ strategy::send_prepare (
    command command;
 
    command.set_type (command::type_request_prepare);
-   command.set_next_proposal_id (this->proposal_id () + 1);
+   command.set_next_proposal_id (state->proposal_id);
 
    this->add_local_host_information (quorum, command);
 
 
-   PAXOS_DEBUG ("step2 writing command");
+   PAXOS_TRACE_EVENT (prepare_sent,
+                      state->proposal_id,
+                      util::trace::endpoint (follower_endpoint));
 
    follower_connection->write_command (command);
 
-   PAXOS_DEBUG ("step2 reading command from follower = " << follower_connection.get ());   
-
    /*!
      We expect either an 'ack' or a 'reject' response to this command.
     */
@@ -130,15 +639,13 @@ strategy::send_prepare (
       std::bind (&strategy::receive_promise,
                  this,
                  std::placeholders::_1,
-                 client_connection,
-                 client_command,
                  follower_endpoint,
                  follower_connection,
                  std::ref (quorum),
                  std::ref (global_state),
-                 byte_array,
                  std::placeholders::_2,
-                 state));
+                 state),
+      this->deadline (state->started));
 }
 
 /*! virtual */ void
@@ -152,14 +659,6 @@ strategy::prepare (
                                           quorum);
    detail::command response;
 
-   PAXOS_DEBUG ("self = " << quorum.our_endpoint () << ", "
-                "state.proposal_id () = " << this->proposal_id () << ", "
-                "command.proposal_id () = " << command.next_proposal_id ());
-
-
-
-   PAXOS_DEBUG ("command.host_endpoint () = " << command.host_endpoint () << ", command.host_id () = " << command.host_id ());
-
    boost::optional <boost::asio::ip::tcp::endpoint> leader = quorum.who_is_our_leader ();
 
    if (leader.is_initialized () == false)
@@ -176,13 +675,19 @@ strategy::prepare (
       /*!
         This request is coming from a host that is not the leader
        */
-      PAXOS_WARN ("request coming from host that is not the leader: "  << *leader << " [" << quorum.lookup_server (*leader).id () << "," << quorum.lookup_server (*leader).highest_proposal_id () << "] != " << command.host_endpoint () << " [" << quorum.lookup_server (command.host_endpoint ()).id () << "," << quorum.lookup_server (command.host_endpoint ()).highest_proposal_id () << "]");
+      PAXOS_WARN ("request coming from host that is not the leader: " << *leader << " != " << command.host_endpoint ());
+      response.set_type (command::type_request_fail);
+      response.set_error_code (detail::error_no_leader);
+   }
+   else if (this->may_lead (command.host_endpoint ()) == false)
+   {
+      PAXOS_WARN ("request coming from " << command.host_endpoint () << " while our lease to " << granted_leader_ << " has not expired yet");
       response.set_type (command::type_request_fail);
       response.set_error_code (detail::error_no_leader);
    }
    else if (command.next_proposal_id () > this->proposal_id ())
    {
-      PAXOS_DEBUG ("normal proposal, accepting, command = " << command.next_proposal_id () << ", state = " << this->proposal_id ());
+      this->grant_lease (command.host_endpoint ());
 
       response.set_type (command::type_request_promise);
    }
@@ -197,23 +702,23 @@ strategy::prepare (
 
    this->add_local_host_information (quorum, response);
 
+   PAXOS_TRACE_EVENT (prepare_received,
+                      command.next_proposal_id (),
+                      util::trace::endpoint (command.host_endpoint ()),
+                      response.type () == command::type_request_promise ? detail::no_error : response.error_code ());
 
-   PAXOS_DEBUG ("step3 writing command");   
-
-   leader_connection->write_command (response);
+   this->write_response (leader_connection,
+                         response);
 }
 
 
 /*! virtual */ void
 strategy::receive_promise (
    boost::optional <enum detail::error_code>    error,
-   tcp_connection_ptr                           client_connection,
-   detail::command                              client_command,
    boost::asio::ip::tcp::endpoint const &       follower_endpoint,
    tcp_connection_ptr                           follower_connection,
    detail::quorum::server_view &                quorum,
    detail::paxos_context &                      global_state,
-   std::string                                  byte_array,
    detail::command const &                      command,
    boost::shared_ptr <struct state>             state)
 {
@@ -232,7 +737,9 @@ strategy::receive_promise (
 
       PAXOS_ASSERT_EQ (state->connections[follower_endpoint], follower_connection);
 
-      PAXOS_DEBUG ("step4 self = " << quorum.our_endpoint () << ", received command from follower " << follower_endpoint);
+      this->lookup_follower_metrics (follower_endpoint,
+                                     follower_connection).prepare_latency->record_since (
+                                        state->sent[follower_endpoint]);
 
       switch (command.type ())
       {
@@ -261,6 +768,58 @@ strategy::receive_promise (
       };
    }
 
+   PAXOS_TRACE_EVENT (promise_received,
+                      state->proposal_id,
+                      util::trace::endpoint (follower_endpoint),
+                      state->accepted[follower_endpoint] == response_ack ? detail::no_error : state->error_codes[follower_endpoint]);
+
+   if (state->accepting == true)
+   {
+      /*!
+        We are committing with a majority, and this follower promised after the majority
+        did. It still has to be brought up to date, but nobody is waiting for it anymore.
+       */
+      if (state->accepted[follower_endpoint] == response_ack)
+      {
+         send_accept (follower_endpoint,
+                      follower_connection,
+                      quorum,
+                      global_state,
+                      state);
+      }
+      else
+      {
+         state->responses[follower_endpoint] = std::vector <std::string> ();
+
+         this->process_accepted (quorum,
+                                 state);
+      }
+
+      return;
+   }
+
+   if (majority_commit_ == true)
+   {
+      std::size_t promises = std::count_if (state->accepted.begin (),
+                                            state->accepted.end (),
+                                            [] (std::pair <boost::asio::ip::tcp::endpoint const, enum response> const & i)
+                                            {
+                                               return i.second == response_ack;
+                                            });
+
+      if (quorum.is_majority (promises) == true)
+      {
+         /*!
+           A majority has promised, which is all the Paxos protocol requires: there is no
+           need to wait for any stragglers before sending the 'accept' commands.
+          */
+         send_accepts (quorum,
+                       global_state,
+                       state);
+         return;
+      }
+   }
+
    if (state->connections.size () == state->accepted.size ())
    {
    
@@ -293,17 +852,9 @@ strategy::receive_promise (
            proposal id, let's send them an accept command.
          */
          
-         for (auto & i : state->connections)
-         {
-            send_accept (client_connection,
-                         client_command,
-                         i.first,
-                         i.second,
-                         quorum,
-                         std::ref (global_state),
-                         byte_array,
-                         state);
-         }
+         send_accepts (quorum,
+                       global_state,
+                       state);
       }
       else
       {
@@ -315,20 +866,58 @@ strategy::receive_promise (
          */
          handle_error (*last_error,
                        quorum,
-                       client_connection);
+                       state);
       }
    }
 }
 
+/*! virtual */ void
+strategy::send_accepts (
+   detail::quorum::server_view &                quorum,
+   detail::paxos_context &                      global_state,
+   boost::shared_ptr <struct state>             state)
+{
+   state->accepting = true;
+
+   for (auto & i : state->connections)
+   {
+      /*!
+        A follower that already rejected our prepare will not respond to this proposal
+        anymore, so record it as responded: otherwise process_accepted () would wait for it
+        forever when the accept phase fails as well.
+       */
+      if (state->accepted[i.first] == response_reject)
+      {
+         state->responses[i.first] = std::vector <std::string> ();
+         continue;
+      }
+
+      /*!
+        When committing with a majority, followers that have not promised yet will be sent
+        their 'accept' command once they do.
+       */
+      if (state->accepted[i.first] != response_ack)
+      {
+         continue;
+      }
+
+      send_accept (i.first,
+                   i.second,
+                   quorum,
+                   global_state,
+                   state);
+   }
+
+   highest_sent_proposal_id_ = std::max (highest_sent_proposal_id_,
+                                         this->last_proposal_id (*state));
+}
+
 /*! virtual */ void
 strategy::send_accept (
-   tcp_connection_ptr                           client_connection,
-   detail::command const &                      client_command,
    boost::asio::ip::tcp::endpoint const &       follower_endpoint,
    tcp_connection_ptr                           follower_connection,
    detail::quorum::server_view &                quorum,
    detail::paxos_context &                      global_state,
-   std::string const &                          byte_array,
    boost::shared_ptr <struct state>             state)
 {  
    PAXOS_ASSERT_EQ (state->connections[follower_endpoint], follower_connection);
@@ -340,33 +929,44 @@ strategy::send_accept (
 
    /*!
      It is possible that the follower lags behind. If this is the case, let's
-     send it the history too.
+     send it the history too. If we already sent proposals that are still in flight,
+     the follower will have processed those by the time it receives this command.
     */
    int64_t follower_highest_proposal_id = 
-      quorum.lookup_server (follower_endpoint).highest_proposal_id ();
+      this->follower_highest_proposal_id (follower_endpoint,
+                                          quorum);
 
    /*!
-     Note that the storage mechanism is *not* required to retrieve all data, it
-     can just retrieve a portion. This prevents the whole quorum from locking up
-     if we need to transfer lots of data to a single follower.
+     Only a bounded portion of the history is retrieved. This prevents the whole quorum
+     from locking up if we need to transfer lots of data to a single follower; the
+     remainder is sent along with the following accept commands.
     */
    command.set_proposed_workload (
-      storage_.retrieve (follower_highest_proposal_id));
+      storage_.retrieve_range (follower_highest_proposal_id,
+                               storage_.catch_up_size (),
+                               storage_.catch_up_bytes ()));
 
    if (command.proposed_workload ().empty () == true
-       || command.proposed_workload ().rbegin ()->first == this->proposal_id ())
+       || command.proposed_workload ().rbegin ()->first == state->proposal_id - 1)
    {
       /*!
         This means that either there was no historical data available for the 
         follower (the most likely case, because that means the follower is up-to-date),
         or it just means the next request will catch him up completely.
 
-        Either way, let's store our currently proposed value too!
+        Either way, let's store our currently proposed value(s) too!
        */
-      command.add_proposed_workload (this->proposal_id () + 1,
-                                     byte_array);
+      int64_t proposal_id = state->proposal_id;
+
+      for (auto const & i : state->requests)
+      {
+         command.add_proposed_workload (proposal_id++,
+                                        i.second.workload ());
+      }
    }   
 
+   follower_proposal_ids_[follower_endpoint] = command.proposed_workload ().rbegin ()->first;
+
    /*!
      The leader communicates the lowest proposal id currently processed by all hosts
      when sending an accept command, because:
@@ -378,11 +978,17 @@ strategy::send_accept (
 
    this->add_local_host_information (quorum, command);
 
-   PAXOS_DEBUG ("step5 writing command");   
+   state->sent[follower_endpoint] = std::chrono::steady_clock::now ();
+
+   this->lookup_follower_metrics (follower_endpoint,
+                                  follower_connection);
+
+   PAXOS_TRACE_EVENT (accept_sent,
+                      state->proposal_id,
+                      util::trace::endpoint (follower_endpoint),
+                      command.proposed_workload ().size ());
 
    follower_connection->write_command (command);
-   
-   PAXOS_DEBUG ("step5 reading command");   
 
    /*!
      We expect a response to this command.
@@ -391,12 +997,11 @@ strategy::send_accept (
       std::bind (&strategy::receive_accepted,
                  this,
                  std::placeholders::_1,
-                 client_connection,
-                 client_command,
                  follower_endpoint,
                  std::ref (quorum),
                  std::placeholders::_2,
-                 state));
+                 state),
+      this->deadline (state->started));
 
 }
 
@@ -411,39 +1016,285 @@ strategy::accept (
    this->process_remote_host_information (command,
                                           quorum);
 
+   PAXOS_ASSERT_EQ (command.proposed_workload ().empty (), false);
+
+   if (command.proposed_workload ().begin ()->first != this->proposal_id () + 1)
+   {
+      /*!
+        This proposal does not directly follow our history. This can happen when the leader
+        pipelines its proposals and a previous proposal failed: we must never process it,
+        since that would leave a gap in our history.
+       */
+      PAXOS_WARN ("accept does not follow our history, command = " << command.proposed_workload ().begin ()->first << ", state = " << this->proposal_id ());
+
+      PAXOS_TRACE_EVENT (accept_received,
+                         command.proposed_workload ().begin ()->first,
+                         util::trace::endpoint (command.host_endpoint ()),
+                         detail::error_incorrect_proposal);
+
+      detail::command response;
+      response.set_type (command::type_request_fail);
+      response.set_error_code (detail::error_incorrect_proposal);
+
+      this->add_local_host_information (quorum, response);
+
+      this->write_response (leader_connection,
+                         response);
+      return;
+   }
+
+   this->grant_lease (command.host_endpoint ());
+
+   PAXOS_TRACE_EVENT (accept_received,
+                      command.proposed_workload ().begin ()->first,
+                      util::trace::endpoint (command.host_endpoint ()),
+                      detail::no_error);
+
+   boost::shared_ptr <detail::command> response (new detail::command ());
+   response->set_type (command::type_request_accepted);
+
+   this->process_proposed_workload (
+      leader_connection,
+      command,
+      quorum,
+      state,
+      response,
+      [this, leader_connection, & quorum, response] ()
+      {
+         this->add_local_host_information (quorum, *response);
+
+         this->send_response (leader_connection,
+                              *response);
+      });
+
+   /*!
+     As a leader, reads might have been waiting for us to process this proposal.
+    */
+   this->process_reads (quorum,
+                        state);
+}
+
+
+/*! virtual */ void
+strategy::read (
+   tcp_connection_ptr                   client_connection,
+   detail::command const &              command,
+   detail::quorum::server_view &        quorum,
+   detail::paxos_context &              global_state)
+{
+   if (global_state.read ().empty () == true)
+   {
+      /*!
+        The application cannot answer reads from its local state, so propose the read
+        like any other request.
+       */
+      global_state.request_queue ().push (
+         {
+            client_connection,
+            command,
+            quorum,
+            global_state
+         });
+      return;
+   }
+
+   boost::optional <boost::asio::ip::tcp::endpoint> leader = quorum.who_is_our_leader ();
+
+   if (leader.is_initialized () == false
+       || *leader != quorum.our_endpoint ())
+   {
+      this->handle_error (detail::error_no_leader,
+                          quorum,
+                          client_connection,
+                          command);
+      return;
+   }
+
+   pending_reads_.push_back (std::make_pair (client_connection,
+                                             command));
+
+   this->process_reads (quorum,
+                        global_state);
+}
+
+
+/*! virtual */ void
+strategy::follower_read (
+   tcp_connection_ptr                   client_connection,
+   detail::command const &              command,
+   detail::quorum::server_view &        quorum,
+   detail::paxos_context &              global_state)
+{
+   if (global_state.read ().empty () == true)
+   {
+      /*!
+        Without a read callback, only the leader can answer the read by proposing it.
+       */
+      this->read (client_connection,
+                  command,
+                  quorum,
+                  global_state);
+      return;
+   }
+
+   if (command.next_proposal_id () <= this->proposal_id ())
+   {
+      this->answer_read (client_connection,
+                         command,
+                         quorum,
+                         global_state);
+      return;
+   }
+
+   PAXOS_DEBUG ("follower " << quorum.our_endpoint () << " holding back read until proposal " << command.next_proposal_id () << ", state = " << this->proposal_id ());
+
+   follower_reads_.insert (
+      std::make_pair (command.next_proposal_id (),
+                      std::make_pair (client_connection,
+                                      command)));
+}
+
+
+/*! virtual */ void
+strategy::catch_up (
+   tcp_connection_ptr                   leader_connection,
+   detail::command const &              command,
+   detail::quorum::server_view &        quorum,
+   detail::paxos_context &              global_state)
+{
+   this->process_remote_host_information (command,
+                                          quorum);
+
    detail::command response;
-   
+   response.set_type (command::type_request_caught_up);
+
+   if (command.type () == command::type_request_snapshot)
+   {
+      /*!
+        Without a storage component that can start over, we would not be able to continue
+        our history after the snapshot, so we must not install it.
+       */
+      if (global_state.restore ().empty () == true
+          || storage_.supports_reset () == false
+          || command.next_proposal_id () <= this->proposal_id ())
+      {
+         PAXOS_WARN ("unable to install snapshot, command = " << command.next_proposal_id () << ", state = " << this->proposal_id ());
+
+         response.set_type (command::type_request_fail);
+         response.set_error_code (detail::error_incorrect_proposal);
+
+         this->add_local_host_information (quorum, response);
+
+         this->write_response (leader_connection,
+                               response);
+         return;
+      }
+
+      PAXOS_INFO ("follower " << quorum.our_endpoint () << " installing snapshot of proposal " << command.next_proposal_id ());
+
+      int64_t     proposal_id = command.next_proposal_id ();
+      std::string snapshot    = command.workload ();
+
+      this->apply (leader_connection,
+                   [& global_state, proposal_id, snapshot] ()
+                   {
+                      global_state.restore () (proposal_id,
+                                               snapshot);
+                   },
+                   [] ()
+                   {
+                   });
+
+      storage_.reset (command.next_proposal_id ());
+
+      quorum.lookup_server (quorum.our_endpoint ()).set_highest_proposal_id (this->proposal_id ());
+
+      this->process_follower_reads (quorum,
+                                    global_state);
+   }
+
+   if (command.proposed_workload ().empty () == true)
+   {
+      PAXOS_ASSERT_EQ (command.type (), command::type_request_snapshot);
+   }
+   else if (command.proposed_workload ().begin ()->first != this->proposal_id () + 1)
+   {
+      /*!
+        Most likely a proposal that was still in flight has already caught us up partially.
+        The leader will send the next range based on our highest proposal id.
+       */
+      PAXOS_WARN ("catch up does not follow our history, command = " << command.proposed_workload ().begin ()->first << ", state = " << this->proposal_id ());
+
+      response.set_type (command::type_request_fail);
+      response.set_error_code (detail::error_incorrect_proposal);
+   }
+   else
+   {
+      /*!
+        Our response is held back by write_response () until these have been processed
+       */
+      this->process_proposed_workload (leader_connection,
+                                       command,
+                                       quorum,
+                                       global_state,
+                                       boost::shared_ptr <detail::command> (new detail::command ()),
+                                       [] ()
+                                       {
+                                       });
+   }
+
+   this->add_local_host_information (quorum, response);
+
+   this->write_response (leader_connection,
+                         response);
+}
+
+
+void
+strategy::process_proposed_workload (
+   tcp_connection_ptr                   leader_connection,
+   detail::command const &              command,
+   detail::quorum::server_view &        quorum,
+   detail::paxos_context &              global_state,
+   boost::shared_ptr <detail::command>  response,
+   boost::function <void ()>            completion)
+{
    /*!
-     Default to an 'accepted' response
-   */
-   response.set_type (command::type_request_accepted);
+     Without an apply thread or group commit the workload is processed before we return,
+     in which case there is no need to copy it.
+    */
+   boost::shared_ptr <detail::command const> proposal;
 
-   PAXOS_ASSERT_EQ (command.proposed_workload ().empty (), false);
+   if (apply_thread_ || storage_.group_commit () == true)
+   {
+      proposal.reset (new detail::command (command));
+   }
+   else
+   {
+      proposal.reset (&command,
+                      [] (detail::command const *)
+                      {
+                      });
+   }
 
    for (auto const & i : command.proposed_workload ())
    {
-      PAXOS_DEBUG ("follower " << quorum.our_endpoint () << " storing proposed workload for id = " << i.first << ", our highest proposal_id = " << this->proposal_id ());
-
       PAXOS_ASSERT_EQ (i.first, this->proposal_id () + 1);
 
-      /*! 
-        First, process the workload and set it as output of the response
-      */
-      response.add_proposed_workload (i.first,
-                                      state.processor () (i.first,
-                                                          i.second));
-
-      PAXOS_ASSERT_EQ (response.proposed_workload ().rbegin ()->second.empty (), false);
-      
       /*!
-        Now that the workload has been processed, store the currently accepted 
-        proposal/value in our durable storage backend so other nodes can catch up 
-        if they're disconnected for a short timespan.
+        Store the currently accepted proposal/value in our durable storage backend right
+        away, so that we can validate the proposals that follow this one while it is
+        being processed, and so other nodes can catch up if they're disconnected for a
+        short timespan.
       */
+      std::chrono::steady_clock::time_point const started = std::chrono::steady_clock::now ();
+
       storage_.accept (i.first,
                        i.second,
                        command.lowest_proposal_id ());
 
+      storage_accept_latency_->record_since (started);
+
       /*!
         This is a bit of a hack, but we need to let the quorum know that our own
         proposal id has also increased, otherwise its leader election algorithm
@@ -451,27 +1302,102 @@ strategy::accept (
       */
       quorum.lookup_server (quorum.our_endpoint ()).set_highest_proposal_id (this->proposal_id ());
 
-      /*!
-        At this point, the proposal id should've been incremented by 1, since the
-        proposal id is derived from storage_.
-       */
-      PAXOS_ASSERT_EQ (i.first, this->proposal_id ());
+      /*!
+        At this point, the proposal id should've been incremented by 1, since the
+        proposal id is derived from storage_.
+       */
+      PAXOS_ASSERT_EQ (i.first, this->proposal_id ());
+   }
+
+   this->apply_durable (leader_connection,
+                        [proposal, response, & global_state] ()
+                        {
+                           for (auto const & i : proposal->proposed_workload ())
+                           {
+                              response->add_proposed_workload (i.first,
+                                                               global_state.processor () (i.first,
+                                                                                          i.second));
+
+                              PAXOS_ASSERT_EQ (response->proposed_workload ().rbegin ()->second.empty (), false);
+                           }
+                        },
+                        completion);
+
+   this->process_follower_reads (quorum,
+                                 global_state);
+}
+
+
+void
+strategy::apply (
+   tcp_connection_ptr           connection,
+   boost::function <void ()>    task,
+   boost::function <void ()>    completion)
+{
+   if (awaiting_flush_.empty () == false)
+   {
+      awaiting_flush_.push_back (std::bind (&strategy::apply,
+                                            this,
+                                            connection,
+                                            task,
+                                            completion));
+      return;
+   }
+
+   if (!apply_thread_)
+   {
+      task ();
+      completion ();
+      return;
    }
-   
 
-   PAXOS_DEBUG ("step6 writing command");
+   ++pending_applies_;
 
-   this->add_local_host_information (quorum, response);
+   apply_thread_->io_service ().post (
+      [this, connection, task, completion] ()
+      {
+         task ();
+
+         connection->strand ().post (
+            [this, completion] ()
+            {
+               --pending_applies_;
+               completion ();
+            });
+      });
+}
+
+void
+strategy::apply_durable (
+   tcp_connection_ptr           connection,
+   boost::function <void ()>    task,
+   boost::function <void ()>    completion)
+{
+   if (storage_.group_commit () == false)
+   {
+      this->apply (connection,
+                   task,
+                   completion);
+      return;
+   }
 
-   leader_connection->write_command (response);
+   /*!
+     The values have only been buffered by storage_.accept (), so processing them now could
+     leave the application with values that are missing from our history after a crash.
+    */
+   awaiting_flush_.push_back (std::bind (&strategy::apply,
+                                         this,
+                                         connection,
+                                         task,
+                                         completion));
+
+   this->schedule_flush (connection);
 }
 
 
 /*! virtual */ void
 strategy::receive_accepted (
    boost::optional <enum detail::error_code>    error,
-   tcp_connection_ptr                           client_connection,
-   detail::command                              client_command,
    boost::asio::ip::tcp::endpoint const &       follower_endpoint,
    detail::quorum::server_view &                quorum,
    detail::command const &                      command,
@@ -482,10 +1408,11 @@ strategy::receive_accepted (
       PAXOS_WARN ("An error occured while receiving accepted from " << follower_endpoint << ": " << detail::to_string (*error));
 
       quorum.connection_died (follower_endpoint);
+      follower_proposal_ids_.erase (follower_endpoint);
 
       state->accepted[follower_endpoint]    = response_reject;
       state->error_codes[follower_endpoint] = *error;
-      state->responses[follower_endpoint]   = std::string ();
+      state->responses[follower_endpoint]   = std::vector <std::string> ();
    }
    else
    {
@@ -500,6 +1427,10 @@ strategy::receive_accepted (
       PAXOS_ASSERT (state->responses.find (follower_endpoint) == state->responses.end ());
       PAXOS_ASSERT (state->error_codes.find (follower_endpoint) == state->error_codes.end ());
 
+      this->lookup_follower_metrics (follower_endpoint,
+                                     state->connections[follower_endpoint]).accept_latency->record_since (
+                                        state->sent[follower_endpoint]);
+
       switch (command.type ())
       {
             case command::type_request_accepted:
@@ -510,18 +1441,44 @@ strategy::receive_accepted (
                /*!
                  Always store the response we received, since we also use that entry to see
                  whether all hosts have already replied. 
-               */
-               state->responses[follower_endpoint]   = 
-                  command.proposed_workload ().rbegin ()->second;
 
-               PAXOS_ASSERT_EQ (state->responses[follower_endpoint].empty (), false);
+                 Note that the follower also replies with the responses to any history it
+                 has been caught up with, so we look up the responses to our own proposals.
+               */
+               state->responses[follower_endpoint] = std::vector <std::string> ();
+
+               for (std::size_t i = 0; i < state->requests.size (); ++i)
+               {
+                  auto pos = command.proposed_workload ().find (state->proposal_id + static_cast <int64_t> (i));
+
+                  if (pos == command.proposed_workload ().end ())
+                  {
+                     /*!
+                       The follower was lagging too far behind to be caught up and process
+                       our proposal within the same command.
+                      */
+                     state->accepted[follower_endpoint]    = response_reject;
+                     state->error_codes[follower_endpoint] = detail::error_incorrect_proposal;
+                     state->responses[follower_endpoint].clear ();
+                     break;
+                  }
+
+                  PAXOS_ASSERT_EQ (pos->second.empty (), false);
+                  state->responses[follower_endpoint].push_back (pos->second);
+               }
 
                break;
 
             case command::type_request_fail:
+               /*!
+                 The follower did not process this proposal, so from now on catch it up
+                 based on the highest proposal id it just told us about.
+                */
+               follower_proposal_ids_.erase (follower_endpoint);
+
                state->accepted[follower_endpoint]    = response_reject;
                state->error_codes[follower_endpoint] = command.error_code ();
-               state->responses[follower_endpoint]   = std::string ();
+               state->responses[follower_endpoint]   = std::vector <std::string> ();
                break;
 
             default:
@@ -533,11 +1490,258 @@ strategy::receive_accepted (
    }
 
 
-   PAXOS_DEBUG ("leader got response = " << state->responses[follower_endpoint] << ", follower = " << follower_endpoint);
+   PAXOS_TRACE_EVENT (accepted_received,
+                      state->proposal_id,
+                      util::trace::endpoint (follower_endpoint),
+                      state->accepted[follower_endpoint] == response_ack ? detail::no_error : state->error_codes[follower_endpoint]);
+
+   this->process_accepted (quorum,
+                           state);
+}
+
+
+int64_t
+strategy::follower_highest_proposal_id (
+   boost::asio::ip::tcp::endpoint const &       follower_endpoint,
+   detail::quorum::server_view &                quorum)
+{
+   int64_t result = quorum.lookup_server (follower_endpoint).highest_proposal_id ();
+
+   auto sent = follower_proposal_ids_.find (follower_endpoint);
+   if (sent != follower_proposal_ids_.end ())
+   {
+      result = std::max (result,
+                         sent->second);
+   }
+
+   return result;
+}
+
+
+bool
+strategy::needs_snapshot (
+   boost::asio::ip::tcp::endpoint const &       follower_endpoint,
+   detail::quorum::server_view &                quorum)
+{
+   int64_t follower_highest_proposal_id = 
+      this->follower_highest_proposal_id (follower_endpoint, quorum);
+
+   /*!
+     A follower we have not heard from yet reports -1, in which case we do not know
+     whether it needs a snapshot at all.
+    */
+   return 
+      follower_highest_proposal_id >= 0
+      && follower_highest_proposal_id + 1 < storage_.lowest_proposal_id ();
+}
+
+
+void
+strategy::send_catch_up (
+   boost::asio::ip::tcp::endpoint const &       follower_endpoint,
+   tcp_connection_ptr                           follower_connection,
+   detail::quorum::server_view &                quorum,
+   detail::paxos_context &                      global_state)
+{
+   if (this->needs_snapshot (follower_endpoint, quorum) == true)
+   {
+      if (global_state.snapshot ().empty () == true)
+      {
+         PAXOS_WARN ("unable to catch up follower " << follower_endpoint << ", history not available and snapshots are disabled");
+         return;
+      }
+
+      /*!
+        Once all proposals inside our storage have been processed, our state reflects
+        exactly those proposals.
+       */
+      boost::shared_ptr <detail::command> command (new detail::command ());
+      command->set_type (command::type_request_snapshot);
+      command->set_next_proposal_id (this->proposal_id ());
+
+      catching_up_.insert (follower_endpoint);
+
+      this->apply (follower_connection,
+                   [command, & global_state] ()
+                   {
+                      command->set_workload (global_state.snapshot () ());
+                   },
+                   [this, follower_endpoint, follower_connection, & quorum, & global_state, command] ()
+                   {
+                      this->write_catch_up (follower_endpoint,
+                                           follower_connection,
+                                           quorum,
+                                           global_state,
+                                           *command);
+                   });
+      return;
+   }
+
+   command command;
+   command.set_type (command::type_request_catch_up);
+
+   this->write_catch_up (follower_endpoint,
+                         follower_connection,
+                         quorum,
+                         global_state,
+                         command);
+}
+
+
+void
+strategy::write_catch_up (
+   boost::asio::ip::tcp::endpoint const &       follower_endpoint,
+   tcp_connection_ptr                           follower_connection,
+   detail::quorum::server_view &                quorum,
+   detail::paxos_context &                      global_state,
+   detail::command &                            command)
+{
+   int64_t proposal_id = 
+      command.type () == command::type_request_snapshot
+      ? command.next_proposal_id ()
+      : this->follower_highest_proposal_id (follower_endpoint,
+                                            quorum);
+
+   command.set_proposed_workload (
+      storage_.retrieve_range (proposal_id,
+                               storage_.catch_up_size (),
+                               storage_.catch_up_bytes ()));
+
+   if (command.type () == command::type_request_catch_up
+       && command.proposed_workload ().empty () == true)
+   {
+      /*!
+        The follower has caught up in the meantime.
+       */
+      return;
+   }
+
+   catching_up_.insert (follower_endpoint);
+
+   command.set_lowest_proposal_id (quorum.lowest_proposal_id ());
+
+   this->add_local_host_information (quorum, command);
+
+   PAXOS_TRACE_EVENT (catch_up_sent,
+                      util::trace::endpoint (follower_endpoint),
+                      proposal_id,
+                      command.proposed_workload ().size ());
+
+   follower_connection->write_command (command);
+
+   /*!
+     Transferring and processing a catch-up, let alone a snapshot, takes time in proportion
+     to its size, so the follower gets no deadline here. It does not take part in
+     proposals meanwhile, so it cannot stall them, and a connection that dies still fails
+     this read.
+    */
+   follower_connection->read_command (
+      std::bind (&strategy::receive_caught_up,
+                 this,
+                 std::placeholders::_1,
+                 follower_endpoint,
+                 follower_connection,
+                 std::ref (quorum),
+                 std::ref (global_state),
+                 std::placeholders::_2));
+}
+
+
+void
+strategy::receive_caught_up (
+   boost::optional <enum detail::error_code>    error,
+   boost::asio::ip::tcp::endpoint const &       follower_endpoint,
+   tcp_connection_ptr                           follower_connection,
+   detail::quorum::server_view &                quorum,
+   detail::paxos_context &                      global_state,
+   detail::command const &                      command)
+{
+   catching_up_.erase (follower_endpoint);
+
+   if (error)
+   {
+      PAXOS_WARN ("An error occured while catching up " << follower_endpoint << ": " << detail::to_string (*error));
+
+      quorum.connection_died (follower_endpoint);
+      follower_proposal_ids_.erase (follower_endpoint);
+      return;
+   }
+
+   this->process_remote_host_information (command,
+                                          quorum);
+
+   if (command.type () == command::type_request_fail)
+   {
+      /*!
+        The next request determines where to continue, based on the highest proposal id
+        the follower just told us about.
+       */
+      follower_proposal_ids_.erase (follower_endpoint);
+      return;
+   }
+
+   PAXOS_ASSERT_EQ (command.type (), command::type_request_caught_up);
+
+   /*!
+     Keep going while the follower is still too far behind to take part in proposals;
+     the remainder is sent along with its next proposal.
+    */
+   if (this->proposal_id () - this->follower_highest_proposal_id (follower_endpoint, quorum)
+       > storage_.catch_up_size ())
+   {
+      send_catch_up (follower_endpoint,
+                     follower_connection,
+                     quorum,
+                     global_state);
+   }
+}
+
+
+void
+strategy::process_accepted (
+   detail::quorum::server_view &                quorum,
+   boost::shared_ptr <struct state>             state)
+{
+   if (lease_timeout_ > 0)
+   {
+      std::size_t accepted = std::count_if (state->responses.begin (),
+                                            state->responses.end (),
+                                            [state] (std::pair <boost::asio::ip::tcp::endpoint const, std::vector <std::string> > const & i)
+                                            {
+                                               return state->accepted.find (i.first)->second == response_ack;
+                                            });
+
+      /*!
+        Every follower that accepted our proposal granted us a lease when it did.
+       */
+      if (quorum.is_majority (accepted) == true)
+      {
+         this->extend_lease (state->started);
+      }
+   }
+
+   if (majority_commit_ == true
+       && state->replied == false)
+   {
+      boost::optional <std::vector <std::string> > responses = this->majority_responses (quorum,
+                                                                                         *state);
 
+      if (responses.is_initialized () == true)
+      {
+         handle_responses (*responses,
+                           quorum,
+                           state);
 
+         /*!
+           The proposal is committed, so the next one can start while we wait for the
+           remaining followers to catch up.
+          */
+         state->replied = true;
+         state->queue_guard.reset ();
+      }
+   }
 
-   std::string workload;
+   std::vector <std::string> const * responses = NULL;
 
    if (state->connections.size () == state->responses.size ())
    {
@@ -568,12 +1772,12 @@ strategy::receive_accepted (
          */
          for (auto const & i : state->responses)
          {
-            if (workload.empty () == true)
+            if (responses == NULL)
             {
-               workload = i.second;
-               PAXOS_ASSERT (workload.empty () == false);
+               responses = &i.second;
+               PAXOS_ASSERT_EQ (responses->size (), state->requests.size ());
             }
-            else if (workload != i.second)
+            else if (*responses != i.second)
             {
                last_error = detail::error_inconsistent_response;
             }
@@ -581,17 +1785,22 @@ strategy::receive_accepted (
          }
       }
 
-      if (last_error.is_initialized () == false)
+      if (state->replied == true)
       {
-         PAXOS_DEBUG ("step7 writing command");   
-         detail::command response;
-         response.set_type (command::type_request_accepted);
-         response.set_workload (workload);
-
-         this->add_local_host_information (quorum,
-                                           response);
-
-         client_connection->write_command (response);
+         /*!
+           The client(s) already received the response the majority agreed upon, there is
+           nothing left to report.
+          */
+         if (last_error.is_initialized () == true)
+         {
+            PAXOS_WARN ("a follower did not process proposal " << state->proposal_id << " after majority commit: " << detail::to_string (*last_error));
+         }
+      }
+      else if (last_error.is_initialized () == false)
+      {
+         handle_responses (*responses,
+                           quorum,
+                           state);
       }
       else
       {
@@ -602,12 +1811,116 @@ strategy::receive_accepted (
 
            What we will do is simply with the last error we have seen.
           */
-         PAXOS_DEBUG ("step7 writing error command");
-
          handle_error (*last_error,
                        quorum,
-                       client_connection);
+                       state);
+      }
+   }
+}
+
+
+std::chrono::steady_clock::time_point
+strategy::deadline (
+   std::chrono::steady_clock::time_point        started) const
+{
+   if (timeout_ == 0)
+   {
+      return std::chrono::steady_clock::time_point::max ();
+   }
+
+   return started + std::chrono::milliseconds (timeout_);
+}
+
+
+boost::optional <std::vector <std::string> >
+strategy::majority_responses (
+   detail::quorum::server_view const &          quorum,
+   struct state const &                         state) const
+{
+   for (auto const & i : state.responses)
+   {
+      auto accepted = state.accepted.find (i.first);
+      PAXOS_ASSERT (accepted != state.accepted.end ());
+
+      if (accepted->second != response_ack)
+      {
+         continue;
+      }
+
+      std::size_t count = 0;
+
+      for (auto const & j : state.responses)
+      {
+         if (state.accepted.find (j.first)->second == response_ack
+             && j.second == i.second)
+         {
+            ++count;
+         }
       }
+
+      if (quorum.is_majority (count) == true)
+      {
+         PAXOS_ASSERT_EQ (i.second.size (), state.requests.size ());
+         return i.second;
+      }
+   }
+
+   return boost::none;
+}
+
+
+/*! virtual */ void
+strategy::handle_responses (
+   std::vector <std::string> const &    responses,
+   quorum::server_view const &          quorum,
+   boost::shared_ptr <struct state>     state)
+{
+   PAXOS_ASSERT_EQ (responses.size (), state->requests.size ());
+
+   highest_replied_proposal_id_ = std::max (highest_replied_proposal_id_,
+                                            this->last_proposal_id (*state));
+
+   proposal_latency_->record_since (state->started);
+
+   PAXOS_TRACE_EVENT (proposal_committed,
+                      state->proposal_id,
+                      state->requests.size (),
+                      std::chrono::duration_cast <std::chrono::microseconds> (
+                         std::chrono::steady_clock::now () - state->started).count ());
+
+   for (std::size_t i = 0; i < responses.size (); ++i)
+   {
+      detail::command response;
+      response.set_type (command::type_request_accepted);
+      response.set_request_id (state->requests[i].second.request_id ());
+      response.set_next_proposal_id (state->proposal_id + static_cast <int64_t> (i));
+      response.set_workload (responses[i]);
+
+      this->add_local_host_information (quorum,
+                                        response);
+
+      state->requests[i].first->write_command (response);
+   }
+}
+
+
+/*! virtual */ void
+strategy::handle_error (
+   enum detail::error_code              error,
+   quorum::server_view const &          quorum,
+   boost::shared_ptr <struct state>     state)
+{
+   PAXOS_TRACE_EVENT (proposal_failed,
+                      state->proposal_id,
+                      state->requests.size (),
+                      error);
+
+   for (auto const & i : state->requests)
+   {
+      handle_error (error,
+                    quorum,
+                    i.first,
+                    i.second);
    }
 }
 
@@ -616,11 +1929,13 @@ strategy::receive_accepted (
 strategy::handle_error (
    enum detail::error_code      error,
    quorum::server_view const &  quorum,
-   tcp_connection_ptr           client_connection)
+   tcp_connection_ptr           client_connection,
+   detail::command const &      request)
 {
    detail::command response;
    response.set_type (command::type_request_error);
    response.set_error_code (error);
+   response.set_request_id (request.request_id ());
    
    this->add_local_host_information (quorum,
                                      response);
@@ -630,6 +1945,105 @@ strategy::handle_error (
 
 
 
+void
+strategy::write_response (
+   tcp_connection_ptr                   leader_connection,
+   detail::command const &              response)
+{
+   if (pending_applies_ > 0 || awaiting_flush_.empty () == false)
+   {
+      this->apply (leader_connection,
+                   [] ()
+                   {
+                   },
+                   std::bind (&strategy::send_response,
+                              this,
+                              leader_connection,
+                              response));
+      return;
+   }
+
+   this->send_response (leader_connection,
+                        response);
+}
+
+void
+strategy::send_response (
+   tcp_connection_ptr                   leader_connection,
+   detail::command const &              response)
+{
+   if (storage_.group_commit () == false)
+   {
+      leader_connection->write_command (response);
+      return;
+   }
+
+   pending_responses_.push_back (std::make_pair (leader_connection,
+                                                 response));
+
+   this->schedule_flush (leader_connection);
+}
+
+void
+strategy::schedule_flush (
+   tcp_connection_ptr                   connection)
+{
+   if (flush_scheduled_ == true)
+   {
+      return;
+   }
+
+   flush_scheduled_ = true;
+
+   /*!
+     Commands that have already been received are dispatched before the posted flush,
+     which allows their values to be flushed together with ours.
+    */
+   connection->strand ().post (
+      std::bind (&strategy::flush_responses,
+                 this));
+}
+
+void
+strategy::flush_responses ()
+{
+   std::chrono::steady_clock::time_point const started = std::chrono::steady_clock::now ();
+
+   storage_.flush ();
+
+   storage_flush_latency_->record_since (started);
+
+   /*!
+     Now that their values are durable, the held back workloads can be processed. Without
+     an apply thread, this adds their responses to pending_responses_ right away; since
+     flush_scheduled_ is still set, they are written below instead of triggering another
+     flush.
+    */
+   std::vector <boost::function <void ()> > applies;
+   applies.swap (awaiting_flush_);
+
+   for (auto const & i : applies)
+   {
+      i ();
+   }
+
+   std::vector <std::pair <tcp_connection_ptr, detail::command> > responses;
+   responses.swap (pending_responses_);
+
+   flush_scheduled_ = false;
+
+   PAXOS_TRACE_EVENT (responses_flushed,
+                      responses.size (),
+                      std::chrono::duration_cast <std::chrono::microseconds> (
+                         std::chrono::steady_clock::now () - started).count ());
+
+   for (auto const & i : responses)
+   {
+      i.first->write_command (i.second);
+   }
+}
+
+
 /*! virtual */ void
 strategy::add_local_host_information (
    quorum::server_view const &  quorum,
@@ -638,7 +2052,8 @@ strategy::add_local_host_information (
    detail::quorum::server const & server = quorum.lookup_server (quorum.our_endpoint ());
    output.set_host_id (server.id ());
    output.set_host_endpoint (server.endpoint ());
-   output.set_highest_proposal_id (this->proposal_id ());
+   output.set_highest_proposal_id (std::max (this->proposal_id (),
+                                             highest_sent_proposal_id_));
 }
 
 /*! virtual */ void
@@ -5,6 +5,13 @@
 #ifndef LIBPAXOS_CPP_DETAIL_STRATEGY_BASIC_PAXOS_PROTOCOL_STRATEGY_HPP
 #define LIBPAXOS_CPP_DETAIL_STRATEGY_BASIC_PAXOS_PROTOCOL_STRATEGY_HPP
 
+#include <chrono>
+#include <map>
+#include <set>
+
+#include <boost/function.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/weak_ptr.hpp>
 #include <boost/asio/ip/tcp.hpp>
 
 #include "../../../error.hpp"
@@ -14,6 +21,16 @@ namespace paxos { namespace durable {
 class storage;
 }; };
 
+namespace paxos { namespace detail {
+class io_thread;
+}; };
+
+namespace paxos { namespace detail { namespace metrics {
+class counter;
+class gauge;
+class histogram;
+}; }; };
+
 namespace paxos { namespace detail { namespace strategy { namespace basic_paxos { namespace protocol {
 
 /*!
@@ -21,7 +38,7 @@ namespace paxos { namespace detail { namespace strategy { namespace basic_paxos
  */
 class strategy : public detail::strategy::strategy
 {
-private:
+protected:
    enum response
    {
       response_none,
@@ -32,24 +49,116 @@ private:
    struct state
    {
       std::map <boost::asio::ip::tcp::endpoint, enum response>                  accepted;
-      std::map <boost::asio::ip::tcp::endpoint, std::string>                    responses;
+      std::map <boost::asio::ip::tcp::endpoint, std::vector <std::string> >     responses;
       std::map <boost::asio::ip::tcp::endpoint, enum detail::error_code>        error_codes;
       std::map <boost::asio::ip::tcp::endpoint, detail::tcp_connection_ptr>     connections;
       queue_guard_type                                                          queue_guard;
+
+      /*!
+        \brief Whether 'accept' commands have been sent, after which late promises are ignored
+       */
+      bool                                                                      accepting;
+
+      /*!
+        \brief Whether the client(s) have received a response
+       */
+      bool                                                                      replied;
+
+      /*!
+        \brief The client requests being proposed, each is assigned its own proposal id
+       */
+      detail::strategy::batch                                                   requests;
+
+      /*!
+        \brief Proposal id of the first request in \c requests
+       */
+      int64_t                                                                   proposal_id;
+
+      /*!
+        \brief When the proposal was started, according to a monotonic clock
+
+        This is where a lease the proposal grants starts, and what the deadline of the
+        replies of followers is measured from.
+       */
+      std::chrono::steady_clock::time_point                                     started;
+
+      /*!
+        \brief When the most recent command was sent to each follower
+       */
+      std::map <boost::asio::ip::tcp::endpoint, std::chrono::steady_clock::time_point> sent;
+   };
+
+   /*!
+     \brief Measurements we keep for each follower
+    */
+   struct follower_metrics
+   {
+      detail::metrics::histogram *                                              prepare_latency;
+      detail::metrics::histogram *                                              accept_latency;
+
+      /*!
+        \brief Connection of which the traffic is reported, see metrics::registry::add_connection ()
+       */
+      boost::weak_ptr <tcp_connection>                                          connection;
+   };
+
+   /*!
+     \brief Round of 'prepare' commands with which a leader confirms it is still the leader
+    */
+   struct lease_state
+   {
+      /*!
+        \brief Reads that arrived before the round was started, and are answered once it succeeds
+       */
+      detail::strategy::batch                                                   reads;
+
+      std::chrono::steady_clock::time_point                                     started;
+      std::size_t                                                               servers;
+      std::size_t                                                               promises;
+      std::size_t                                                               responses;
+      boost::optional <enum detail::error_code>                                 error;
+      bool                                                                      finished;
    };
    
 public:
 
+   /*!
+     \param storage             Durable storage of our history
+     \param majority_commit     Whether to reply to the client once a majority has accepted
+     \param apply_thread        Whether workloads are processed on a separate thread
+     \param lease_timeout       Duration of a leader lease in milliseconds, 0 disables leases
+     \param timeout             Milliseconds a follower has to reply to a Paxos instance, 0
+                                waits forever
+    */
    strategy (
-      durable::storage &        storage);
+      durable::storage &        storage,
+      bool                      majority_commit = false,
+      bool                      apply_thread = false,
+      uint32_t                  lease_timeout = 0,
+      uint32_t                  timeout = 0);
 
    /*!
-     \brief Received by leader from client that initiates a request
+     \brief Destructor, waits for the apply thread to stop
+    */
+   virtual ~strategy ();
+
+   /*!
+     \brief Looks up the metrics we record our measurements in
+    */
+   virtual void
+   set_metrics (
+      detail::metrics::registry &               metrics);
+
+   /*!
+     \brief Received by leader from client(s) that initiate a request
+
+     All requests are proposed within a single Paxos instance: each request is assigned
+     its own, consecutive proposal id, and all of them are sent to the followers inside a
+     single 'accept' command.
     */
    virtual void
    initiate (      
-      tcp_connection_ptr                        client_connection,
-      detail::command const &                   command,
+      detail::strategy::batch const &                   requests,
       detail::quorum::server_view &             quorum,
       detail::paxos_context &                   global_state,
       queue_guard_type                          queue_guard);
@@ -80,20 +189,97 @@ public:
       detail::quorum::server_view &             quorum,
       detail::paxos_context &                   global_state);
 
+
+   /*!
+     \brief Received by follower when leader sends it history or a snapshot it lags behind on
+    */
+   virtual void
+   catch_up (
+      tcp_connection_ptr                        leader_connection,
+      detail::command const &                   command,
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state);
+
+
+   /*!
+     \brief Received by leader from a client that sends a read-only request
+
+     The read is answered from our local state once we have confirmed we are still the
+     leader: right away while we hold a lease, after a round of 'prepare' commands
+     otherwise.
+    */
+   virtual void
+   read (
+      tcp_connection_ptr                        client_connection,
+      detail::command const &                   command,
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state);
+
+
+   /*!
+     \brief Received by any server from a client that sends a read-only request
+
+     The read is answered from our local state as soon as we have processed the proposal
+     the client asks for, without involving the leader.
+    */
+   virtual void
+   follower_read (
+      tcp_connection_ptr                        client_connection,
+      detail::command const &                   command,
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state);
+
 protected:
 
+   /*!
+     \brief Looks up the live servers that take part in new proposals
+
+     Followers that lag behind more than the storage's catch_up_size (), or that miss history
+     we do not have anymore, are left out, and are caught up in the background until they
+     can be caught up within a single proposal. This prevents a single follower that has
+     been away for a long time from stalling the entire quorum.
+    */
+   std::vector <boost::asio::ip::tcp::endpoint>
+   participating_servers (
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state);
+
+   /*!
+     \brief Creates the state for a new proposal and assigns it the next proposal id(s)
+
+     When multiple proposals are in flight at the same time, they are assigned consecutive
+     proposal ids.
+    */
+   boost::shared_ptr <struct state>
+   create_state (
+      detail::strategy::batch const &                   requests,
+      queue_guard_type                          queue_guard);
+
+   /*!
+     \brief Proposal id of the last request in \c state
+    */
+   static int64_t
+   last_proposal_id (
+      struct state const &                      state);
+
+   /*!
+     \brief Returns the measurements of \c follower_endpoint, and starts reporting the
+            traffic of \c follower_connection if it is new
+    */
+   struct follower_metrics &
+   lookup_follower_metrics (
+      boost::asio::ip::tcp::endpoint const &    follower_endpoint,
+      tcp_connection_ptr                        follower_connection);
+
    /*!
      \brief Sends a 'prepare' to a specific server
     */
    virtual void
    send_prepare (
-      tcp_connection_ptr                        client_connection,
-      detail::command const &                   client_command,
       boost::asio::ip::tcp::endpoint const &    follower_endpoint,
       tcp_connection_ptr                        follower_connection,
       detail::quorum::server_view &             quorum,
       detail::paxos_context &                   global_state,
-      std::string const &                       byte_array,
       boost::shared_ptr <struct state>          state);
 
 
@@ -103,28 +289,31 @@ protected:
    virtual void
    receive_promise (
       boost::optional <enum detail::error_code> error,
-      tcp_connection_ptr                        client_connection,
-      detail::command                           client_command,
       boost::asio::ip::tcp::endpoint const &    follower_endpoint,
       tcp_connection_ptr                        follower_connection,
       detail::quorum::server_view &             quorum,
       detail::paxos_context &                   global_state,
-      std::string                               byte_array,
       detail::command const &                   command,
       boost::shared_ptr <struct state>          state);
 
+   /*!
+     \brief Sends a 'accept' from leader to all followers that promised
+    */
+   virtual void
+   send_accepts (
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state,
+      boost::shared_ptr <struct state>          state);
+
    /*!
      \brief Sends a 'accept' from leader to a specific follower
     */
    virtual void
    send_accept (
-      tcp_connection_ptr                        client_connection,
-      detail::command const &                   client_command,
       boost::asio::ip::tcp::endpoint const &    follower_endpoint,
       tcp_connection_ptr                        follower_connection,
       detail::quorum::server_view &             quorum,
       detail::paxos_context &                   global_state,
-      std::string const &                       byte_array,
       boost::shared_ptr <struct state>          state);
 
 
@@ -134,21 +323,38 @@ protected:
    virtual void
    receive_accepted (
       boost::optional <enum detail::error_code> error,
-      tcp_connection_ptr                        client_connection,
-      detail::command                           client_command,
       boost::asio::ip::tcp::endpoint const &    follower_endpoint,
       detail::quorum::server_view &             quorum,
       detail::command const &                   command,
       boost::shared_ptr <struct state>          state);
 
    /*!
-     \brief Sends error command back to client
+     \brief Sends the responses for all requests in \c state back to their clients
+    */
+   virtual void
+   handle_responses (
+      std::vector <std::string> const &         responses,
+      quorum::server_view const &               quorum,
+      boost::shared_ptr <struct state>          state);
+
+   /*!
+     \brief Sends error command back to all clients in \c state
+    */
+   virtual void
+   handle_error (
+      enum detail::error_code                   error,
+      quorum::server_view const &               quorum,
+      boost::shared_ptr <struct state>          state);
+
+   /*!
+     \brief Sends error command back to the client that sent \c request
     */
    virtual void
    handle_error (
       enum detail::error_code   error,
       quorum::server_view const &    quorum,
-      tcp_connection_ptr        client_connection);
+      tcp_connection_ptr        client_connection,
+      detail::command const &   request);
 
 
    /*!
@@ -177,11 +383,382 @@ protected:
    virtual int64_t
    proposal_id ();
 
+   /*!
+     \brief As a follower, whether \c leader may take over leadership
+
+     This is not the case while we have granted a lease to another leader that has not
+     expired yet.
+    */
+   bool
+   may_lead (
+      boost::asio::ip::tcp::endpoint const &    leader) const;
+
+   /*!
+     \brief Stores the history inside \c command, and processes it using apply_durable ()
+
+     The results are added to \c response, after which \c completion is called.
+    */
+   void
+   process_proposed_workload (
+      tcp_connection_ptr                        leader_connection,
+      detail::command const &                   command,
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state,
+      boost::shared_ptr <detail::command>       response,
+      boost::function <void ()>                 completion);
+
+   /*!
+     \brief Calls \c task on the apply thread, after which \c completion is called on our strand
+
+     Tasks, and their completions, are called in the order in which they were scheduled.
+     Without an apply thread, both are called right away, unless tasks scheduled earlier
+     are still waiting for a flush.
+    */
+   void
+   apply (
+      tcp_connection_ptr                        connection,
+      boost::function <void ()>                 task,
+      boost::function <void ()>                 completion);
+
+   /*!
+     \brief Same as apply (), but with group commit \c task is only called once all values
+            accepted so far have been flushed to durable storage
+
+     This ensures the processor never sees a value that could still be lost in a crash.
+    */
+   void
+   apply_durable (
+      tcp_connection_ptr                        connection,
+      boost::function <void ()>                 task,
+      boost::function <void ()>                 completion);
+
+   /*!
+     \brief Writes a response from follower to leader
+
+     The response is held back until all workloads received before it have been processed,
+     so that the leader receives our responses in order.
+    */
+   void
+   write_response (
+      tcp_connection_ptr                        leader_connection,
+      detail::command const &                   response);
+
+
+private:
+
+   /*!
+     \brief Highest proposal id a follower has, or will have once our proposals in flight arrive
+    */
+   int64_t
+   follower_highest_proposal_id (
+      boost::asio::ip::tcp::endpoint const &    follower_endpoint,
+      detail::quorum::server_view &             quorum);
+
+   /*!
+     \brief Whether a follower needs history we do not have anymore
+    */
+   bool
+   needs_snapshot (
+      boost::asio::ip::tcp::endpoint const &    follower_endpoint,
+      detail::quorum::server_view &             quorum);
+
+   /*!
+     \brief Sends the next range of history to a follower that lags behind
+
+     Only a single range is in flight per follower at any time, so the rate at which history
+     is transferred is limited by the follower, and never competes with the follower's
+     proposals. When the follower needs history we do not have anymore, it is sent a
+     snapshot of our state instead.
+    */
+   void
+   send_catch_up (
+      boost::asio::ip::tcp::endpoint const &    follower_endpoint,
+      tcp_connection_ptr                        follower_connection,
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state);
+
+   /*!
+     \brief Sends a 'catch up' or 'snapshot' command, along with the history that follows it
+    */
+   void
+   write_catch_up (
+      boost::asio::ip::tcp::endpoint const &    follower_endpoint,
+      tcp_connection_ptr                        follower_connection,
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state,
+      detail::command &                         command);
+
+   /*!
+     \brief Received by leader as a response to a 'catch up' command
+    */
+   void
+   receive_caught_up (
+      boost::optional <enum detail::error_code> error,
+      boost::asio::ip::tcp::endpoint const &    follower_endpoint,
+      tcp_connection_ptr                        follower_connection,
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state,
+      detail::command const &                   command);
+
+   /*!
+     \brief Called when the state of a proposal is destroyed
+    */
+   void
+   finish_proposal ();
+
+   /*!
+     \brief Whether we currently hold a leader lease
+    */
+   bool
+   has_lease () const;
+
+   /*!
+     \brief Extends our lease, now that a majority granted it at \c started
+    */
+   void
+   extend_lease (
+      std::chrono::steady_clock::time_point     started);
+
+   /*!
+     \brief As a follower, grants \c leader a lease, if leases are enabled
+    */
+   void
+   grant_lease (
+      boost::asio::ip::tcp::endpoint const &    leader);
+
+   /*!
+     \brief Answers the reads that have been confirmed, or confirms the pending ones
+    */
+   void
+   process_reads (
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state);
+
+   /*!
+     \brief Sends a 'prepare' to all live servers to confirm we are still the leader
+    */
+   void
+   send_lease_prepares (
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state);
+
+   /*!
+     \brief Received by leader as a response to a 'prepare' sent by send_lease_prepares ()
+    */
+   void
+   receive_lease_promise (
+      boost::optional <enum detail::error_code> error,
+      boost::asio::ip::tcp::endpoint const &    follower_endpoint,
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state,
+      detail::command const &                   command,
+      boost::shared_ptr <struct lease_state>    state);
+
+   /*!
+     \brief Answers the follower reads that wait for proposals we have stored by now
+    */
+   void
+   process_follower_reads (
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state);
+
+   /*!
+     \brief Answers a read from our local state, after all workloads processed so far
+    */
+   void
+   answer_read (
+      tcp_connection_ptr                        client_connection,
+      detail::command const &                   command,
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state);
+
+   /*!
+     \brief Writes a response from follower to leader, once it is its turn
+
+     With group commit, the response is held back until all values accepted in the meantime
+     have been flushed to durable storage.
+    */
+   void
+   send_response (
+      tcp_connection_ptr                        leader_connection,
+      detail::command const &                   response);
+
+   /*!
+     \brief Ensures flush_responses () is called once the commands received so far have
+            been dispatched
+    */
+   void
+   schedule_flush (
+      tcp_connection_ptr                        connection);
+
+   /*!
+     \brief Flushes durable storage, processes the workloads held back by apply_durable ()
+            and writes all responses held back by send_response ()
+    */
+   void
+   flush_responses ();
+
+   /*!
+     \brief Replies to the client(s) once enough followers have responded to our 'accept'
+    */
+   void
+   process_accepted (
+      detail::quorum::server_view &             quorum,
+      boost::shared_ptr <struct state>          state);
+
+   /*!
+     \brief Time by which followers must have replied to commands that belong to a round
+            which was started at \c started
+
+     A follower that fails to do so is treated as if its connection died, which causes it
+     to reject the round: a single hung follower must not stall all later proposals.
+    */
+   std::chrono::steady_clock::time_point
+   deadline (
+      std::chrono::steady_clock::time_point     started) const;
+
+   /*!
+     \brief Returns the responses a majority of the quorum has accepted and agrees upon, if any
+    */
+   boost::optional <std::vector <std::string> >
+   majority_responses (
+      detail::quorum::server_view const &       quorum,
+      struct state const &                      state) const;
 
 private:
 
    durable::storage &   storage_;
 
+   /*!
+     \brief Whether we reply to the client(s) as soon as a majority has accepted a proposal
+    */
+   bool                 majority_commit_;
+
+   /*!
+     \brief Amount of proposals this leader has in flight
+    */
+   std::size_t          proposals_in_flight_;
+
+   /*!
+     \brief Most recent proposal id assigned to a proposal that is in flight
+    */
+   int64_t              highest_assigned_proposal_id_;
+
+   /*!
+     \brief Most recent proposal id for which 'accept' commands have been sent to all followers
+
+     This is advertised as our own highest proposal id: followers might have already
+     accepted it before we did, and would otherwise not consider us their leader anymore.
+    */
+   int64_t              highest_sent_proposal_id_;
+
+   /*!
+     \brief Most recent proposal id sent to each follower
+
+     Followers only report their highest proposal id once they have processed a proposal,
+     so we need this to determine the history a follower should be caught up with while
+     other proposals are still in flight.
+    */
+   std::map <boost::asio::ip::tcp::endpoint, int64_t>   follower_proposal_ids_;
+
+   /*!
+     \brief Most recent proposal id of which the response has been sent to a client
+
+     Reads must reflect at least this proposal. With majority commit, we might not have
+     processed it ourselves yet.
+    */
+   int64_t              highest_replied_proposal_id_;
+
+   /*!
+     \brief Duration of a leader lease in milliseconds, 0 if leases are disabled
+    */
+   uint32_t                                             lease_timeout_;
+
+   /*!
+     \brief Milliseconds a follower has to reply to a Paxos instance, 0 if it can take forever
+    */
+   uint32_t                                             timeout_;
+
+   /*!
+     \brief As a leader, when our lease expires
+
+     Leases are measured with a monotonic clock, so that adjusting the wall clock of a
+     server can never make its lease outlast the ones its followers granted.
+    */
+   std::chrono::steady_clock::time_point                lease_expiry_;
+
+   /*!
+     \brief As a follower, the leader we most recently granted a lease to, and when it expires
+    */
+   boost::asio::ip::tcp::endpoint                       granted_leader_;
+   std::chrono::steady_clock::time_point                granted_expiry_;
+
+   /*!
+     \brief Reads waiting for us to confirm we are still the leader
+    */
+   detail::strategy::batch                              pending_reads_;
+
+   /*!
+     \brief Reads waiting for us to process the proposals they must reflect
+    */
+   detail::strategy::batch                              confirmed_reads_;
+
+   /*!
+     \brief Whether a round of send_lease_prepares () is in flight
+    */
+   bool                                                 lease_round_in_flight_;
+
+   /*!
+     \brief Follower reads, by the proposal id they wait for us to store
+    */
+   std::multimap <int64_t, detail::strategy::batch::value_type>                follower_reads_;
+
+   /*!
+     \brief Followers that are being caught up in the background, and do not take part in proposals
+    */
+   std::set <boost::asio::ip::tcp::endpoint>            catching_up_;
+
+   /*!
+     \brief As a follower, responses waiting for durable storage to be flushed
+
+     Every response is held back while others are waiting, so that they are still written
+     in order.
+    */
+   std::vector <std::pair <tcp_connection_ptr, detail::command> >       pending_responses_;
+
+   /*!
+     \brief As a follower, calls to apply () waiting for durable storage to be flushed
+    */
+   std::vector <boost::function <void ()> >                             awaiting_flush_;
+
+   /*!
+     \brief Whether a call to flush_responses () has been scheduled
+    */
+   bool                                                                 flush_scheduled_;
+
+   /*!
+     \brief Thread that calls the processor, if enabled
+    */
+   boost::scoped_ptr <detail::io_thread>                                apply_thread_;
+
+   /*!
+     \brief Amount of tasks scheduled with apply () of which the completion has not been called yet
+    */
+   std::size_t                                                          pending_applies_;
+
+   /*!
+     \brief Metrics looked up by set_metrics (), so that we never have to take the
+            registry's lock while recording our measurements
+    */
+   detail::metrics::counter *                                           proposals_;
+   detail::metrics::counter *                                           proposed_requests_;
+   detail::metrics::gauge *                                             proposals_in_flight_gauge_;
+   detail::metrics::histogram *                                         proposal_latency_;
+   detail::metrics::histogram *                                         storage_accept_latency_;
+   detail::metrics::histogram *                                         storage_flush_latency_;
+
+   std::map <boost::asio::ip::tcp::endpoint, struct follower_metrics>   follower_metrics_;
+
 };
 
 }; }; }; }; };
@@ -0,0 +1,24 @@
+#include "../../../configuration.hpp"
+
+#include "protocol/strategy.hpp"
+#include "factory.hpp"
+
+namespace paxos { namespace detail { namespace strategy { namespace multi_paxos {
+
+factory::factory (
+   paxos::configuration &       configuration)
+   : configuration_ (configuration)
+{
+}
+
+/*! virtual */ strategy *
+factory::create () const
+{
+   return new protocol::strategy (configuration_.durable_storage (),
+                                  configuration_.majority_commit (),
+                                  configuration_.apply_thread (),
+                                  configuration_.leader_leases () ? configuration_.timeout () : 0,
+                                  configuration_.timeout ());
+}
+
+}; }; }; };
@@ -0,0 +1,51 @@
+/*!
+  Copyright (c) 2012, Leon Mergen, all rights reserved.
+ */
+
+#ifndef LIBPAXOS_CPP_DETAIL_STRATEGY_MULTI_PAXOS_FACTORY_HPP
+#define LIBPAXOS_CPP_DETAIL_STRATEGY_MULTI_PAXOS_FACTORY_HPP
+
+#include "../factory.hpp"
+
+namespace paxos {
+class configuration;
+};
+
+namespace paxos { namespace detail { namespace strategy { namespace multi_paxos {
+
+/*!
+  \brief Factory which creates Multi-Paxos strategies
+
+  \par Examples
+
+  Set up a paxos::server that skips the prepare phase while its leadership is stable. Note
+  that all servers inside the quorum must use the same strategy.
+
+  \code{.cpp}
+
+  paxos::configuration configuration;
+  configuration.set_strategy_factory (
+     new paxos::detail::strategy::multi_paxos::factory (configuration));
+
+  \endcode
+ */
+class factory : public detail::strategy::factory
+{
+public:
+
+   factory (
+      paxos::configuration &    configuration);
+
+   virtual strategy *
+   create () const;
+
+private:
+
+   paxos::configuration &       configuration_;
+
+};
+
+} }; }; };
+
+
+#endif  //! LIBPAXOS_CPP_DETAIL_STRATEGY_MULTI_PAXOS_FACTORY_HPP
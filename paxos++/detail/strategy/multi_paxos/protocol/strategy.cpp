@@ -0,0 +1,240 @@
+#include "../../../quorum/server_view.hpp"
+#include "../../../paxos_context.hpp"
+#include "../../../command.hpp"
+#include "../../../tcp_connection.hpp"
+#include "../../../util/debug.hpp"
+
+#include "strategy.hpp"
+
+namespace paxos { namespace detail { namespace strategy { namespace multi_paxos { namespace protocol {
+
+
+strategy::strategy (
+   durable::storage &   storage,
+   bool                 majority_commit,
+   bool                 apply_thread,
+   uint32_t             lease_timeout,
+   uint32_t             timeout)
+   : detail::strategy::basic_paxos::protocol::strategy (storage,
+                                                        majority_commit,
+                                                        apply_thread,
+                                                        lease_timeout,
+                                                        timeout)
+{
+}
+
+/*! virtual */ void
+strategy::initiate (
+   detail::strategy::batch const &              requests,
+   detail::quorum::server_view &        quorum,
+   detail::paxos_context &              global_state,
+   queue_guard_type                     queue_guard)
+{
+   /*!
+     Followers that are being caught up in the background are not part of our ballot.
+    */
+   std::vector <boost::asio::ip::tcp::endpoint> live_servers = this->participating_servers (quorum,
+                                                                                              global_state);
+
+   if (quorum.has_majority () == false
+       || quorum.is_majority (live_servers.size ()) == false
+       || this->has_ballot (quorum, live_servers) == false)
+   {
+      /*!
+        Either something changed in the quorum since we established our ballot, or we
+        never established one at all. Run the full protocol, which (re-)establishes our
+        ballot once all followers have accepted.
+       */
+      ballot_.clear ();
+
+      detail::strategy::basic_paxos::protocol::strategy::initiate (requests,
+                                                                   quorum,
+                                                                   global_state,
+                                                                   queue_guard);
+      return;
+   }
+
+   PAXOS_DEBUG ("leader " << quorum.our_endpoint () << " has established ballot, skipping prepare");
+
+   boost::shared_ptr <struct state> state = this->create_state (requests,
+                                                                queue_guard);
+
+   /*!
+     All followers in our ballot have already promised to accept our proposals, so we
+     consider them as having acknowledged this proposal's prepare.
+    */
+   for (boost::asio::ip::tcp::endpoint const & endpoint : live_servers)
+   {
+      state->connections[endpoint] = ballot_[endpoint];
+      state->accepted[endpoint]    = response_ack;
+   }
+
+   send_accepts (quorum,
+                 global_state,
+                 state);
+}
+
+
+/*! virtual */ void
+strategy::prepare (
+   tcp_connection_ptr                   leader_connection,
+   detail::command const &              command,
+   detail::quorum::server_view &        quorum,
+   detail::paxos_context &              global_state)
+{
+   this->process_remote_host_information (command,
+                                          quorum);
+
+   /*!
+     Any prepare revokes our previous promise. These are the same conditions under which
+     the basic protocol sends a promise.
+    */
+   boost::optional <boost::asio::ip::tcp::endpoint> leader = quorum.who_is_our_leader ();
+
+   promised_connection_.reset ();
+
+   if (leader.is_initialized () == true
+       && *leader == command.host_endpoint ()
+       && this->may_lead (command.host_endpoint ()) == true
+       && command.next_proposal_id () > this->proposal_id ())
+   {
+      promised_leader_     = command.host_endpoint ();
+      promised_connection_ = leader_connection;
+   }
+
+   detail::strategy::basic_paxos::protocol::strategy::prepare (leader_connection,
+                                                               command,
+                                                               quorum,
+                                                               global_state);
+}
+
+
+/*! virtual */ void
+strategy::accept (
+   tcp_connection_ptr                   leader_connection,
+   detail::command const &              command,
+   detail::quorum::server_view &        quorum,
+   detail::paxos_context &              global_state)
+{
+   /*!
+     Note that the basic protocol already validates that the proposal continues our history.
+    */
+   if (promised_connection_.lock () != leader_connection
+       || promised_leader_ != command.host_endpoint ())
+   {
+      PAXOS_WARN ("accept coming from host we did not promise to: " << command.host_endpoint ());
+
+      this->process_remote_host_information (command,
+                                             quorum);
+
+      detail::command response;
+      response.set_type (command::type_request_fail);
+      response.set_error_code (detail::error_no_leader);
+
+      this->add_local_host_information (quorum, response);
+
+      this->write_response (leader_connection,
+                            response);
+      return;
+   }
+
+   detail::strategy::basic_paxos::protocol::strategy::accept (leader_connection,
+                                                              command,
+                                                              quorum,
+                                                              global_state);
+}
+
+
+/*! virtual */ void
+strategy::receive_promise (
+   boost::optional <enum detail::error_code>    error,
+   boost::asio::ip::tcp::endpoint const &       follower_endpoint,
+   tcp_connection_ptr                           follower_connection,
+   detail::quorum::server_view &                quorum,
+   detail::paxos_context &                      global_state,
+   detail::command const &                      command,
+   boost::shared_ptr <struct state>             state)
+{
+   if (error || command.type () != command::type_request_promise)
+   {
+      ballot_.clear ();
+   }
+
+   detail::strategy::basic_paxos::protocol::strategy::receive_promise (error,
+                                                                       follower_endpoint,
+                                                                       follower_connection,
+                                                                       quorum,
+                                                                       global_state,
+                                                                       command,
+                                                                       state);
+}
+
+
+/*! virtual */ void
+strategy::receive_accepted (
+   boost::optional <enum detail::error_code>    error,
+   boost::asio::ip::tcp::endpoint const &       follower_endpoint,
+   detail::quorum::server_view &                quorum,
+   detail::command const &                      command,
+   boost::shared_ptr <struct state>             state)
+{
+   detail::strategy::basic_paxos::protocol::strategy::receive_accepted (error,
+                                                                        follower_endpoint,
+                                                                        quorum,
+                                                                        command,
+                                                                        state);
+
+   if (state->accepted[follower_endpoint] != response_ack)
+   {
+      /*!
+        A follower either disappeared or rejected our proposal, which means it no longer
+        considers us its leader or has a different view of the history: the next request
+        must go through the prepare phase again.
+       */
+      ballot_.clear ();
+   }
+   else if (state->connections.size () == state->responses.size ()
+            && state->error_codes.empty () == true)
+   {
+      ballot_ = state->connections;
+   }
+}
+
+
+bool
+strategy::has_ballot (
+   detail::quorum::server_view &                                quorum,
+   std::vector <boost::asio::ip::tcp::endpoint> const &         live_servers)
+{
+   if (ballot_.empty () == true
+       || ballot_.size () != live_servers.size ())
+   {
+      return false;
+   }
+
+   boost::optional <boost::asio::ip::tcp::endpoint> leader = quorum.who_is_our_leader ();
+   if (leader.is_initialized () == false
+       || *leader != quorum.our_endpoint ())
+   {
+      return false;
+   }
+
+   for (boost::asio::ip::tcp::endpoint const & endpoint : live_servers)
+   {
+      auto pos = ballot_.find (endpoint);
+
+      /*!
+        If a follower reconnected, it might have been restarted in the meantime, and it
+        will have to promise again.
+       */
+      if (pos == ballot_.end ()
+          || pos->second != quorum.lookup_server (endpoint).connection ())
+      {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+}; }; }; }; };
@@ -0,0 +1,134 @@
+/*!
+  Copyright (c) 2012, Leon Mergen, all rights reserved.
+ */
+
+#ifndef LIBPAXOS_CPP_DETAIL_STRATEGY_MULTI_PAXOS_PROTOCOL_STRATEGY_HPP
+#define LIBPAXOS_CPP_DETAIL_STRATEGY_MULTI_PAXOS_PROTOCOL_STRATEGY_HPP
+
+#include <boost/weak_ptr.hpp>
+
+#include "../../basic_paxos/protocol/strategy.hpp"
+
+namespace paxos { namespace detail { namespace strategy { namespace multi_paxos { namespace protocol {
+
+/*!
+  \brief Multi-Paxos variant of the basic Paxos protocol
+
+  The basic Paxos protocol runs a full prepare -> promise -> accept -> accepted cycle for
+  every request. This strategy runs that full cycle only once to establish a ballot for the
+  current leader: as long as the leader and the set of live followers (including their
+  connections) do not change, and no follower rejects a proposal, subsequent requests are
+  sent straight to the accept phase.
+
+  Since the prepare phase is skipped, followers remember the leader (and the connection to
+  it) they last promised to, and only accept proposals from that leader that continue their
+  history. A new prepare, from whichever host, revokes this promise. Any rejection, error or
+  change in the quorum drops the leader's ballot, after which the next request runs the full
+  cycle again.
+ */
+class strategy : public detail::strategy::basic_paxos::protocol::strategy
+{
+public:
+
+   strategy (
+      durable::storage &        storage,
+      bool                      majority_commit = false,
+      bool                      apply_thread = false,
+      uint32_t                  lease_timeout = 0,
+      uint32_t                  timeout = 0);
+
+   /*!
+     \brief Received by leader from client(s) that initiate a request
+    */
+   virtual void
+   initiate (
+      detail::strategy::batch const &                   requests,
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state,
+      queue_guard_type                          queue_guard);
+
+   /*!
+     \brief Received by follower when leader wants to prepare a request
+
+     Remembers the leader we promised to, so that later accepts can be validated.
+    */
+   virtual void
+   prepare (
+      tcp_connection_ptr                        leader_connection,
+      detail::command const &                   command,
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state);
+
+   /*!
+     \brief Received by follower when leader wants to process a request
+
+     Validates that the request comes from the leader we promised to before processing it,
+     since the prepare phase might have been skipped.
+    */
+   virtual void
+   accept (
+      tcp_connection_ptr                        leader_connection,
+      detail::command const &                   command,
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state);
+
+protected:
+
+   /*!
+     \brief Received by leader as a response to a 'prepare' command
+    */
+   virtual void
+   receive_promise (
+      boost::optional <enum detail::error_code> error,
+      boost::asio::ip::tcp::endpoint const &    follower_endpoint,
+      tcp_connection_ptr                        follower_connection,
+      detail::quorum::server_view &             quorum,
+      detail::paxos_context &                   global_state,
+      detail::command const &                   command,
+      boost::shared_ptr <struct state>          state);
+
+   /*!
+     \brief Received by leader as a response to a 'accept' command
+
+     Establishes the ballot when every follower has accepted, and drops it otherwise.
+    */
+   virtual void
+   receive_accepted (
+      boost::optional <enum detail::error_code> error,
+      boost::asio::ip::tcp::endpoint const &    follower_endpoint,
+      detail::quorum::server_view &             quorum,
+      detail::command const &                   command,
+      boost::shared_ptr <struct state>          state);
+
+private:
+
+   /*!
+     \brief Returns true if we are still the leader of the same set of followers we
+            established our ballot with
+    */
+   bool
+   has_ballot (
+      detail::quorum::server_view &             quorum,
+      std::vector <boost::asio::ip::tcp::endpoint> const &      live_servers);
+
+private:
+
+   /*!
+     \brief The followers, and the connections to them, that promised to our ballot
+    */
+   std::map <boost::asio::ip::tcp::endpoint, detail::tcp_connection_ptr>        ballot_;
+
+   /*!
+     \brief As a follower, the leader we most recently promised to
+    */
+   boost::asio::ip::tcp::endpoint                                               promised_leader_;
+
+   /*!
+     \brief As a follower, the connection the most recent promise was sent over
+    */
+   boost::weak_ptr <detail::tcp_connection>                                     promised_connection_;
+};
+
+}; }; }; }; };
+
+#endif //! LIBPAXOS_CPP_DETAIL_STRATEGY_MULTI_PAXOS_PROTOCOL_STRATEGY_HPP
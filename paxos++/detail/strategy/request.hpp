@@ -5,6 +5,10 @@
 #ifndef LIBPAXOS_CPP_DETAIL_STRATEGY_REQUEST_HPP
 #define LIBPAXOS_CPP_DETAIL_STRATEGY_REQUEST_HPP
 
+#include <chrono>
+#include <vector>
+#include <utility>
+
 #include "../command.hpp"
 #include "../tcp_connection_fwd.hpp"
 
@@ -18,17 +22,40 @@ class server_view;
 
 namespace paxos { namespace detail { namespace strategy {
 
+/*!
+  \brief Client requests that are proposed together, along with the connection to reply to
+ */
+typedef std::vector <std::pair <detail::tcp_connection_ptr, detail::command> >     batch;
+
 /*!
   \brief Keeps track of context information required by the various Paxos protocol implementations
  */
 struct request
 {
+   request (
+      detail::tcp_connection_ptr        connection,
+      detail::command const &           command,
+      detail::quorum::server_view &     quorum,
+      detail::paxos_context &           global_state);
+
    detail::tcp_connection_ptr    connection_;
    detail::command               command_;
    detail::quorum::server_view & quorum_;
    detail::paxos_context &       global_state_;
+
+   /*!
+     \brief Requests that arrived later and are proposed together with this request
+    */
+   detail::strategy::batch       batch_;
+
+   /*!
+     \brief When the request was put on the request queue
+    */
+   std::chrono::steady_clock::time_point queued_;
 };
 
 }; }; };
 
+#include "request.inl"
+
 #endif //! LIBPAXOS_CPP_DETAIL_STRATEGY_REQUEST_HPP
@@ -0,0 +1,16 @@
+namespace paxos { namespace detail { namespace strategy {
+
+inline request::request (
+   detail::tcp_connection_ptr           connection,
+   detail::command const &              command,
+   detail::quorum::server_view &        quorum,
+   detail::paxos_context &              global_state)
+   : connection_ (connection),
+     command_ (command),
+     quorum_ (quorum),
+     global_state_ (global_state),
+     queued_ (std::chrono::steady_clock::now ())
+{
+}
+
+}; }; };
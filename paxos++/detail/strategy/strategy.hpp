@@ -19,6 +19,10 @@ class command;
 class paxos_context;
 }; };
 
+namespace paxos { namespace detail { namespace metrics {
+class registry;
+}; }; };
+
 namespace paxos { namespace detail { namespace strategy {
 
 /*!
@@ -32,15 +36,27 @@ protected:
 
 public:
 
+   strategy ();
+
    virtual ~strategy ();
 
    /*!
-     \brief Received by leader from client that initiates a request
+     \brief Adjusts the registry in which this strategy records its measurements
+     \note The registry must outlive this strategy
+    */
+   virtual void
+   set_metrics (
+      detail::metrics::registry &       metrics);
+
+   /*!
+     \brief Received by leader from client(s) that initiate a request
+
+     When the leader batches requests, \c requests contains all requests that should be
+     proposed together; otherwise, it contains a single request.
     */
    virtual void
    initiate (      
-      tcp_connection_ptr                client_connection,
-      detail::command const &           command,
+      detail::strategy::batch const &           requests,
       detail::quorum::server_view &     quorum,
       detail::paxos_context &           global_state,
       queue_guard_type                  queue_guard) = 0;
@@ -71,8 +87,57 @@ public:
       detail::quorum::server_view &     quorum,
       detail::paxos_context &           global_state) = 0;
 
+
+   /*!
+     \brief Received by follower when leader sends it history it lags behind on
+
+     This request is received by a follower outside of any proposal, and contains a range
+     of history that has already been processed by the leader, optionally preceded by a
+     snapshot of the leader's state.
+    */
+   virtual void
+   catch_up (
+      tcp_connection_ptr                leader_connection,
+      detail::command const &           command,
+      detail::quorum::server_view &     quorum,
+      detail::paxos_context &           global_state) = 0;
+
+
+   /*!
+     \brief Received by leader from a client that sends a read-only request
+
+     Read-only requests are not proposed, but answered from the leader's local state.
+    */
+   virtual void
+   read (
+      tcp_connection_ptr                client_connection,
+      detail::command const &           command,
+      detail::quorum::server_view &     quorum,
+      detail::paxos_context &           global_state) = 0;
+
+
+   /*!
+     \brief Received by any server from a client that sends a read-only request, which must
+            reflect at least proposal command.next_proposal_id ()
+    */
+   virtual void
+   follower_read (
+      tcp_connection_ptr                client_connection,
+      detail::command const &           command,
+      detail::quorum::server_view &     quorum,
+      detail::paxos_context &           global_state) = 0;
+
+protected:
+
+   /*!
+     \brief Access to the registry in which this strategy records its measurements
+    */
+   detail::metrics::registry &
+   metrics ();
+
 private:
 
+   detail::metrics::registry *          metrics_;
 };
 
 } }; };
@@ -1,7 +1,26 @@
 namespace paxos { namespace detail { namespace strategy {
 
+inline strategy::strategy ()
+   : metrics_ (NULL)
+{
+}
+
 inline /*! virtual */ strategy::~strategy ()
 {
 }
 
+inline /*! virtual */ void
+strategy::set_metrics (
+   detail::metrics::registry &  metrics)
+{
+   metrics_ = &metrics;
+}
+
+inline detail::metrics::registry &
+strategy::metrics ()
+{
+   PAXOS_ASSERT (metrics_ != NULL);
+   return *metrics_;
+}
+
 }; }; };
@@ -3,9 +3,11 @@
 
 #include <assert.h>
 #include <boost/asio/write.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/asio/placeholders.hpp>
 
 #include "util/debug.hpp"
+#include "util/trace.hpp"
 
 #include "parser.hpp"
 #include "command_dispatcher.hpp"
@@ -15,8 +17,16 @@ namespace paxos { namespace detail {
 
 
 tcp_connection::tcp_connection (
-   boost::asio::io_service &                    io_service)
-   : socket_ (io_service)
+   boost::asio::io_service &                    io_service,
+   boost::asio::io_service::strand &            strand)
+   : io_service_ (io_service),
+     socket_ (io_service),
+     socket_strand_ (io_service),
+     strand_ (strand),
+     read_begin_ (0),
+     read_end_ (0),
+     bytes_read_ (0),
+     bytes_written_ (0)
 {
 }
 
@@ -29,16 +39,29 @@ tcp_connection::~tcp_connection ()
 
 /*! static */ tcp_connection_ptr 
 tcp_connection::create (
-   boost::asio::io_service &                    io_service)
+   boost::asio::io_service &                    io_service,
+   boost::asio::io_service::strand &            strand)
 {
    return tcp_connection_ptr (
-      new tcp_connection (io_service));
+      new tcp_connection (io_service,
+                          strand));
 }
 
 void
 tcp_connection::close ()
 {
-   socket_.close ();
+   tcp_connection_ptr self = shared_from_this ();
+
+   /*!
+     Posting rather than dispatching ensures that writes issued before we were called have
+     been started before the socket is closed.
+    */
+   socket_strand_.post (
+      [self] ()
+      {
+         boost::system::error_code error;
+         self->socket_.close (error);
+      });
 }
 
 bool
@@ -53,6 +76,30 @@ tcp_connection::socket ()
    return socket_;
 }
 
+uint64_t
+tcp_connection::bytes_read () const
+{
+   return bytes_read_.load (std::memory_order_relaxed);
+}
+
+uint64_t
+tcp_connection::bytes_written () const
+{
+   return bytes_written_.load (std::memory_order_relaxed);
+}
+
+boost::asio::io_service::strand &
+tcp_connection::strand ()
+{
+   return strand_;
+}
+
+boost::asio::io_service::strand &
+tcp_connection::socket_strand ()
+{
+   return socket_strand_;
+}
+
 
 void
 tcp_connection::write_command (
@@ -66,8 +113,160 @@ void
 tcp_connection::read_command (
    read_callback        callback)
 {
-   parser::read_command (shared_from_this (),
-                         callback);
+   boost::shared_ptr <read_queue> queue;
+   bool                           start = false;
+
+   {
+      boost::mutex::scoped_lock lock (read_mutex_);
+
+      queue = pending_reads_.lock ();
+      if (!queue)
+      {
+         queue.reset (new read_queue ());
+         pending_reads_ = queue;
+         start          = true;
+      }
+
+      queue->push (callback);
+   }
+
+   /*!
+     Boost.Asio doesn't allow multiple async_read calls on the same socket at the same
+     time, so if another read is already pending, handle_read () will start ours.
+    */
+   if (start == true)
+   {
+      start_read (queue);
+   }
+}
+
+void
+tcp_connection::read_command (
+   read_callback                                callback,
+   std::chrono::steady_clock::time_point        deadline)
+{
+   if (deadline == std::chrono::steady_clock::time_point::max ())
+   {
+      this->read_command (callback);
+      return;
+   }
+
+   boost::shared_ptr <boost::asio::steady_timer> timer (
+      new boost::asio::steady_timer (io_service_,
+                                     deadline));
+
+   /*!
+     Both the read callback and the timer handler run inside our strand, so whichever of
+     them runs first decides the outcome.
+    */
+   boost::shared_ptr <bool> completed (new bool (false));
+   tcp_connection_ptr       self = shared_from_this ();
+
+   timer->async_wait (
+      strand_.wrap (
+         [completed,
+          self] (boost::system::error_code const & error)
+         {
+            if (!error && *completed == false)
+            {
+               self->handle_deadline ();
+            }
+         }));
+
+   this->read_command (
+      [completed,
+       timer,
+       callback] (boost::optional <enum error_code>     error,
+                  command const &                       command)
+      {
+         *completed = true;
+         timer->cancel ();
+
+         callback (error,
+                   command);
+      });
+}
+
+void
+tcp_connection::handle_deadline ()
+{
+   tcp_connection_ptr self = shared_from_this ();
+
+   socket_strand_.post (
+      [self] ()
+      {
+         boost::system::error_code error;
+
+         PAXOS_WARN ("no reply received from " << self->socket_.remote_endpoint (error)
+                     << " in time, shutting down connection");
+         PAXOS_TRACE_EVENT (read_timed_out,
+                            util::trace::endpoint (self->socket_.remote_endpoint (error)));
+
+         /*!
+           Shutting down rather than closing the socket makes the pending read, and any read
+           started after it, complete with an error, while the socket can still be closed
+           through close () as usual.
+          */
+         self->socket_.shutdown (boost::asio::ip::tcp::socket::shutdown_both,
+                                 error);
+      });
+}
+
+void
+tcp_connection::start_read (
+   boost::shared_ptr <read_queue>       queue)
+{
+   /*!
+     The receive buffer and the socket are only accessed from within socket_strand_.
+    */
+   socket_strand_.dispatch (
+      std::bind (&parser::read_command,
+                 shared_from_this (),
+                 parser::callback_function (
+                    std::bind (&tcp_connection::handle_read,
+                               shared_from_this (),
+                               queue,
+                               std::placeholders::_1,
+                               std::placeholders::_2))));
+}
+
+void
+tcp_connection::handle_read (
+   boost::shared_ptr <read_queue>       queue,
+   boost::optional <enum error_code>    error,
+   command const &                      command)
+{
+   read_callback callback;
+   bool          more = false;
+
+   {
+      boost::mutex::scoped_lock lock (read_mutex_);
+
+      PAXOS_ASSERT (queue->empty () == false);
+
+      callback = queue->front ();
+      queue->pop ();
+
+      more = (queue->empty () == false);
+
+      if (more == false)
+      {
+         pending_reads_.reset ();
+      }
+   }
+
+   /*!
+     Start the next read before dispatching this command, so that the callback can safely
+     issue new reads. If an error occured, the next read will fail as well, and every
+     pending callback gets notified of the error.
+    */
+   if (more == true)
+   {
+      start_read (queue);
+   }
+
+   callback (error,
+             command);
 }
 
 void
@@ -96,58 +295,68 @@ tcp_connection::read_command_loop (
 
 void
 tcp_connection::write (
-   std::string const &  message)
+   frame_ptr            frame)
 {
-   boost::mutex::scoped_lock lock (mutex_);
-   write_locked (message);
+   tcp_connection_ptr self = shared_from_this ();
+
+   /*!
+     Frames must be written in the order in which they were written to us, so we always
+     post: dispatching would write the frame right away when we are called from a handler
+     nested inside socket_strand_, overtaking frames that other threads posted earlier.
+    */
+   socket_strand_.post (
+      [self,
+       frame] ()
+      {
+         /*!
+           Boost.Asio doesn't allow multiple async_write calls on the same socket at the same
+           time, so if a write is already in progress, we queue the frame: handle_write ()
+           writes all frames queued in the meantime using a single async_write.
+          */
+         self->write_queue_.push_back (frame);
+
+         if (self->writing_.empty () == true)
+         {
+            self->start_write ();
+         }
+      });
 }
 
 void
-tcp_connection::write_locked (
-   std::string const &  message)
+tcp_connection::start_write ()
 {
+   PAXOS_ASSERT (write_queue_.empty () == false);
+   PAXOS_ASSERT (writing_.empty () == true);
+
    /*!
-     The problem with Boost.Asio is that it assumes that the buffer we send to async_write ()
-     must stay alive until the callback to handle_write () has been called. Since there is no
-     way we can guarantee that if we use the message object we get as a reference to this function,
-     we have no alternative but to copy the data into our local buffer.
-
-     But wait! What happends when write() is called when we are not yet done writing another
-     block? In that case, we will just append that data onto the queue. The handle_write () function
-     checks whether any data is still pending on the queue, and if so, ensures another async_write ()
-     is called.
+     The frames must stay alive until handle_write () has been called, which is why we hold
+     on to them in writing_.
     */
+   writing_.swap (write_queue_);
 
-   if (write_buffer_.empty () == true)
-   {
-      write_buffer_ = message;
+   std::vector <boost::asio::const_buffer> buffers;
+   buffers.reserve (2 * writing_.size ());
 
-      start_write_locked ();
-   }
-   else
+   for (frame_ptr const & frame : writing_)
    {
-      write_buffer_ += message;
+      buffers.push_back (boost::asio::buffer (frame->header));
+      buffers.push_back (boost::asio::buffer (frame->body));
    }
-}
-
-void
-tcp_connection::start_write_locked ()
-{
-   PAXOS_ASSERT (write_buffer_.empty () == false);
 
    boost::asio::async_write (socket_,
-                             boost::asio::buffer (write_buffer_),
-                             std::bind (&tcp_connection::handle_write, 
-
-                                        /*!
-                                          Using shared_from_this here instead of this ensures that
-                                          we obtain a shared pointer to ourselves, and so when our
-                                          object would go out of scope normally, it at least stays
-                                          alive until this callback is called.
-                                        */
-                                        shared_from_this(),
-                                        std::placeholders::_1,
-                                        std::placeholders::_2));
+                             buffers,
+                             socket_strand_.wrap (
+                                std::bind (&tcp_connection::handle_write, 
+
+                                           /*!
+                                             Using shared_from_this here instead of this ensures that
+                                             we obtain a shared pointer to ourselves, and so when our
+                                             object would go out of scope normally, it at least stays
+                                             alive until this callback is called.
+                                           */
+                                           shared_from_this(),
+                                           std::placeholders::_1,
+                                           std::placeholders::_2)));
 }
 
 void
@@ -155,32 +364,22 @@ tcp_connection::handle_write (
    boost::system::error_code const &    error,
    size_t                               bytes_transferred)
 {
+   writing_.clear ();
+
    if (error)
    {
       PAXOS_WARN ("an error occured while writing data: " << error.message ());
+
+      /*!
+        The other side will never receive these frames
+       */
+      write_queue_.clear ();
       return;
    }
 
-   boost::mutex::scoped_lock lock (mutex_);
-   handle_write_locked (bytes_transferred);
-}
-
-
-void
-tcp_connection::handle_write_locked (
-   size_t                               bytes_transferred)
-{
-   PAXOS_ASSERT (write_buffer_.size () >= bytes_transferred);
-
-   write_buffer_ = write_buffer_.substr (bytes_transferred);
-
-   /*!
-     As discussed in the write () function, if we still have data on the buffer, ensure
-     that data is also written.
-    */
-   if (write_buffer_.empty () == false)
+   if (write_queue_.empty () == false)
    {
-      start_write_locked ();
+      start_write ();
    }
 }
 
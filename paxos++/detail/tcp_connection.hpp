@@ -5,12 +5,17 @@
 #ifndef LIBPAXOS_CPP_DETAIL_TCP_CONNECTION_HPP
 #define LIBPAXOS_CPP_DETAIL_TCP_CONNECTION_HPP
 
+#include <atomic>
+#include <chrono>
+#include <queue>
 #include <vector>
 
 #include <boost/function.hpp>
 #include <boost/optional.hpp>
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/strand.hpp>
 #include <boost/shared_ptr.hpp>
+#include <boost/weak_ptr.hpp>
 #include <boost/enable_shared_from_this.hpp>
 #include <boost/thread/mutex.hpp>
 
@@ -40,6 +45,10 @@ namespace paxos { namespace detail {
   Note that this does not necessarily needs to represent a long-lived connection to another 
   server inside the quorum: since the quorum can also build up short-lived connections to each
   other, and clients can also connect to the local server, this can be a connection to anything.
+
+  Every operation on the socket runs inside a strand owned by the connection, so the
+  connection can be used from any thread; only decoded commands are handed to the strand
+  passed to create ().
  */
 class tcp_connection 
    : public boost::enable_shared_from_this <tcp_connection>
@@ -51,19 +60,55 @@ public:
    typedef boost::function <void (boost::optional <enum error_code>,
                                   command const &)>                     read_callback;
 
+   typedef std::queue <read_callback>                                   read_queue;
+
+   /*!
+     \brief A single command as written to the other side
+
+     The length prefix and the encoded command are kept apart, so that neither has to be
+     copied into a single buffer before it can be written.
+    */
+   struct frame
+   {
+      std::string       header;
+      std::string       body;
+   };
+
+   typedef boost::shared_ptr <frame const>                              frame_ptr;
+
 public:
    ~tcp_connection ();
 
+   /*!
+     \brief Creates a new connection
+     \param strand Strand through which all commands read from this connection are dispatched
+    */
    static tcp_connection_ptr
    create (
-      boost::asio::io_service &                 io_service);
+      boost::asio::io_service &                 io_service,
+      boost::asio::io_service::strand &         strand);
 
 
    boost::asio::ip::tcp::socket &
    socket ();
 
+   /*!
+     \brief Strand through which all commands read from this connection are dispatched
+    */
+   boost::asio::io_service::strand &
+   strand ();
+
+   /*!
+     \brief Strand inside which all operations on socket () run
+    */
+   boost::asio::io_service::strand &
+   socket_strand ();
+
    /*!
      \brief Closes socket ()
+
+     The socket is closed from within socket_strand (), so this returns before it has been
+     closed.
     */
    void
    close ();
@@ -83,11 +128,32 @@ public:
 
    /*!
      \brief Reads a command from the other side
+
+     Multiple reads can be pending at the same time: commands are then dispatched to the
+     callbacks in the order in which read_command () was called. This allows a leader to
+     pipeline multiple proposals over the same connection with a follower.
     */
    void
    read_command (
       read_callback             callback);
 
+   /*!
+     \brief Reads a command from the other side, unless \c deadline passes first
+
+     Commands are matched to reads in order, so a reply that arrives after its deadline
+     would be taken for the reply to the next read. Instead, the connection is shut down
+     once the deadline passes: this read, and all reads behind it, fail with
+     error_connection_close.
+
+     The deadline is measured with a monotonic clock, so adjusting the wall clock does not
+     affect it. A deadline of std::chrono::steady_clock::time_point::max () waits forever,
+     just like the overload above.
+    */
+   void
+   read_command (
+      read_callback                             callback,
+      std::chrono::steady_clock::time_point     deadline);
+
    /*!
      \brief Keeps reading commands  until connection error occurs
 
@@ -99,41 +165,110 @@ public:
    read_command_loop (
       read_callback             callback);
 
+   /*!
+     \brief Amount of bytes received from the other side so far
+    */
+   uint64_t
+   bytes_read () const;
+
+   /*!
+     \brief Amount of bytes written to the other side so far, including those still in flight
+    */
+   uint64_t
+   bytes_written () const;
+
 private:
 
    tcp_connection (
-      boost::asio::io_service &                 io_service);
+      boost::asio::io_service &                 io_service,
+      boost::asio::io_service::strand &         strand);
 
    void
-   write (
-      std::string const &       message);
+   start_read (
+      boost::shared_ptr <read_queue>    queue);
 
    void
-   write_locked (
-      std::string const &       message);
+   handle_read (
+      boost::shared_ptr <read_queue>    queue,
+      boost::optional <enum error_code> error,
+      command const &                   command);
 
+   /*!
+     \brief Called when the deadline of a read passed before the read completed
+    */
    void
-   start_write_locked ();
+   handle_deadline ();
 
    void
-   handle_write (
-      boost::system::error_code const & error,
-      size_t                            bytes_transferred);
+   write (
+      frame_ptr                 frame);
 
    void
-   handle_write_locked (
+   start_write ();
+
+   void
+   handle_write (
+      boost::system::error_code const & error,
       size_t                            bytes_transferred);
 
 private:
 
+   boost::asio::io_service &    io_service_;
+
    boost::asio::ip::tcp::socket socket_;
 
    /*!
-     \brief Synchronizes access to write_buffer_
+     \brief Serializes all operations on socket_, and access to the read and write state below
+
+     Commands are decoded inside this strand rather than strand_, so that multiple threads can
+     decode the commands of different connections at the same time.
+    */
+   boost::asio::io_service::strand      socket_strand_;
+
+   /*!
+     \brief Serializes our read callbacks with those of other connections
+    */
+   boost::asio::io_service::strand &    strand_;
+
+   /*!
+     \brief Frames waiting for the write in progress to complete
     */
-   boost::mutex                 mutex_;
+   std::vector <frame_ptr>      write_queue_;
 
-   std::string                  write_buffer_;
+   /*!
+     \brief Frames being written by the write in progress, if any
+    */
+   std::vector <frame_ptr>      writing_;
+
+   /*!
+     \brief Synchronizes access to pending_reads_
+    */
+   boost::mutex                 read_mutex_;
+
+   /*!
+     \brief Callbacks of pending reads, the front one is currently being read
+
+     The callbacks usually hold a pointer to this connection, so the queue is owned by the
+     pending read operation instead: this ensures that the connection can be destroyed when
+     its io_service is.
+    */
+   boost::weak_ptr <read_queue> pending_reads_;
+
+   /*!
+     \brief Data received from the other side, of which [read_begin_, read_end_) has not
+            been parsed yet
+
+     Only accessed from within socket_strand_, see parser::read_command ().
+    */
+   std::vector <char>           read_buffer_;
+   std::size_t                  read_begin_;
+   std::size_t                  read_end_;
+
+   /*!
+     \brief Updated by the parser, see bytes_read () and bytes_written ()
+    */
+   std::atomic <uint64_t>       bytes_read_;
+   std::atomic <uint64_t>       bytes_written_;
 };
 
 }; };
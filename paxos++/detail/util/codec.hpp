@@ -0,0 +1,178 @@
+/*!
+  Copyright (c) 2012, Leon Mergen, all rights reserved.
+ */
+
+#ifndef LIBPAXOS_CPP_DETAIL_UTIL_CODEC_HPP
+#define LIBPAXOS_CPP_DETAIL_UTIL_CODEC_HPP
+
+#include <stdint.h>
+#include <string>
+
+#include <boost/uuid/uuid.hpp>
+#include <boost/asio/ip/tcp.hpp>
+
+namespace paxos { namespace detail { namespace util {
+
+/*!
+  \brief Appends fixed-width, network byte order values to a byte array
+
+  This is the write side of the compact binary wire format used by detail::command. All
+  integers are written in big endian order, so that the format is independent of the
+  architecture of the hosts inside the quorum.
+ */
+class encoder
+{
+public:
+
+   /*!
+     \brief Constructor
+     \param output Byte array that all values are appended to
+    */
+   encoder (
+      std::string &     output);
+
+   void
+   put_uint8 (
+      uint8_t           value);
+
+   void
+   put_uint16 (
+      uint16_t          value);
+
+   void
+   put_uint32 (
+      uint32_t          value);
+
+   void
+   put_uint64 (
+      uint64_t          value);
+
+   void
+   put_int64 (
+      int64_t           value);
+
+   /*!
+     \brief Writes a length-prefixed byte array
+    */
+   void
+   put_bytes (
+      std::string const &       value);
+
+   /*!
+     \brief Writes the raw 16 bytes of a uuid
+    */
+   void
+   put_uuid (
+      boost::uuids::uuid const &        value);
+
+   /*!
+     \brief Writes a packed endpoint: address family, raw address bytes and port
+    */
+   void
+   put_endpoint (
+      boost::asio::ip::tcp::endpoint const &    value);
+
+   /*!
+     \brief Amount of bytes put_bytes () will write for \c value
+    */
+   static std::size_t
+   bytes_size (
+      std::string const &       value);
+
+   /*!
+     \brief Amount of bytes put_endpoint () will write for \c value
+    */
+   static std::size_t
+   endpoint_size (
+      boost::asio::ip::tcp::endpoint const &    value);
+
+private:
+
+   template <typename T> void
+   put_integer (
+      T                 value);
+
+private:
+
+   std::string &        output_;
+};
+
+
+/*!
+  \brief Reads values written by encoder from a contiguous block of memory
+
+  The decoder never copies or owns the memory it reads from, and validates every read
+  against the end of the block. A truncated or otherwise malformed block causes an
+  exception::protocol_error to be thrown.
+ */
+class decoder
+{
+public:
+
+   /*!
+     \brief Constructor
+     \param data Start of the block to read from
+     \param size Size of the block
+    */
+   decoder (
+      char const *      data,
+      std::size_t       size);
+
+   uint8_t
+   get_uint8 ();
+
+   uint16_t
+   get_uint16 ();
+
+   uint32_t
+   get_uint32 ();
+
+   uint64_t
+   get_uint64 ();
+
+   int64_t
+   get_int64 ();
+
+   /*!
+     \brief Reads a length-prefixed byte array into \c output
+    */
+   void
+   get_bytes (
+      std::string &     output);
+
+   boost::uuids::uuid
+   get_uuid ();
+
+   boost::asio::ip::tcp::endpoint
+   get_endpoint ();
+
+   /*!
+     \brief Amount of bytes not yet read
+    */
+   std::size_t
+   remaining () const;
+
+private:
+
+   template <typename T> T
+   get_integer ();
+
+   /*!
+     \brief Ensures at least \c size bytes are left to read
+     \throws exception::protocol_error
+    */
+   void
+   require (
+      std::size_t       size) const;
+
+private:
+
+   unsigned char const *        position_;
+   unsigned char const *        end_;
+};
+
+}; }; };
+
+#include "codec.inl"
+
+#endif //! LIBPAXOS_CPP_DETAIL_UTIL_CODEC_HPP
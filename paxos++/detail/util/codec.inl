@@ -0,0 +1,249 @@
+#include <string.h>
+
+#include "../../exception/exception.hpp"
+#include "debug.hpp"
+
+namespace paxos { namespace detail { namespace util {
+
+inline encoder::encoder (
+   std::string &        output)
+   : output_ (output)
+{
+}
+
+template <typename T> inline void
+encoder::put_integer (
+   T                    value)
+{
+   /*!
+     Same byte ordering as util::conversion: most significant byte first.
+    */
+   char bytes[sizeof (T)];
+
+   for (int16_t i = sizeof (T) - 1; i >= 0; --i)
+   {
+      bytes[i] = static_cast <char> (value & 0xff);
+      value    = static_cast <T> (static_cast <uint64_t> (value) >> 8);
+   }
+
+   output_.append (bytes, sizeof (T));
+}
+
+inline void
+encoder::put_uint8 (
+   uint8_t              value)
+{
+   output_.push_back (static_cast <char> (value));
+}
+
+inline void
+encoder::put_uint16 (
+   uint16_t             value)
+{
+   put_integer (value);
+}
+
+inline void
+encoder::put_uint32 (
+   uint32_t             value)
+{
+   put_integer (value);
+}
+
+inline void
+encoder::put_uint64 (
+   uint64_t             value)
+{
+   put_integer (value);
+}
+
+inline void
+encoder::put_int64 (
+   int64_t              value)
+{
+   put_integer (static_cast <uint64_t> (value));
+}
+
+inline void
+encoder::put_bytes (
+   std::string const &  value)
+{
+   put_uint32 (value.size ());
+   output_.append (value);
+}
+
+inline void
+encoder::put_uuid (
+   boost::uuids::uuid const &   value)
+{
+   output_.append (reinterpret_cast <char const *> (value.data), value.size ());
+}
+
+inline void
+encoder::put_endpoint (
+   boost::asio::ip::tcp::endpoint const &       value)
+{
+   if (value.address ().is_v6 () == true)
+   {
+      boost::asio::ip::address_v6::bytes_type bytes = value.address ().to_v6 ().to_bytes ();
+
+      put_uint8 (6);
+      output_.append (reinterpret_cast <char const *> (bytes.data ()), bytes.size ());
+   }
+   else
+   {
+      boost::asio::ip::address_v4::bytes_type bytes = value.address ().to_v4 ().to_bytes ();
+
+      put_uint8 (4);
+      output_.append (reinterpret_cast <char const *> (bytes.data ()), bytes.size ());
+   }
+
+   put_uint16 (value.port ());
+}
+
+/*! static */ inline std::size_t
+encoder::bytes_size (
+   std::string const &  value)
+{
+   return sizeof (uint32_t) + value.size ();
+}
+
+/*! static */ inline std::size_t
+encoder::endpoint_size (
+   boost::asio::ip::tcp::endpoint const &       value)
+{
+   return
+      sizeof (uint8_t)
+      + (value.address ().is_v6 () == true ? 16 : 4)
+      + sizeof (uint16_t);
+}
+
+
+inline decoder::decoder (
+   char const *         data,
+   std::size_t          size)
+   : position_ (reinterpret_cast <unsigned char const *> (data)),
+     end_      (reinterpret_cast <unsigned char const *> (data) + size)
+{
+}
+
+inline void
+decoder::require (
+   std::size_t          size) const
+{
+   PAXOS_CHECK_THROW (remaining () < size, exception::protocol_error ());
+}
+
+inline std::size_t
+decoder::remaining () const
+{
+   return end_ - position_;
+}
+
+template <typename T> inline T
+decoder::get_integer ()
+{
+   require (sizeof (T));
+
+   uint64_t value = 0;
+
+   for (std::size_t i = 0; i < sizeof (T); ++i)
+   {
+      value = (value << 8) | *position_++;
+   }
+
+   return static_cast <T> (value);
+}
+
+inline uint8_t
+decoder::get_uint8 ()
+{
+   require (sizeof (uint8_t));
+
+   return *position_++;
+}
+
+inline uint16_t
+decoder::get_uint16 ()
+{
+   return get_integer <uint16_t> ();
+}
+
+inline uint32_t
+decoder::get_uint32 ()
+{
+   return get_integer <uint32_t> ();
+}
+
+inline uint64_t
+decoder::get_uint64 ()
+{
+   return get_integer <uint64_t> ();
+}
+
+inline int64_t
+decoder::get_int64 ()
+{
+   return static_cast <int64_t> (get_integer <uint64_t> ());
+}
+
+inline void
+decoder::get_bytes (
+   std::string &        output)
+{
+   uint32_t size = get_uint32 ();
+   require (size);
+
+   output.assign (reinterpret_cast <char const *> (position_), size);
+   position_ += size;
+}
+
+inline boost::uuids::uuid
+decoder::get_uuid ()
+{
+   boost::uuids::uuid result;
+
+   require (result.size ());
+   memcpy (result.data, position_, result.size ());
+   position_ += result.size ();
+
+   return result;
+}
+
+inline boost::asio::ip::tcp::endpoint
+decoder::get_endpoint ()
+{
+   boost::asio::ip::address address;
+
+   switch (get_uint8 ())
+   {
+         case 4:
+         {
+            boost::asio::ip::address_v4::bytes_type bytes;
+            require (bytes.size ());
+            memcpy (bytes.data (), position_, bytes.size ());
+            position_ += bytes.size ();
+
+            address = boost::asio::ip::address_v4 (bytes);
+            break;
+         }
+
+         case 6:
+         {
+            boost::asio::ip::address_v6::bytes_type bytes;
+            require (bytes.size ());
+            memcpy (bytes.data (), position_, bytes.size ());
+            position_ += bytes.size ();
+
+            address = boost::asio::ip::address_v6 (bytes);
+            break;
+         }
+
+         default:
+            PAXOS_THROW (exception::protocol_error ());
+   };
+
+   return boost::asio::ip::tcp::endpoint (address, get_uint16 ());
+}
+
+}; }; };
@@ -0,0 +1,356 @@
+#include <algorithm>
+#include <iomanip>
+#include <istream>
+#include <iterator>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+
+#include "../../exception/exception.hpp"
+#include "../error.hpp"
+#include "codec.hpp"
+#include "debug.hpp"
+
+#include "trace.hpp"
+
+namespace paxos { namespace detail { namespace util {
+
+/*! static */ std::size_t const trace::capacity;
+/*! static */ __thread trace::buffer * trace::local_ = NULL;
+
+struct trace::registry
+{
+   registry ()
+      : owner (&trace::release_buffer)
+   {
+   }
+
+   /*!
+     \brief Synchronizes access to all members below
+    */
+   boost::mutex                 mutex;
+
+   std::vector <buffer *>       buffers;
+
+   /*!
+     \brief Buffers of threads that have exited
+    */
+   std::vector <buffer *>       released;
+
+   /*!
+     \brief Hands the buffer of a thread back when the thread exits
+    */
+   boost::thread_specific_ptr <buffer>  owner;
+};
+
+namespace {
+
+/*!
+  \brief First bytes of every trace, followed by the version of the format
+ */
+std::string const magic   = "PAXOSTRC";
+uint32_t const    version = 1;
+
+enum argument_type
+{
+   argument_none,
+   argument_integer,
+   argument_endpoint,
+   argument_error
+};
+
+struct tracepoint_description
+{
+   uint16_t             tracepoint;
+   char const *         name;
+
+   struct
+   {
+      char const *              name;
+      enum argument_type        type;
+   }                    arguments[3];
+};
+
+tracepoint_description const descriptions[] =
+{
+   { trace::proposal_start,     "proposal_start",       { { "proposal_id", argument_integer },
+                                                          { "requests",    argument_integer },
+                                                          { NULL,          argument_none } } },
+   { trace::prepare_sent,       "prepare_sent",         { { "proposal_id", argument_integer },
+                                                          { "follower",    argument_endpoint },
+                                                          { NULL,          argument_none } } },
+   { trace::prepare_received,   "prepare_received",     { { "proposal_id", argument_integer },
+                                                          { "leader",      argument_endpoint },
+                                                          { "error",       argument_error } } },
+   { trace::promise_received,   "promise_received",     { { "proposal_id", argument_integer },
+                                                          { "follower",    argument_endpoint },
+                                                          { "error",       argument_error } } },
+   { trace::accept_sent,        "accept_sent",          { { "proposal_id", argument_integer },
+                                                          { "follower",    argument_endpoint },
+                                                          { "proposals",   argument_integer } } },
+   { trace::accept_received,    "accept_received",      { { "proposal_id", argument_integer },
+                                                          { "leader",      argument_endpoint },
+                                                          { "error",       argument_error } } },
+   { trace::accepted_received,  "accepted_received",    { { "proposal_id", argument_integer },
+                                                          { "follower",    argument_endpoint },
+                                                          { "error",       argument_error } } },
+   { trace::proposal_committed, "proposal_committed",   { { "proposal_id", argument_integer },
+                                                          { "requests",    argument_integer },
+                                                          { "latency_us",  argument_integer } } },
+   { trace::proposal_failed,    "proposal_failed",      { { "proposal_id", argument_integer },
+                                                          { "requests",    argument_integer },
+                                                          { "error",       argument_error } } },
+   { trace::catch_up_sent,      "catch_up_sent",        { { "follower",    argument_endpoint },
+                                                          { "proposal_id", argument_integer },
+                                                          { "proposals",   argument_integer } } },
+   { trace::responses_flushed,  "responses_flushed",    { { "responses",   argument_integer },
+                                                          { "latency_us",  argument_integer },
+                                                          { NULL,          argument_none } } },
+   { trace::read_timed_out,     "read_timed_out",       { { "remote",      argument_endpoint },
+                                                          { NULL,          argument_none },
+                                                          { NULL,          argument_none } } }
+};
+
+void
+print_argument (
+   std::ostream &               output,
+   enum argument_type           type,
+   int64_t                      value)
+{
+   switch (type)
+   {
+         case argument_endpoint:
+            if ((value >> 48) == 0)
+            {
+               output << boost::asio::ip::address_v4 (static_cast <unsigned long> (value >> 16))
+                      << ':' << (value & 0xffff);
+            }
+            else
+            {
+               output << "[ipv6]:" << (value & 0xffff);
+            }
+            break;
+
+         case argument_error:
+            output << detail::to_string (static_cast <enum detail::error_code> (value));
+            break;
+
+         default:
+            output << value;
+   };
+}
+
+};
+
+
+/*! static */ struct trace::registry &
+trace::lookup_registry ()
+{
+   /*!
+     Never destroyed, since threads might still be recording while static objects are
+     destroyed at exit.
+    */
+   static struct registry * result = new struct registry ();
+   return *result;
+}
+
+/*! static */ trace::buffer &
+trace::acquire_buffer ()
+{
+   struct registry & registry = trace::lookup_registry ();
+
+   buffer * result = NULL;
+
+   {
+      boost::mutex::scoped_lock lock (registry.mutex);
+
+      if (registry.released.empty () == true)
+      {
+         result = new buffer ();
+         result->thread = static_cast <uint32_t> (registry.buffers.size ());
+         result->head.store (0, std::memory_order_relaxed);
+
+         registry.buffers.push_back (result);
+      }
+      else
+      {
+         result = registry.released.back ();
+         registry.released.pop_back ();
+      }
+   }
+
+   registry.owner.reset (result);
+   local_ = result;
+
+   return *result;
+}
+
+/*! static */ void
+trace::release_buffer (
+   buffer *     buffer)
+{
+   struct registry & registry = trace::lookup_registry ();
+
+   boost::mutex::scoped_lock lock (registry.mutex);
+   registry.released.push_back (buffer);
+}
+
+/*! static */ void
+trace::write (
+   std::ostream &       output)
+{
+   std::vector <buffer *> buffers;
+
+   {
+      struct registry & registry = trace::lookup_registry ();
+
+      boost::mutex::scoped_lock lock (registry.mutex);
+      buffers = registry.buffers;
+   }
+
+   std::string data (magic);
+   encoder encoder (data);
+
+   encoder.put_uint32 (version);
+   encoder.put_uint32 (static_cast <uint32_t> (buffers.size ()));
+
+   std::vector <struct event> events;
+
+   for (buffer const * buffer : buffers)
+   {
+      uint64_t const head  = buffer->head.load (std::memory_order_acquire);
+      uint64_t const first = (head > capacity ? head - capacity : 0);
+
+      events.assign (buffer->events, buffer->events + capacity);
+      std::atomic_thread_fence (std::memory_order_acquire);
+
+      /*!
+        While we were copying, the owner of the buffer might have overwritten our oldest
+        events; the event at position 'last' might be half-written too.
+       */
+      uint64_t const last  = buffer->head.load (std::memory_order_relaxed);
+      uint64_t const valid = std::max (first,
+                                       last >= capacity ? last - capacity + 1 : 0);
+      uint64_t const count = (valid < head ? head - valid : 0);
+
+      encoder.put_uint32 (buffer->thread);
+      encoder.put_uint64 (count);
+
+      for (uint64_t i = head - count; i < head; ++i)
+      {
+         struct event const & event = events[i & (capacity - 1)];
+
+         encoder.put_uint64 (event.timestamp);
+         encoder.put_uint16 (event.tracepoint);
+         encoder.put_int64 (event.arguments[0]);
+         encoder.put_int64 (event.arguments[1]);
+         encoder.put_int64 (event.arguments[2]);
+      }
+   }
+
+   output.write (data.data (), data.size ());
+}
+
+/*! static */ void
+trace::decode (
+   std::istream &       input,
+   std::ostream &       output)
+{
+   std::string const data ((std::istreambuf_iterator <char> (input)),
+                           std::istreambuf_iterator <char> ());
+
+   PAXOS_CHECK_THROW (data.compare (0, magic.size (), magic) != 0, exception::protocol_error ());
+
+   decoder decoder (data.data () + magic.size (),
+                    data.size () - magic.size ());
+
+   PAXOS_CHECK_THROW (decoder.get_uint32 () != version, exception::protocol_error ());
+
+   std::vector <std::pair <uint32_t, struct event> > events;
+
+   for (uint32_t buffers = decoder.get_uint32 (); buffers > 0; --buffers)
+   {
+      uint32_t const thread = decoder.get_uint32 ();
+
+      for (uint64_t count = decoder.get_uint64 (); count > 0; --count)
+      {
+         struct event event;
+
+         event.timestamp    = decoder.get_uint64 ();
+         event.tracepoint   = decoder.get_uint16 ();
+         event.arguments[0] = decoder.get_int64 ();
+         event.arguments[1] = decoder.get_int64 ();
+         event.arguments[2] = decoder.get_int64 ();
+
+         events.push_back (std::make_pair (thread, event));
+      }
+   }
+
+   std::stable_sort (events.begin (),
+                     events.end (),
+                     [] (std::pair <uint32_t, struct event> const & lhs,
+                         std::pair <uint32_t, struct event> const & rhs)
+                     {
+                        return lhs.second.timestamp < rhs.second.timestamp;
+                     });
+
+   /*!
+     Timestamps are printed in microseconds since the first event, since the clock itself
+     has no meaningful epoch.
+    */
+   uint64_t const start = (events.empty () == true ? 0 : events.front ().second.timestamp);
+
+   for (auto const & i : events)
+   {
+      struct event const & event = i.second;
+      uint64_t const elapsed = event.timestamp - start;
+
+      output << std::setw (10) << elapsed / 1000 << '.'
+             << std::setw (3) << std::setfill ('0') << elapsed % 1000 << std::setfill (' ')
+             << " thread " << std::setw (3) << std::left << i.first << std::right << ' ';
+
+      tracepoint_description const * description = NULL;
+
+      for (tracepoint_description const & j : descriptions)
+      {
+         if (j.tracepoint == event.tracepoint)
+         {
+            description = &j;
+         }
+      }
+
+      if (description == NULL)
+      {
+         /*!
+           Written by a newer version of the library, we can still show the raw values.
+          */
+         output << "tracepoint_" << event.tracepoint
+                << ' ' << event.arguments[0]
+                << ' ' << event.arguments[1]
+                << ' ' << event.arguments[2] << std::endl;
+         continue;
+      }
+
+      output << description->name;
+
+      for (std::size_t j = 0; j < 3; ++j)
+      {
+         if (description->arguments[j].name == NULL)
+         {
+            continue;
+         }
+
+         output << ' ' << description->arguments[j].name << '=';
+         print_argument (output,
+                         description->arguments[j].type,
+                         event.arguments[j]);
+      }
+
+      output << std::endl;
+   }
+}
+
+}; }; };
@@ -0,0 +1,215 @@
+/*!
+  Copyright (c) 2012, Leon Mergen, all rights reserved.
+ */
+
+#ifndef LIBPAXOS_CPP_DETAIL_UTIL_TRACE_HPP
+#define LIBPAXOS_CPP_DETAIL_UTIL_TRACE_HPP
+
+#include <stdint.h>
+
+#include <atomic>
+#include <iosfwd>
+
+#include <boost/asio/ip/tcp.hpp>
+
+/*!
+  \brief Records a binary trace event at one of the static trace::tracepoint identifiers
+
+  Compiles to nothing unless the library is configured with --enable-trace, in which case
+  the arguments are not even evaluated. Example:
+
+  PAXOS_TRACE_EVENT (prepare_sent, proposal_id, paxos::detail::util::trace::endpoint (follower));
+ */
+#ifdef PAXOS_TRACE
+#define PAXOS_TRACE_EVENT(tracepoint, ...) paxos::detail::util::trace::record (paxos::detail::util::trace::tracepoint, ##__VA_ARGS__)
+#else
+#define PAXOS_TRACE_EVENT(tracepoint, ...)
+#endif
+
+namespace paxos { namespace detail { namespace util {
+
+/*!
+  \brief Structured, binary trace of the consensus protocol
+
+  Unlike the debug macros, recording an event never formats anything: every thread appends
+  fixed-size events, consisting of a timestamp, a tracepoint identifier and three integer
+  arguments, to a ring buffer of its own. This makes it cheap enough to leave tracing
+  enabled under load; only the most recent events of each thread are kept.
+
+  The buffers are written with write () and turned into readable text by decode (), which
+  the paxos_trace tool does offline.
+ */
+class trace
+{
+public:
+
+   /*!
+     \brief Identifiers of all tracepoints
+
+     These identifiers are stored inside trace files, so existing values must never change.
+    */
+   enum tracepoint
+   {
+      /*!
+        Arguments: proposal id, amount of requests
+       */
+      proposal_start            = 1,
+
+      /*!
+        Arguments: proposal id, follower
+       */
+      prepare_sent              = 2,
+
+      /*!
+        Arguments: proposal id, leader, error code of our response
+       */
+      prepare_received          = 3,
+
+      /*!
+        Arguments: proposal id, follower, error code
+       */
+      promise_received          = 4,
+
+      /*!
+        Arguments: proposal id, follower, amount of proposals sent
+       */
+      accept_sent               = 5,
+
+      /*!
+        Arguments: first proposal id, leader, error code of our response
+       */
+      accept_received           = 6,
+
+      /*!
+        Arguments: proposal id, follower, error code
+       */
+      accepted_received         = 7,
+
+      /*!
+        Arguments: proposal id, amount of requests, latency in microseconds
+       */
+      proposal_committed        = 8,
+
+      /*!
+        Arguments: proposal id, amount of requests, error code
+       */
+      proposal_failed           = 9,
+
+      /*!
+        Arguments: follower, highest proposal id of the follower, amount of proposals sent
+       */
+      catch_up_sent             = 10,
+
+      /*!
+        Arguments: amount of responses, latency of the storage flush in microseconds
+       */
+      responses_flushed         = 11,
+
+      /*!
+        Arguments: remote endpoint of the connection
+       */
+      read_timed_out            = 12
+   };
+
+   struct event
+   {
+      /*!
+        Nanoseconds, according to a monotonic clock
+       */
+      uint64_t          timestamp;
+      uint16_t          tracepoint;
+      int64_t           arguments[3];
+   };
+
+   /*!
+     \brief Appends an event to the ring buffer of the calling thread
+    */
+   static void
+   record (
+      enum tracepoint                           tracepoint,
+      int64_t                                   argument1 = 0,
+      int64_t                                   argument2 = 0,
+      int64_t                                   argument3 = 0);
+
+   /*!
+     \brief Packs \c endpoint into a single tracepoint argument
+    */
+   static int64_t
+   endpoint (
+      boost::asio::ip::tcp::endpoint const &    endpoint);
+
+   /*!
+     \brief Writes the events inside the ring buffers of all threads in binary form
+
+     Threads can keep on recording events in the meantime. Events that are overwritten
+     while they are being copied are left out.
+    */
+   static void
+   write (
+      std::ostream &                            output);
+
+   /*!
+     \brief Turns the output of write () into one line of text per event, ordered by time
+     \throws exception::protocol_error When \c input is not a valid trace
+    */
+   static void
+   decode (
+      std::istream &                            input,
+      std::ostream &                            output);
+
+private:
+
+   /*!
+     \brief Amount of events kept per thread, must be a power of two
+    */
+   static std::size_t const     capacity = 1 << 13;
+
+   struct buffer
+   {
+      /*!
+        \brief Identifies the buffer inside a trace
+       */
+      uint32_t                  thread;
+
+      /*!
+        \brief Amount of events ever recorded in this buffer
+
+        Only the owning thread writes to the buffer; it publishes each event by incrementing
+        this value.
+       */
+      std::atomic <uint64_t>    head;
+
+      struct event              events[capacity];
+   };
+
+   /*!
+     \brief Keeps track of the buffers of all threads
+    */
+   struct registry;
+
+   static struct registry &
+   lookup_registry ();
+
+   /*!
+     \brief Assigns a buffer to the calling thread
+
+     Buffers are never freed: when a thread exits, its buffer is handed to the next thread
+     that starts recording, so the events of threads that are gone can still be written.
+    */
+   static buffer &
+   acquire_buffer ();
+
+   static void
+   release_buffer (
+      buffer *                                  buffer);
+
+private:
+
+   static __thread buffer *     local_;
+};
+
+}; }; };
+
+#include "trace.inl"
+
+#endif  //! LIBPAXOS_CPP_DETAIL_UTIL_TRACE_HPP
@@ -0,0 +1,45 @@
+#include <chrono>
+
+namespace paxos { namespace detail { namespace util {
+
+/*! static */ inline void
+trace::record (
+   enum tracepoint      tracepoint,
+   int64_t              argument1,
+   int64_t              argument2,
+   int64_t              argument3)
+{
+   buffer & buffer = (local_ != NULL ? *local_ : trace::acquire_buffer ());
+
+   uint64_t const head = buffer.head.load (std::memory_order_relaxed);
+
+   struct event & event = buffer.events[head & (capacity - 1)];
+
+   event.timestamp    = std::chrono::duration_cast <std::chrono::nanoseconds> (
+      std::chrono::steady_clock::now ().time_since_epoch ()).count ();
+   event.tracepoint   = static_cast <uint16_t> (tracepoint);
+   event.arguments[0] = argument1;
+   event.arguments[1] = argument2;
+   event.arguments[2] = argument3;
+
+   buffer.head.store (head + 1, std::memory_order_release);
+}
+
+/*! static */ inline int64_t
+trace::endpoint (
+   boost::asio::ip::tcp::endpoint const &       endpoint)
+{
+   /*!
+     IPv4 addresses fit in the argument together with the port; of IPv6 endpoints only the
+     port is kept, marked by bit 48.
+    */
+   if (endpoint.address ().is_v4 () == true)
+   {
+      return (static_cast <int64_t> (endpoint.address ().to_v4 ().to_ulong ()) << 16)
+         | endpoint.port ();
+   }
+
+   return (static_cast <int64_t> (1) << 48) | endpoint.port ();
+}
+
+}; }; };
@@ -4,6 +4,10 @@
 
 namespace paxos { namespace durable {
 
+heap::heap ()
+   : reset_proposal_id_ (0)
+{
+}
 
 /*! virtual */ std::map <int64_t, std::string>
 heap::retrieve (
@@ -16,12 +20,35 @@ heap::retrieve (
    return result;
 }
 
+/*! virtual */ std::map <int64_t, std::string>
+heap::retrieve_range (
+   int64_t      proposal_id,
+   int64_t      max_entries,
+   uint64_t     max_bytes)
+{
+   std::map <int64_t, std::string> result;
+
+   uint64_t bytes = 0;
+
+   for (auto i = data_.upper_bound (proposal_id);
+        i != data_.end ()
+           && static_cast <int64_t> (result.size ()) < max_entries
+           && (result.empty () == true || bytes + i->second.size () <= max_bytes);
+        ++i)
+   {
+      result.insert (result.end (), *i);
+      bytes += i->second.size ();
+   }
+
+   return result;
+}
+
 /*! virtual */ int64_t
 heap::highest_proposal_id ()
 {
    if (data_.empty () == true)
    {
-      return 0;
+      return reset_proposal_id_;
    }
 
    PAXOS_DEBUG (this << " highest_proposal_id = " << data_.rbegin ()->first);
@@ -40,6 +67,20 @@ heap::lowest_proposal_id ()
    return data_.begin ()->first;
 }
 
+/*! virtual */ void
+heap::reset (
+   int64_t                   proposal_id)
+{
+   data_.clear ();
+   reset_proposal_id_ = proposal_id;
+}
+
+/*! virtual */ bool
+heap::supports_reset () const
+{
+   return true;
+}
+
 
 /*! virtual */ void
 heap::store (
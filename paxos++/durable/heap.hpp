@@ -16,8 +16,6 @@ namespace paxos { namespace durable {
   instance will always be available, or do not care about the durability of the operations
   executed on the quorum.
 
-  This is the default storage backend provided by the paxos::configuration class.
-
   \par Thread Safety
   \e Distinct \e objects: Safe \n
   \e Shared \e objects: Unsafe \n
@@ -27,18 +25,33 @@ class heap : public storage
 {
 public:
 
+   heap ();
+
 public:
 
    virtual std::map <int64_t, std::string>
    retrieve (
       int64_t                   proposal_id);
 
+   virtual std::map <int64_t, std::string>
+   retrieve_range (
+      int64_t                   proposal_id,
+      int64_t                   max_entries,
+      uint64_t                  max_bytes);
+
    virtual int64_t
    highest_proposal_id ();
 
    virtual int64_t
    lowest_proposal_id ();
 
+   virtual void
+   reset (
+      int64_t                   proposal_id);
+
+   virtual bool
+   supports_reset () const;
+
 protected:
 
 
@@ -55,6 +68,11 @@ protected:
 private:
 
    std::map <int64_t, std::string>      data_;
+
+   /*!
+     \brief Highest proposal id when data_ is empty, as set by reset ()
+    */
+   int64_t                              reset_proposal_id_;
 };
 
 } }
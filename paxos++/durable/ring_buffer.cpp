@@ -0,0 +1,438 @@
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <limits>
+
+#include "../exception/exception.hpp"
+#include "../detail/util/debug.hpp"
+
+#include "ring_buffer.hpp"
+
+namespace paxos { namespace durable {
+
+/*! static */ uint64_t const ring_buffer::magic;
+/*! static */ uint64_t const ring_buffer::initial_capacity;
+
+ring_buffer::ring_buffer ()
+   : fd_ (-1),
+     region_ (NULL),
+     region_size_ (0),
+     offsets_ (1024),
+     first_slot_ (0)
+{
+   this->resize (sizeof (struct header) + initial_capacity);
+
+   memset (&this->header (), 0, sizeof (struct header));
+   this->header ().magic = magic;
+}
+
+ring_buffer::ring_buffer (
+   std::string const &  filename)
+   : filename_ (filename),
+     fd_ (-1),
+     region_ (NULL),
+     region_size_ (0),
+     offsets_ (1024),
+     first_slot_ (0)
+{
+   fd_ = open (filename.c_str (), O_RDWR | O_CREAT, 0644);
+   PAXOS_CHECK_THROW (fd_ == -1, exception::storage_error ());
+
+   struct stat status;
+   PAXOS_CHECK_THROW (fstat (fd_, &status) != 0, exception::storage_error ());
+
+   if (status.st_size == 0)
+   {
+      this->resize (sizeof (struct header) + initial_capacity);
+
+      memset (&this->header (), 0, sizeof (struct header));
+      this->header ().magic = magic;
+   }
+   else
+   {
+      PAXOS_CHECK_THROW (static_cast <uint64_t> (status.st_size) < sizeof (struct header),
+                         exception::storage_error ());
+
+      this->resize (status.st_size);
+
+      PAXOS_CHECK_THROW (this->header ().magic != magic, exception::storage_error ());
+
+      this->recover ();
+   }
+}
+
+/*! virtual */ ring_buffer::~ring_buffer ()
+{
+   if (fd_ == -1)
+   {
+      free (region_);
+   }
+   else
+   {
+      PAXOS_ASSERT_EQ (munmap (region_, region_size_), 0);
+      PAXOS_ASSERT_EQ (close (fd_), 0);
+   }
+}
+
+
+/*! virtual */ std::map <int64_t, std::string>
+ring_buffer::retrieve (
+   int64_t      proposal_id)
+{
+   return this->retrieve_range (proposal_id,
+                                std::numeric_limits <int64_t>::max (),
+                                std::numeric_limits <uint64_t>::max ());
+}
+
+/*! virtual */ std::map <int64_t, std::string>
+ring_buffer::retrieve_range (
+   int64_t      proposal_id,
+   int64_t      max_entries,
+   uint64_t     max_bytes)
+{
+   std::map <int64_t, std::string> result;
+
+   if (this->count () == 0)
+   {
+      return result;
+   }
+
+   uint64_t bytes = 0;
+
+   for (int64_t i = std::max (proposal_id + 1, this->header ().lowest_proposal_id);
+        i <= this->header ().highest_proposal_id
+           && static_cast <int64_t> (result.size ()) < max_entries;
+        ++i)
+   {
+      char const * record = this->arena () + this->slot (i);
+
+      uint32_t size;
+      memcpy (&size, record, sizeof (size));
+
+      if (result.empty () == false
+          && bytes + size > max_bytes)
+      {
+         break;
+      }
+
+      result.insert (result.end (),
+                     std::make_pair (i, std::string (record + sizeof (size), size)));
+      bytes += size;
+   }
+
+   return result;
+}
+
+/*! virtual */ int64_t
+ring_buffer::highest_proposal_id ()
+{
+   return this->header ().highest_proposal_id;
+}
+
+/*! virtual */ int64_t
+ring_buffer::lowest_proposal_id ()
+{
+   return this->header ().lowest_proposal_id;
+}
+
+/*! virtual */ void
+ring_buffer::reset (
+   int64_t              proposal_id)
+{
+   struct header & header = this->header ();
+
+   header.lowest_proposal_id  = 0;
+   header.highest_proposal_id = proposal_id;
+   header.head                = 0;
+   header.tail                = 0;
+   first_slot_                = 0;
+}
+
+/*! virtual */ bool
+ring_buffer::supports_reset () const
+{
+   return true;
+}
+
+
+/*! virtual */ void
+ring_buffer::store (
+   int64_t              proposal_id,
+   std::string const &  byte_array)
+{
+   PAXOS_ASSERT_EQ (proposal_id, this->header ().highest_proposal_id + 1);
+
+   uint32_t size = static_cast <uint32_t> (byte_array.size ());
+
+   this->reserve (sizeof (size) + size);
+
+   if (this->count () == offsets_.size ())
+   {
+      std::vector <uint64_t> offsets (2 * offsets_.size ());
+
+      for (uint64_t i = 0; i < offsets_.size (); ++i)
+      {
+         offsets[i] = offsets_[(first_slot_ + i) % offsets_.size ()];
+      }
+
+      offsets_.swap (offsets);
+      first_slot_ = 0;
+   }
+
+   struct header & header = this->header ();
+
+   if (this->count () == 0)
+   {
+      header.lowest_proposal_id = proposal_id;
+   }
+
+   /*!
+     The value is written before the header is updated, so that a process that crashes
+     halfway never leaves an incomplete value behind.
+    */
+   char * record = this->arena () + header.tail;
+   memcpy (record, &size, sizeof (size));
+   memcpy (record + sizeof (size), byte_array.data (), size);
+
+   this->slot (proposal_id) = header.tail;
+
+   header.tail                += sizeof (size) + size;
+   header.highest_proposal_id  = proposal_id;
+}
+
+/*! virtual */ void
+ring_buffer::remove (
+   int64_t              proposal_id)
+{
+   struct header & header = this->header ();
+
+   /*!
+     Just like durable::heap, this removes everything up to and including proposal_id, and
+     ignores proposals we do not have.
+    */
+   if (this->count () == 0
+       || proposal_id < header.lowest_proposal_id
+       || proposal_id > header.highest_proposal_id)
+   {
+      PAXOS_WARN ("proposal_id " << proposal_id << " not found in history, ignoring remove!");
+      return;
+   }
+
+   uint64_t amount = proposal_id - header.lowest_proposal_id + 1;
+
+   if (amount == this->count ())
+   {
+      header.lowest_proposal_id = 0;
+      header.head               = 0;
+      header.tail               = 0;
+      first_slot_               = 0;
+      return;
+   }
+
+   first_slot_                = (first_slot_ + amount) % offsets_.size ();
+   header.lowest_proposal_id += amount;
+   header.head                = this->slot (header.lowest_proposal_id);
+}
+
+
+uint64_t
+ring_buffer::count () const
+{
+   struct header const & header = *reinterpret_cast <struct header const *> (region_);
+
+   if (header.lowest_proposal_id == 0)
+   {
+      return 0;
+   }
+
+   return header.highest_proposal_id - header.lowest_proposal_id + 1;
+}
+
+uint64_t &
+ring_buffer::slot (
+   int64_t              proposal_id)
+{
+   PAXOS_ASSERT (proposal_id >= this->header ().lowest_proposal_id);
+
+   return offsets_[(first_slot_ + (proposal_id - this->header ().lowest_proposal_id)) % offsets_.size ()];
+}
+
+void
+ring_buffer::reserve (
+   uint64_t             size)
+{
+   struct header & header = this->header ();
+
+   if (header.tail + size <= this->arena_capacity ())
+   {
+      return;
+   }
+
+   uint64_t live        = header.tail - header.head;
+   uint64_t head        = header.head;
+   uint64_t region_size = region_size_;
+
+   /*!
+     Only grow if moving the values to the front would leave the arena more than half full,
+     so that the cost of moving is amortized over the values appended in the meantime.
+    */
+   if (live + size > this->arena_capacity () / 2)
+   {
+      region_size = sizeof (struct header) + std::max (2 * this->arena_capacity (),
+                                                       2 * (live + size));
+   }
+
+   if (head == 0)
+   {
+      this->resize (region_size);
+      return;
+   }
+
+   if (fd_ == -1)
+   {
+      this->resize (region_size);
+
+      memmove (this->arena (),
+               this->arena () + head,
+               live);
+
+      this->header ().tail = live;
+      this->header ().head = 0;
+   }
+   else
+   {
+      /*!
+        Moving the values inside the file itself would corrupt them when the process
+        crashes halfway, so the file is replaced by a new one instead.
+       */
+      this->rewrite (region_size);
+   }
+
+   for (uint64_t i = 0; i < this->count (); ++i)
+   {
+      offsets_[(first_slot_ + i) % offsets_.size ()] -= head;
+   }
+}
+
+void
+ring_buffer::resize (
+   uint64_t             region_size)
+{
+   if (fd_ == -1)
+   {
+      char * region = static_cast <char *> (realloc (region_, region_size));
+      PAXOS_CHECK_THROW (region == NULL, exception::storage_error ());
+
+      region_ = region;
+   }
+   else
+   {
+      if (region_ != NULL)
+      {
+         PAXOS_ASSERT_EQ (munmap (region_, region_size_), 0);
+         region_ = NULL;
+      }
+
+      PAXOS_CHECK_THROW (ftruncate (fd_, region_size) != 0, exception::storage_error ());
+
+      void * region = mmap (NULL, region_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+      PAXOS_CHECK_THROW (region == MAP_FAILED, exception::storage_error ());
+
+      region_ = static_cast <char *> (region);
+   }
+
+   region_size_ = region_size;
+}
+
+void
+ring_buffer::rewrite (
+   uint64_t             region_size)
+{
+   std::string filename = filename_ + ".rewrite";
+
+   int fd = open (filename.c_str (), O_RDWR | O_CREAT | O_TRUNC, 0644);
+   PAXOS_CHECK_THROW (fd == -1, exception::storage_error ());
+
+   PAXOS_CHECK_THROW (ftruncate (fd, region_size) != 0, exception::storage_error ());
+
+   void * region = mmap (NULL, region_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+   PAXOS_CHECK_THROW (region == MAP_FAILED, exception::storage_error ());
+
+   struct header header = this->header ();
+   uint64_t live        = header.tail - header.head;
+
+   memcpy (static_cast <char *> (region) + sizeof (struct header),
+           this->arena () + header.head,
+           live);
+
+   header.head = 0;
+   header.tail = live;
+   memcpy (region, &header, sizeof (header));
+
+   /*!
+     The new file only replaces ours once it is complete, so a process that crashes before
+     this point leaves our file untouched.
+    */
+   PAXOS_CHECK_THROW (rename (filename.c_str (), filename_.c_str ()) != 0,
+                      exception::storage_error ());
+
+   PAXOS_ASSERT_EQ (munmap (region_, region_size_), 0);
+   PAXOS_ASSERT_EQ (close (fd_), 0);
+
+   fd_          = fd;
+   region_      = static_cast <char *> (region);
+   region_size_ = region_size;
+}
+
+void
+ring_buffer::recover ()
+{
+   struct header & header = this->header ();
+
+   PAXOS_CHECK_THROW (header.head > header.tail
+                      || header.tail > this->arena_capacity (),
+                      exception::storage_error ());
+
+   offsets_.resize (std::max <uint64_t> (offsets_.size (), 2 * this->count ()));
+
+   uint64_t offset = header.head;
+
+   for (uint64_t i = 0; i < this->count (); ++i)
+   {
+      uint32_t size;
+
+      PAXOS_CHECK_THROW (offset + sizeof (size) > header.tail, exception::storage_error ());
+      memcpy (&size, this->arena () + offset, sizeof (size));
+
+      offsets_[i] = offset;
+      offset     += sizeof (size) + size;
+   }
+
+   PAXOS_CHECK_THROW (offset != header.tail, exception::storage_error ());
+}
+
+struct ring_buffer::header &
+ring_buffer::header ()
+{
+   return *reinterpret_cast <struct header *> (region_);
+}
+
+char *
+ring_buffer::arena ()
+{
+   return region_ + sizeof (struct header);
+}
+
+uint64_t
+ring_buffer::arena_capacity () const
+{
+   return region_size_ - sizeof (struct header);
+}
+
+}; };
@@ -0,0 +1,206 @@
+/*!
+  Copyright (c) 2012, Leon Mergen, all rights reserved.
+ */
+
+#ifndef LIBPAXOS_CPP_DURABLE_RING_BUFFER_HPP
+#define LIBPAXOS_CPP_DURABLE_RING_BUFFER_HPP
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "storage.hpp"
+
+namespace paxos { namespace durable {
+
+/*!
+  \brief Provides paxos::server backend that stores history inside a contiguous arena
+
+   Since accepted proposals always have consecutive ids, and history is only ever removed
+   from the front, this backend appends every value to a single block of memory, and keeps
+   a ring of offsets into that block, one for every proposal id. Looking up a proposal is
+   a matter of indexing the ring, and removing history only moves the start of the ring and
+   of the arena forward. The arena grows, or moves its contents to the front, when it runs
+   out of space.
+
+   By default the arena lives in memory only, like durable::heap. When a filename is
+   provided, the arena is a memory-mapped file instead, and a paxos::server that is
+   restarted using the same file continues from the previous state. Values are never moved
+   inside the file: rather than moving them to the front, the file is replaced by a new
+   one, which is first written next to it with a ".rewrite" suffix. Note that the file is
+   left to the operating system to write to the disk, so this survives a crash of the
+   process but not of the machine.
+
+   \par Thread Safety
+   \e Distinct \e objects: Safe, as long as different files are used\n
+   \e Shared \e objects: Unsafe\n
+
+   \par Examples
+
+   Set up a paxos::server that keeps its history inside the file "paxos.ring".
+
+   \code{.cpp}
+
+   paxos::configuration configuration;
+   configuration.set_durable_storage (new paxos::durable::ring_buffer ("paxos.ring"));
+   paxos::server server ("127.0.0.1", 1337,
+                         [] (int64_t proposal_id, std::string const & input) -> std::string
+                         {
+                             return input;
+                         },
+                         configuration);
+
+   \endcode
+ */
+class ring_buffer : public storage
+{
+public:
+
+   /*!
+     \brief Constructs a ring buffer that lives in memory only
+    */
+   ring_buffer ();
+
+   /*!
+     \brief Constructs a ring buffer that is backed by a memory-mapped file
+     \param filename    Location of the file, created if it does not exist
+     \throws exception::storage_error Thrown when the file cannot be used
+    */
+   ring_buffer (
+      std::string const &       filename);
+
+   /*!
+     \brief Destructor
+    */
+   virtual ~ring_buffer ();
+
+public:
+
+   virtual std::map <int64_t, std::string>
+   retrieve (
+      int64_t                   proposal_id);
+
+   virtual std::map <int64_t, std::string>
+   retrieve_range (
+      int64_t                   proposal_id,
+      int64_t                   max_entries,
+      uint64_t                  max_bytes);
+
+   virtual int64_t
+   highest_proposal_id ();
+
+   virtual int64_t
+   lowest_proposal_id ();
+
+   virtual void
+   reset (
+      int64_t                   proposal_id);
+
+   virtual bool
+   supports_reset () const;
+
+protected:
+
+   virtual void
+   store (
+      int64_t                   proposal_id,
+      std::string const &       byte_array);
+
+   virtual void
+   remove (
+      int64_t                   proposal_id);
+
+private:
+
+   /*!
+     \brief State stored in front of the arena, so that a memory-mapped file is self-contained
+    */
+   struct header
+   {
+      uint64_t          magic;
+      int64_t           lowest_proposal_id;
+      int64_t           highest_proposal_id;
+
+      //! Offset inside the arena of the value of lowest_proposal_id
+      uint64_t          head;
+
+      //! Offset inside the arena where the next value is appended
+      uint64_t          tail;
+   };
+
+   static uint64_t const magic                  = 0x7061786f7372696eULL;
+   static uint64_t const initial_capacity       = 1024 * 1024;
+
+   /*!
+     \brief Amount of proposals currently stored
+    */
+   uint64_t
+   count () const;
+
+   /*!
+     \brief Location of the value of \c proposal_id inside the ring of offsets
+    */
+   uint64_t &
+   slot (
+      int64_t                   proposal_id);
+
+   /*!
+     \brief Makes sure at least \c size bytes can be appended to the arena
+    */
+   void
+   reserve (
+      uint64_t                  size);
+
+   /*!
+     \brief Resizes our memory region, which consists of the header and the arena
+    */
+   void
+   resize (
+      uint64_t                  region_size);
+
+   /*!
+     \brief Replaces our memory-mapped file by a new one of \c region_size bytes, which
+            holds our values at the front of its arena
+    */
+   void
+   rewrite (
+      uint64_t                  region_size);
+
+   /*!
+     \brief Rebuilds the ring of offsets from the arena of a previously used file
+    */
+   void
+   recover ();
+
+   struct header &
+   header ();
+
+   char *
+   arena ();
+
+   uint64_t
+   arena_capacity () const;
+
+private:
+
+   std::string                  filename_;
+
+   /*!
+     \brief File descriptor of the memory-mapped file, or -1 if we live in memory only
+    */
+   int                          fd_;
+
+   char *                       region_;
+   uint64_t                     region_size_;
+
+   /*!
+     \brief Ring of arena offsets, the offset of lowest_proposal_id is at first_slot_
+    */
+   std::vector <uint64_t>       offsets_;
+   std::size_t                  first_slot_;
+};
+
+}; };
+
+#endif  //! LIBPAXOS_CPP_DURABLE_RING_BUFFER_HPP
@@ -0,0 +1,502 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <limits>
+
+#include <boost/crc.hpp>
+
+#include "../exception/exception.hpp"
+#include "../detail/util/codec.hpp"
+#include "../detail/util/debug.hpp"
+
+#include "segmented_log.hpp"
+
+namespace paxos { namespace durable {
+
+/*! static */ uint64_t const segmented_log::header_size;
+/*! static */ int64_t const segmented_log::index_interval;
+
+segmented_log::segmented_log (
+   std::string const &  directory,
+   uint64_t             segment_size,
+   bool                 sync)
+   : directory_ (directory),
+     segment_size_ (segment_size),
+     sync_ (sync),
+     directory_fd_ (-1),
+     fd_ (-1),
+     unsynced_ (false),
+     highest_proposal_id_ (0)
+{
+   PAXOS_CHECK_THROW (mkdir (directory_.c_str (), 0755) != 0 && errno != EEXIST,
+                      exception::storage_error ());
+
+   directory_fd_ = open (directory_.c_str (), O_RDONLY | O_DIRECTORY);
+   PAXOS_CHECK_THROW (directory_fd_ == -1, exception::storage_error ());
+
+   this->recover ();
+}
+
+/*! virtual */ segmented_log::~segmented_log ()
+{
+   if (fd_ != -1)
+   {
+      PAXOS_ASSERT_EQ (close (fd_), 0);
+   }
+
+   PAXOS_ASSERT_EQ (close (directory_fd_), 0);
+}
+
+
+/*! virtual */ std::map <int64_t, std::string>
+segmented_log::retrieve (
+   int64_t      proposal_id)
+{
+   return this->retrieve_range (proposal_id,
+                                std::numeric_limits <int64_t>::max (),
+                                std::numeric_limits <uint64_t>::max ());
+}
+
+/*! virtual */ std::map <int64_t, std::string>
+segmented_log::retrieve_range (
+   int64_t      proposal_id,
+   int64_t      max_entries,
+   uint64_t     max_bytes)
+{
+   std::map <int64_t, std::string> result;
+   uint64_t                        bytes = 0;
+
+   if (segments_.empty () == true
+       || proposal_id >= highest_proposal_id_)
+   {
+      return result;
+   }
+
+   /*!
+     Look up the segment that contains the proposal following proposal_id, or the first
+     segment if we do not have that proposal anymore.
+    */
+   auto i = segments_.upper_bound (proposal_id + 1);
+   if (i != segments_.begin ())
+   {
+      --i;
+   }
+
+   for (; i != segments_.end ()
+           && static_cast <int64_t> (result.size ()) < max_entries; ++i)
+   {
+      struct segment const & segment = i->second;
+
+      if (segment.index.empty () == true)
+      {
+         continue;
+      }
+
+      auto entry = segment.index.upper_bound (proposal_id + 1);
+      if (entry != segment.index.begin ())
+      {
+         --entry;
+      }
+
+      int fd = open (segment.filename.c_str (), O_RDONLY);
+      PAXOS_CHECK_THROW (fd == -1, exception::storage_error ());
+
+      uint64_t offset = entry->second;
+
+      while (offset < segment.size)
+      {
+         int64_t     id;
+         std::string byte_array;
+
+         bool valid = read_record (fd,
+                                   offset,
+                                   segment.size,
+                                   id,
+                                   byte_array);
+
+         if (valid == false)
+         {
+            close (fd);
+            PAXOS_THROW (exception::storage_error ());
+         }
+
+         offset += header_size + byte_array.size ();
+
+         if (id <= proposal_id)
+         {
+            continue;
+         }
+
+         if (result.empty () == false
+             && bytes + byte_array.size () > max_bytes)
+         {
+            /*!
+              Makes sure we also stop looking at the following segments
+             */
+            max_entries = result.size ();
+            break;
+         }
+
+         bytes += byte_array.size ();
+         result[id].swap (byte_array);
+
+         if (static_cast <int64_t> (result.size ()) == max_entries)
+         {
+            break;
+         }
+      }
+
+      PAXOS_ASSERT_EQ (close (fd), 0);
+   }
+
+   return result;
+}
+
+/*! virtual */ int64_t
+segmented_log::highest_proposal_id ()
+{
+   return highest_proposal_id_;
+}
+
+/*! virtual */ int64_t
+segmented_log::lowest_proposal_id ()
+{
+   if (segments_.empty () == true
+       || segments_.begin ()->first > highest_proposal_id_)
+   {
+      return 0;
+   }
+
+   return segments_.begin ()->first;
+}
+
+/*! virtual */ void
+segmented_log::reset (
+   int64_t              proposal_id)
+{
+   if (fd_ != -1)
+   {
+      this->flush ();
+      PAXOS_ASSERT_EQ (close (fd_), 0);
+      fd_ = -1;
+   }
+
+   for (auto const & i : segments_)
+   {
+      PAXOS_CHECK_THROW (unlink (i.second.filename.c_str ()) != 0,
+                         exception::storage_error ());
+   }
+
+   segments_.clear ();
+
+   /*!
+     An empty segment that starts right after proposal_id makes sure we continue from
+     proposal_id after a restart. Opening it also makes the removals above durable.
+    */
+   this->open_segment (proposal_id + 1);
+
+   highest_proposal_id_ = proposal_id;
+}
+
+/*! virtual */ bool
+segmented_log::supports_reset () const
+{
+   return true;
+}
+
+
+/*! virtual */ void
+segmented_log::store (
+   int64_t              proposal_id,
+   std::string const &  byte_array)
+{
+   PAXOS_ASSERT_EQ (proposal_id, highest_proposal_id_ + 1);
+
+   std::string id;
+   detail::util::encoder (id).put_int64 (proposal_id);
+
+   boost::crc_32_type checksum;
+   checksum.process_bytes (id.data (), id.size ());
+   checksum.process_bytes (byte_array.data (), byte_array.size ());
+
+   std::string record;
+   record.reserve (header_size + byte_array.size ());
+
+   detail::util::encoder encoder (record);
+   encoder.put_uint32 (static_cast <uint32_t> (byte_array.size ()));
+   encoder.put_uint32 (checksum.checksum ());
+   record.append (id);
+   record.append (byte_array);
+
+   if (fd_ == -1
+       || (segments_.rbegin ()->second.size > 0
+           && segments_.rbegin ()->second.size + record.size () > segment_size_))
+   {
+      this->open_segment (proposal_id);
+   }
+
+   struct segment & tail = segments_.rbegin ()->second;
+
+   /*!
+     A short write continues where it stopped. If writing fails altogether, the partial
+     record is cut off again: otherwise all following records would end up behind it, at
+     offsets our index does not know about.
+    */
+   for (std::size_t written = 0; written < record.size ();)
+   {
+      ssize_t result = write (fd_,
+                              record.data () + written,
+                              record.size () - written);
+
+      if (result == -1
+          && errno == EINTR)
+      {
+         continue;
+      }
+
+      if (result <= 0)
+      {
+         if (ftruncate (fd_, tail.size) != 0)
+         {
+            PAXOS_WARN ("unable to discard partially written record at the end of " << tail.filename);
+         }
+
+         PAXOS_THROW (exception::storage_error ());
+      }
+
+      written += result;
+   }
+
+   unsynced_ = true;
+
+   if (this->group_commit () == false)
+   {
+      this->flush ();
+   }
+
+   if ((proposal_id - segments_.rbegin ()->first) % index_interval == 0)
+   {
+      tail.index[proposal_id] = tail.size;
+   }
+
+   tail.size            += record.size ();
+   highest_proposal_id_  = proposal_id;
+}
+
+/*! virtual */ void
+segmented_log::flush ()
+{
+   if (sync_ == true
+       && unsynced_ == true)
+   {
+      PAXOS_CHECK_THROW (fdatasync (fd_) != 0, exception::storage_error ());
+   }
+
+   unsynced_ = false;
+}
+
+/*! virtual */ void
+segmented_log::remove (
+   int64_t              proposal_id)
+{
+   /*!
+     A segment can only be removed if all its proposals are lower than proposal_id, which
+     we know once the next segment starts at proposal_id or lower. The most recent segment
+     is never removed.
+    */
+   bool removed = false;
+
+   while (segments_.size () > 1
+          && (++segments_.begin ())->first <= proposal_id)
+   {
+      PAXOS_DEBUG ("removing segment " << segments_.begin ()->second.filename);
+
+      PAXOS_CHECK_THROW (unlink (segments_.begin ()->second.filename.c_str ()) != 0,
+                         exception::storage_error ());
+
+      segments_.erase (segments_.begin ());
+      removed = true;
+   }
+
+   if (removed == true)
+   {
+      this->sync_directory ();
+   }
+}
+
+
+void
+segmented_log::recover ()
+{
+   DIR * directory = opendir (directory_.c_str ());
+   PAXOS_CHECK_THROW (directory == NULL, exception::storage_error ());
+
+   while (struct dirent * entry = readdir (directory))
+   {
+      std::string name (entry->d_name);
+
+      if (name.size () != 24
+          || name.compare (20, 4, ".log") != 0
+          || name.find_first_not_of ("0123456789") != 20)
+      {
+         continue;
+      }
+
+      int64_t first = strtoll (name.c_str (), NULL, 10);
+
+      struct stat status;
+      PAXOS_CHECK_THROW (stat (this->segment_filename (first).c_str (), &status) != 0,
+                         exception::storage_error ());
+
+      struct segment & segment = segments_[first];
+      segment.filename     = this->segment_filename (first);
+      segment.size         = status.st_size;
+      segment.index[first] = 0;
+   }
+
+   closedir (directory);
+
+   if (segments_.empty () == true)
+   {
+      return;
+   }
+
+   /*!
+     All segments but the most recent one were completely written before we started a new
+     one, so we only need to validate the most recent segment.
+    */
+   int64_t          first = segments_.rbegin ()->first;
+   struct segment & tail  = segments_.rbegin ()->second;
+
+   fd_ = open (tail.filename.c_str (), O_RDWR | O_APPEND);
+   PAXOS_CHECK_THROW (fd_ == -1, exception::storage_error ());
+
+   uint64_t offset   = 0;
+   int64_t  expected = first;
+
+   tail.index.clear ();
+
+   while (offset < tail.size)
+   {
+      int64_t     id;
+      std::string byte_array;
+
+      if (read_record (fd_,
+                       offset,
+                       tail.size,
+                       id,
+                       byte_array) == false
+          || id != expected)
+      {
+         PAXOS_WARN ("discarding " << tail.size - offset << " bytes of corrupted data at the end of " << tail.filename);
+
+         PAXOS_CHECK_THROW (ftruncate (fd_, offset) != 0, exception::storage_error ());
+         tail.size = offset;
+         break;
+      }
+
+      if ((id - first) % index_interval == 0)
+      {
+         tail.index[id] = offset;
+      }
+
+      offset += header_size + byte_array.size ();
+      ++expected;
+   }
+
+   highest_proposal_id_ = expected - 1;
+}
+
+void
+segmented_log::open_segment (
+   int64_t              proposal_id)
+{
+   if (fd_ != -1)
+   {
+      this->flush ();
+      PAXOS_ASSERT_EQ (close (fd_), 0);
+   }
+
+   struct segment & segment = segments_[proposal_id];
+   segment.filename         = this->segment_filename (proposal_id);
+   segment.size             = 0;
+
+   fd_ = open (segment.filename.c_str (), O_WRONLY | O_APPEND | O_CREAT | O_TRUNC, 0644);
+   PAXOS_CHECK_THROW (fd_ == -1, exception::storage_error ());
+
+   /*!
+     Proposals stored in this segment are only durable once the segment itself is.
+    */
+   this->sync_directory ();
+}
+
+void
+segmented_log::sync_directory ()
+{
+   if (sync_ == true)
+   {
+      PAXOS_CHECK_THROW (fsync (directory_fd_) != 0, exception::storage_error ());
+   }
+}
+
+std::string
+segmented_log::segment_filename (
+   int64_t              proposal_id) const
+{
+   char name[32];
+   snprintf (name, sizeof (name), "%020lld.log", static_cast <long long> (proposal_id));
+
+   return directory_ + "/" + name;
+}
+
+/*! static */ bool
+segmented_log::read_record (
+   int                  fd,
+   uint64_t             offset,
+   uint64_t             size,
+   int64_t &            proposal_id,
+   std::string &        byte_array)
+{
+   if (size - offset < header_size)
+   {
+      return false;
+   }
+
+   char header[header_size];
+
+   if (pread (fd, header, header_size, offset) != static_cast <ssize_t> (header_size))
+   {
+      return false;
+   }
+
+   detail::util::decoder decoder (header, header_size);
+   uint32_t value_size = decoder.get_uint32 ();
+   uint32_t checksum   = decoder.get_uint32 ();
+   proposal_id         = decoder.get_int64 ();
+
+   if (size - offset - header_size < value_size)
+   {
+      return false;
+   }
+
+   byte_array.resize (value_size);
+
+   if (value_size > 0
+       && pread (fd, &byte_array[0], value_size, offset + header_size) != static_cast <ssize_t> (value_size))
+   {
+      return false;
+   }
+
+   boost::crc_32_type expected;
+   expected.process_bytes (header + 8, 8);
+   expected.process_bytes (byte_array.data (), byte_array.size ());
+
+   return expected.checksum () == checksum;
+}
+
+}; };
@@ -0,0 +1,217 @@
+/*!
+  Copyright (c) 2012, Leon Mergen, all rights reserved.
+ */
+
+#ifndef LIBPAXOS_CPP_DURABLE_SEGMENTED_LOG_HPP
+#define LIBPAXOS_CPP_DURABLE_SEGMENTED_LOG_HPP
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+
+#include "storage.hpp"
+
+namespace paxos { namespace durable {
+
+/*!
+  \brief Provides durable paxos::server backend based on an append-only log of segment files
+
+   Accepted proposals always have consecutive ids, and history is only ever removed from
+   the front. This backend takes advantage of that by appending every proposal as a
+   length-prefixed, checksummed record to the most recent segment file inside a directory.
+   Once a segment has grown beyond a fixed size, a new segment is started.
+
+   Segment files are named after the first proposal id they contain. An in-memory index
+   keeps the offset of every few records, so retrieving history only scans a small part of
+   a segment. Removing history deletes whole segments, so a bit more history than requested
+   might be kept.
+
+   When a paxos::server is restarted using a previously used directory, only the most recent
+   segment is scanned: a record that was partially written or is corrupted, and everything
+   after it, is discarded.
+
+   \par Thread Safety
+   \e Distinct \e objects: Safe, as long as different directories are used\n
+   \e Shared \e objects: Unsafe\n
+
+   \par Examples
+
+   Set up a paxos::server that stores its history inside the directory "paxos.log".
+
+   \code{.cpp}
+
+   paxos::configuration configuration;
+   configuration.set_durable_storage (new paxos::durable::segmented_log ("paxos.log"));
+   paxos::server server ("127.0.0.1", 1337,
+                         [] (int64_t proposal_id, std::string const & input) -> std::string
+                         {
+                             return input;
+                         },
+                         configuration);
+
+   \endcode
+ */
+class segmented_log : public storage
+{
+public:
+
+   /*!
+     \brief Constructor
+     \param directory   Directory the segment files are stored in, created if it does not exist
+     \param segment_size Size in bytes after which a new segment is started
+     \param sync        Whether to synchronize with the disk after every accepted proposal, or
+                        every flush () when group commit is enabled
+     \throws exception::storage_error Thrown when the directory cannot be used
+    */
+   segmented_log (
+      std::string const &       directory,
+      uint64_t                  segment_size    = 64 * 1024 * 1024,
+      bool                      sync            = true);
+
+   /*!
+     \brief Destructor
+    */
+   virtual ~segmented_log ();
+
+public:
+
+   virtual std::map <int64_t, std::string>
+   retrieve (
+      int64_t                   proposal_id);
+
+   virtual std::map <int64_t, std::string>
+   retrieve_range (
+      int64_t                   proposal_id,
+      int64_t                   max_entries,
+      uint64_t                  max_bytes);
+
+   virtual int64_t
+   highest_proposal_id ();
+
+   virtual int64_t
+   lowest_proposal_id ();
+
+   virtual void
+   reset (
+      int64_t                   proposal_id);
+
+   virtual bool
+   supports_reset () const;
+
+   virtual void
+   flush ();
+
+protected:
+
+   virtual void
+   store (
+      int64_t                   proposal_id,
+      std::string const &       byte_array);
+
+   virtual void
+   remove (
+      int64_t                   proposal_id);
+
+private:
+
+   /*!
+     \brief A single segment file
+    */
+   struct segment
+   {
+      std::string                       filename;
+
+      /*!
+        \brief Size of all valid records inside the file
+       */
+      uint64_t                          size;
+
+      /*!
+        \brief Sparse index of proposal id -> offset of its record inside the file
+       */
+      std::map <int64_t, uint64_t>      index;
+   };
+
+   /*!
+     \brief Size of the header that precedes the value of every record
+
+     A header consists of the size of the value, a CRC-32 of the proposal id and value, and
+     the proposal id.
+    */
+   static uint64_t const header_size    = 16;
+
+   /*!
+     \brief Amount of records between two entries of a segment's index
+    */
+   static int64_t const index_interval  = 64;
+
+   /*!
+     \brief Loads the segments from our directory, and validates the most recent one
+    */
+   void
+   recover ();
+
+   /*!
+     \brief Starts a new segment, of which the first record will be \c proposal_id
+    */
+   void
+   open_segment (
+      int64_t                   proposal_id);
+
+   /*!
+     \brief Makes the creation and removal of segment files durable
+
+     Synchronizing a file only covers its contents, not its entry inside the directory.
+    */
+   void
+   sync_directory ();
+
+   std::string
+   segment_filename (
+      int64_t                   proposal_id) const;
+
+   /*!
+     \brief Reads the record at \c offset of file \c fd, which is \c size bytes large
+     \returns False if the record is incomplete or corrupted
+    */
+   static bool
+   read_record (
+      int                       fd,
+      uint64_t                  offset,
+      uint64_t                  size,
+      int64_t &                 proposal_id,
+      std::string &             byte_array);
+
+private:
+
+   std::string                          directory_;
+   uint64_t                             segment_size_;
+   bool                                 sync_;
+
+   /*!
+     \brief All segments, indexed by the first proposal id they contain
+    */
+   std::map <int64_t, segment>          segments_;
+
+   /*!
+     \brief File descriptor of our directory, used by sync_directory ()
+    */
+   int                                  directory_fd_;
+
+   /*!
+     \brief File descriptor of the most recent segment, which records are appended to
+    */
+   int                                  fd_;
+
+   /*!
+     \brief Whether records have been written since we last synchronized with the disk
+    */
+   bool                                 unsynced_;
+
+   int64_t                              highest_proposal_id_;
+};
+
+} }
+
+#endif  //! LIBPAXOS_CPP_DURABLE_SEGMENTED_LOG_HPP
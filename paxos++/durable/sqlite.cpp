@@ -1,5 +1,4 @@
-
-#include <boost/lexical_cast.hpp>
+#include <limits>
 
 #include "../exception/exception.hpp"
 #include "../detail/util/debug.hpp"
@@ -9,139 +8,188 @@
 namespace paxos { namespace durable {
 
 sqlite::sqlite (
-   std::string const &  filename)
+   std::string const &  filename,
+   enum journal_mode    journal,
+   enum synchronous     sync)
    : filename_ (filename),
-     db_ (NULL)
+     db_ (NULL),
+     retrieve_statement_ (NULL),
+     highest_proposal_id_statement_ (NULL),
+     lowest_proposal_id_statement_ (NULL),
+     store_statement_ (NULL),
+     remove_statement_ (NULL),
+     highest_proposal_id_ (0),
+     lowest_proposal_id_ (0),
+     in_transaction_ (false)
 {
    PAXOS_INFO (this << " sqlite constructor");
    PAXOS_ASSERT_EQ (sqlite3_open (filename.c_str (), &db_), SQLITE_OK);
    PAXOS_ASSERT (db_ != NULL);
 
+   PAXOS_ASSERT_EQ (
+      sqlite3_exec (db_,
+                    journal == journal_mode_wal 
+                    ? "PRAGMA journal_mode = WAL"
+                    : "PRAGMA journal_mode = DELETE",
+                    NULL,
+                    NULL,
+                    NULL), SQLITE_OK);
+
+   PAXOS_ASSERT_EQ (
+      sqlite3_exec (db_,
+                    sync == synchronous_off 
+                    ? "PRAGMA synchronous = OFF"
+                    : sync == synchronous_normal
+                    ? "PRAGMA synchronous = NORMAL"
+                    : "PRAGMA synchronous = FULL",
+                    NULL,
+                    NULL,
+                    NULL), SQLITE_OK);
+
    if (this->has_table () == false)
    {
       this->create_table ();
    }
-}
-
-/*! virtual */ sqlite::~sqlite ()
-{
-   PAXOS_INFO ("shutting down sqlite backend");
-   PAXOS_ASSERT_EQ (sqlite3_close (db_), SQLITE_OK);
-}
-
-/*! virtual */ std::map <int64_t, std::string>
-sqlite::retrieve (
-   int64_t      proposal_id)
-{
-   std::map <int64_t, std::string> result;
 
-   std::string query = 
+   retrieve_statement_ = this->prepare (
       "SELECT "
       "  id, "
       "  byte_array "
       "FROM "
       "  history "
       "WHERE "
-      "  id > " + boost::lexical_cast <std::string> (proposal_id);
+      "  id > ? "
+      "ORDER BY "
+      "  id "
+      "LIMIT ?");
 
+   highest_proposal_id_statement_ = this->prepare (
+      "SELECT "
+      "  MAX (id) "
+      "FROM "
+      "  history");
 
-   PAXOS_DEBUG ("executing query: " << query);
+   lowest_proposal_id_statement_ = this->prepare (
+      "SELECT "
+      "  MIN (id) "
+      "FROM "
+      "  history");
 
-   sqlite3_stmt * prepared_statement = 0;
-   PAXOS_ASSERT_EQ (sqlite3_prepare (db_,
-                                     query.c_str (),
-                                     query.length (),
-                                     &prepared_statement,
-                                     NULL), SQLITE_OK);
+   store_statement_ = this->prepare (
+      "INSERT INTO "
+      "  history ("
+      "    id, "
+      "    byte_array) "
+      "VALUES (" 
+      "  ?, "
+      "  ?)");
 
-   while (sqlite3_step (prepared_statement) == SQLITE_ROW)
-   {
-      PAXOS_ASSERT_EQ (sqlite3_column_count (prepared_statement), 2);
+   remove_statement_ = this->prepare (
+      "DELETE FROM "
+      "  history "
+      "WHERE"
+      " id < ?");
 
-      int64_t id               = sqlite3_column_int64 (prepared_statement, 0);
+   this->load_proposal_ids ();
+}
 
-      uint32_t byte_array_size = sqlite3_column_bytes (prepared_statement, 1);
-      void const * byte_array  = sqlite3_column_blob  (prepared_statement, 1);
+/*! virtual */ sqlite::~sqlite ()
+{
+   PAXOS_INFO ("shutting down sqlite backend");
 
-      result[id].append (static_cast <char const *> (byte_array), byte_array_size);
-   }
-   
+   this->flush ();
 
-   PAXOS_ASSERT_EQ (sqlite3_finalize (prepared_statement), SQLITE_OK);
+   PAXOS_ASSERT_EQ (sqlite3_finalize (retrieve_statement_), SQLITE_OK);
+   PAXOS_ASSERT_EQ (sqlite3_finalize (highest_proposal_id_statement_), SQLITE_OK);
+   PAXOS_ASSERT_EQ (sqlite3_finalize (lowest_proposal_id_statement_), SQLITE_OK);
+   PAXOS_ASSERT_EQ (sqlite3_finalize (store_statement_), SQLITE_OK);
+   PAXOS_ASSERT_EQ (sqlite3_finalize (remove_statement_), SQLITE_OK);
 
+   PAXOS_ASSERT_EQ (sqlite3_close (db_), SQLITE_OK);
+}
 
-   return result;
+/*! virtual */ std::map <int64_t, std::string>
+sqlite::retrieve (
+   int64_t      proposal_id)
+{
+   /*!
+     A negative limit means no limit at all to sqlite
+    */
+   return this->retrieve_range (proposal_id,
+                                -1,
+                                std::numeric_limits <uint64_t>::max ());
 }
 
-/*! virtual */ int64_t
-sqlite::highest_proposal_id ()
+/*! virtual */ std::map <int64_t, std::string>
+sqlite::retrieve_range (
+   int64_t      proposal_id,
+   int64_t      max_entries,
+   uint64_t     max_bytes)
 {
-   std::string query = 
-      "SELECT "
-      "  MAX (id) "
-      "FROM "
-      "  history";
+   std::map <int64_t, std::string> result;
+   uint64_t                        bytes = 0;
 
-   PAXOS_DEBUG ("executing query: " << query);
+   PAXOS_ASSERT_EQ (sqlite3_bind_int64 (retrieve_statement_, 1, proposal_id), SQLITE_OK);
+   PAXOS_ASSERT_EQ (sqlite3_bind_int64 (retrieve_statement_, 2, max_entries), SQLITE_OK);
 
-   sqlite3_stmt * prepared_statement = 0;
-   PAXOS_ASSERT_EQ (sqlite3_prepare (db_,
-                                     query.c_str (),
-                                     query.length (),
-                                     &prepared_statement,
-                                     NULL), SQLITE_OK);
+   while (sqlite3_step (retrieve_statement_) == SQLITE_ROW)
+   {
+      PAXOS_ASSERT_EQ (sqlite3_column_count (retrieve_statement_), 2);
 
-   int64_t result = 0;
+      int64_t id               = sqlite3_column_int64 (retrieve_statement_, 0);
 
-   while (sqlite3_step (prepared_statement) == SQLITE_ROW)
-   {
-      PAXOS_ASSERT_EQ (result, 0);
-      PAXOS_ASSERT_EQ (sqlite3_column_count (prepared_statement), 1);
+      uint32_t byte_array_size = sqlite3_column_bytes (retrieve_statement_, 1);
+      void const * byte_array  = sqlite3_column_blob  (retrieve_statement_, 1);
 
-      result = sqlite3_column_int64 (prepared_statement, 0);
+      if (result.empty () == false
+          && bytes + byte_array_size > max_bytes)
+      {
+         break;
+      }
 
-      PAXOS_ASSERT_GE (result, 0);
+      bytes += byte_array_size;
+      result[id].append (static_cast <char const *> (byte_array), byte_array_size);
    }
 
-   PAXOS_ASSERT_EQ (sqlite3_finalize (prepared_statement), SQLITE_OK);
+   PAXOS_ASSERT_EQ (sqlite3_reset (retrieve_statement_), SQLITE_OK);
 
    return result;
 }
 
-
 /*! virtual */ int64_t
-sqlite::lowest_proposal_id ()
+sqlite::highest_proposal_id ()
 {
-   std::string query = 
-      "SELECT "
-      "  MIN (id) "
-      "FROM "
-      "  history";
-
-   PAXOS_DEBUG ("executing query: " << query);
+   return highest_proposal_id_;
+}
 
-   sqlite3_stmt * prepared_statement = 0;
-   PAXOS_ASSERT_EQ (sqlite3_prepare (db_,
-                                     query.c_str (),
-                                     query.length (),
-                                     &prepared_statement,
-                                     NULL), SQLITE_OK);
 
-   int64_t result = 0;
-
-   while (sqlite3_step (prepared_statement) == SQLITE_ROW)
-   {
-      PAXOS_ASSERT_EQ (result, 0);
-      PAXOS_ASSERT_EQ (sqlite3_column_count (prepared_statement), 1);
+/*! virtual */ int64_t
+sqlite::lowest_proposal_id ()
+{
+   return lowest_proposal_id_;
+}
 
-      result = sqlite3_column_int64 (prepared_statement, 0);
+/*! virtual */ void
+sqlite::reset (
+   int64_t              proposal_id)
+{
+   this->flush ();
 
-      PAXOS_ASSERT_GE (result, 0);
-   }
+   PAXOS_ASSERT_EQ (sqlite3_exec (db_, "DELETE FROM history", NULL, NULL, NULL), SQLITE_OK);
 
-   PAXOS_ASSERT_EQ (sqlite3_finalize (prepared_statement), SQLITE_OK);
+   /*!
+     Note that our highest proposal id is derived from the history after a restart, which
+     makes us start from scratch again. Since that is lower than the lowest proposal id in
+     the history of the rest of the quorum, we are simply sent another snapshot.
+    */
+   highest_proposal_id_ = proposal_id;
+   lowest_proposal_id_  = 0;
+}
 
-   return result;
+/*! virtual */ bool
+sqlite::supports_reset () const
+{
+   return true;
 }
 
 /*! virtual */ void
@@ -156,48 +204,62 @@ sqlite::store (
      keep it here for now. It ensures important things are sane, and we do not have any
      "gaps" in our history.
     */
-   PAXOS_ASSERT_EQ (highest_proposal_id (), (proposal_id - 1));
+   PAXOS_ASSERT_EQ (highest_proposal_id_, (proposal_id - 1));
 
-   std::string query =
-      "INSERT INTO "
-      "  history ("
-      "    id, "
-      "    byte_array) "
-      "VALUES (" 
-      "  " + boost::lexical_cast <std::string> (proposal_id) + ", "
-      "  ?)";
+   /*!
+     With group commit, all values stored until the next flush () share a single
+     transaction, and thus a single synchronization with the disk.
+    */
+   if (this->group_commit () == true
+       && in_transaction_ == false)
+   {
+      PAXOS_ASSERT_EQ (sqlite3_exec (db_, "BEGIN", NULL, NULL, NULL), SQLITE_OK);
+      in_transaction_ = true;
+   }
 
-   PAXOS_DEBUG ("executing query: " << query);
+   /*!
+     The byte array outlives the statement's execution, so sqlite does not need to copy it
+    */
+   PAXOS_ASSERT_EQ (sqlite3_bind_int64 (store_statement_, 1, proposal_id), SQLITE_OK);
+   PAXOS_ASSERT_EQ (sqlite3_bind_blob (store_statement_, 2, 
+                                       byte_array.data (), byte_array.length (), 
+                                       SQLITE_STATIC), SQLITE_OK);
 
-   sqlite3_stmt * prepared_statement = 0;
-   PAXOS_ASSERT_EQ (sqlite3_prepare (db_,
-                                     query.c_str (),
-                                     query.length (),
-                                     &prepared_statement,
-                                     NULL), SQLITE_OK);
+   PAXOS_ASSERT_EQ (sqlite3_step (store_statement_), SQLITE_DONE);
+   PAXOS_ASSERT_EQ (sqlite3_reset (store_statement_), SQLITE_OK);
+   PAXOS_ASSERT_EQ (sqlite3_clear_bindings (store_statement_), SQLITE_OK);
 
-   PAXOS_ASSERT_EQ (sqlite3_bind_blob (prepared_statement, 1, 
-                                       byte_array.c_str (), byte_array.length (), 
-                                       SQLITE_TRANSIENT), SQLITE_OK);
+   highest_proposal_id_ = proposal_id;
 
-   PAXOS_ASSERT_EQ (sqlite3_step (prepared_statement), SQLITE_DONE);
-   PAXOS_ASSERT_EQ (sqlite3_finalize (prepared_statement), SQLITE_OK);
+   if (lowest_proposal_id_ == 0)
+   {
+      lowest_proposal_id_ = proposal_id;
+   }
+}
+
+/*! virtual */ void
+sqlite::flush ()
+{
+   if (in_transaction_ == true)
+   {
+      PAXOS_ASSERT_EQ (sqlite3_exec (db_, "COMMIT", NULL, NULL, NULL), SQLITE_OK);
+      in_transaction_ = false;
+   }
 }
 
 void
 sqlite::remove (
    int64_t      proposal_id)
 {
-   PAXOS_ASSERT_EQ (
-      sqlite3_exec (db_,
-                    std::string (
-                       "DELETE FROM "
-                       "  history "
-                       "WHERE"
-                       " id < " + boost::lexical_cast <std::string> (proposal_id)).c_str (),
-                    NULL,
-                    NULL,
-                    NULL), SQLITE_OK);
+   PAXOS_ASSERT_EQ (sqlite3_bind_int64 (remove_statement_, 1, proposal_id), SQLITE_OK);
+
+   PAXOS_ASSERT_EQ (sqlite3_step (remove_statement_), SQLITE_DONE);
+   PAXOS_ASSERT_EQ (sqlite3_reset (remove_statement_), SQLITE_OK);
+
+   /*!
+     This only happens once every history_size () proposals, so just ask the database
+    */
+   this->load_proposal_ids ();
 }
 
 
@@ -249,4 +311,48 @@ sqlite::has_table ()
    return result == 1;
 }
 
+sqlite3_stmt *
+sqlite::prepare (
+   std::string const &  query)
+{
+   PAXOS_DEBUG ("preparing query: " << query);
+
+   sqlite3_stmt * prepared_statement = 0;
+   PAXOS_ASSERT_EQ (sqlite3_prepare_v2 (db_,
+                                        query.c_str (),
+                                        query.length (),
+                                        &prepared_statement,
+                                        NULL), SQLITE_OK);
+
+   return prepared_statement;
+}
+
+int64_t
+sqlite::select_proposal_id (
+   sqlite3_stmt *       statement)
+{
+   int64_t result = 0;
+
+   while (sqlite3_step (statement) == SQLITE_ROW)
+   {
+      PAXOS_ASSERT_EQ (result, 0);
+      PAXOS_ASSERT_EQ (sqlite3_column_count (statement), 1);
+
+      result = sqlite3_column_int64 (statement, 0);
+
+      PAXOS_ASSERT_GE (result, 0);
+   }
+
+   PAXOS_ASSERT_EQ (sqlite3_reset (statement), SQLITE_OK);
+
+   return result;
+}
+
+void
+sqlite::load_proposal_ids ()
+{
+   highest_proposal_id_ = this->select_proposal_id (highest_proposal_id_statement_);
+   lowest_proposal_id_  = this->select_proposal_id (lowest_proposal_id_statement_);
+}
+
 }; };
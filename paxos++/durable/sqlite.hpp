@@ -40,17 +40,64 @@ namespace paxos { namespace durable {
                          configuration);
 
    \endcode
+
+   By default, sqlite uses a rollback journal and synchronizes with the disk after every
+   accepted proposal. If you can tolerate losing the most recently accepted proposals when
+   the machine (rather than the process) crashes, write-ahead logging with normal
+   synchronization allows proposals to be accepted at disk bandwidth:
+
+   \code{.cpp}
+
+   configuration.set_durable_storage (
+      new paxos::durable::sqlite ("db.sqlite",
+                                  paxos::durable::sqlite::journal_mode_wal,
+                                  paxos::durable::sqlite::synchronous_normal));
+
+   \endcode
  */
 class sqlite : public storage
 {
+public:
+
+   /*!
+     \brief Journal mode of the database, see sqlite's "PRAGMA journal_mode"
+    */
+   enum journal_mode
+   {
+      //! Rollback journal that is deleted at the end of each transaction, sqlite's default
+      journal_mode_delete,
+
+      //! Write-ahead log
+      journal_mode_wal
+   };
+
+   /*!
+     \brief How often sqlite synchronizes with the disk, see sqlite's "PRAGMA synchronous"
+    */
+   enum synchronous
+   {
+      //! Never synchronize, leave it up to the operating system
+      synchronous_off,
+
+      //! Synchronize at the most critical moments only
+      synchronous_normal,
+
+      //! Synchronize after every transaction, sqlite's default
+      synchronous_full
+   };
+
 public:
 
    /*!
      \brief Constructor
      \param filename    Location where sqlite database is stored
+     \param journal     Journal mode of the database
+     \param sync        How often to synchronize with the disk
     */
    sqlite (
-      std::string const &       filename);
+      std::string const &       filename,
+      enum journal_mode         journal     = journal_mode_delete,
+      enum synchronous          sync        = synchronous_full);
 
    /*!
      \brief Destructor
@@ -63,12 +110,31 @@ public:
    retrieve (
       int64_t                                                   proposal_id);
 
+   virtual std::map <int64_t, std::string>
+   retrieve_range (
+      int64_t                                                   proposal_id,
+      int64_t                                                   max_entries,
+      uint64_t                                                  max_bytes);
+
    virtual int64_t
    highest_proposal_id ();
 
    virtual int64_t
    lowest_proposal_id ();
 
+   virtual void
+   reset (
+      int64_t                                                   proposal_id);
+
+   virtual bool
+   supports_reset () const;
+
+   /*!
+     \brief Commits the transaction that all values stored since the previous flush are part of
+    */
+   virtual void
+   flush ();
+
 protected:
 
    virtual void
@@ -89,10 +155,51 @@ private:
    void
    create_table ();
 
+   /*!
+     \brief Compiles a query into a statement that is kept for our whole lifetime
+    */
+   sqlite3_stmt *
+   prepare (
+      std::string const &       query);
+
+   /*!
+     \brief Executes a statement that selects a single proposal id
+    */
+   int64_t
+   select_proposal_id (
+      sqlite3_stmt *            statement);
+
+   /*!
+     \brief Reads the highest and lowest proposal ids stored in the database
+    */
+   void
+   load_proposal_ids ();
+
 private:
 
-   std::string  filename_;
-   sqlite3 *    db_;
+   std::string          filename_;
+   sqlite3 *            db_;
+
+   sqlite3_stmt *       retrieve_statement_;
+   sqlite3_stmt *       highest_proposal_id_statement_;
+   sqlite3_stmt *       lowest_proposal_id_statement_;
+   sqlite3_stmt *       store_statement_;
+   sqlite3_stmt *       remove_statement_;
+
+   /*!
+     \brief Cached MAX (id) of the history, so we do not have to query it on every store ()
+    */
+   int64_t              highest_proposal_id_;
+
+   /*!
+     \brief Cached MIN (id) of the history
+    */
+   int64_t              lowest_proposal_id_;
+
+   /*!
+     \brief Whether a transaction is in progress, which only happens with group commit
+    */
+   bool                 in_transaction_;
 };
 
 } }
@@ -1,3 +1,4 @@
+#include "../exception/exception.hpp"
 #include "../detail/util/debug.hpp"
 #include "../detail/quorum/view.hpp"
 #include "storage.hpp"
@@ -5,7 +6,10 @@
 namespace paxos { namespace durable {
 
 storage::storage ()
-   : history_size_ (10000)
+   : history_size_ (10000),
+     group_commit_ (false),
+     catch_up_size_ (1000),
+     catch_up_bytes_ (4 * 1024 * 1024)
 {
 }
 
@@ -26,6 +30,93 @@ storage::history_size () const
    return history_size_;
 }
 
+void
+storage::set_group_commit (
+   bool         enabled)
+{
+   group_commit_ = enabled;
+}
+
+bool
+storage::group_commit () const
+{
+   return group_commit_;
+}
+
+void
+storage::set_catch_up_size (
+   int64_t      amount)
+{
+   PAXOS_ASSERT (amount > 0);
+   catch_up_size_ = amount;
+}
+
+int64_t
+storage::catch_up_size () const
+{
+   return catch_up_size_;
+}
+
+void
+storage::set_catch_up_bytes (
+   uint64_t     bytes)
+{
+   catch_up_bytes_ = bytes;
+}
+
+uint64_t
+storage::catch_up_bytes () const
+{
+   return catch_up_bytes_;
+}
+
+/*! virtual */ void
+storage::flush ()
+{
+}
+
+/*! virtual */ std::map <int64_t, std::string>
+storage::retrieve_range (
+   int64_t      proposal_id,
+   int64_t      max_entries,
+   uint64_t     max_bytes)
+{
+   std::map <int64_t, std::string> result = this->retrieve (proposal_id);
+
+   int64_t      entries = 0;
+   uint64_t     bytes   = 0;
+
+   auto i = result.begin ();
+   for (; i != result.end (); ++i)
+   {
+      if (entries == max_entries
+          || (entries > 0 && bytes + i->second.size () > max_bytes))
+      {
+         break;
+      }
+
+      ++entries;
+      bytes += i->second.size ();
+   }
+
+   result.erase (i, result.end ());
+
+   return result;
+}
+
+/*! virtual */ void
+storage::reset (
+   int64_t      proposal_id)
+{
+   PAXOS_THROW (exception::storage_error ());
+}
+
+/*! virtual */ bool
+storage::supports_reset () const
+{
+   return false;
+}
+
 void
 storage::accept (
    int64_t                      proposal_id,
@@ -54,6 +54,80 @@ public:
     */
    int64_t
    history_size () const;
+
+   /*!
+     \brief Controls whether accepted values are made durable in groups
+     \param enabled Whether group commit is enabled
+
+     By default, every accepted value is made durable before the follower responds to the
+     leader, which usually means waiting for the disk once per value. When this is enabled,
+     the follower first accepts all values it has received, flushes them to the disk at
+     once using flush (), and only then processes them and sends all pending responses to
+     the leader.
+
+     Defaults to false.
+    */
+   void
+   set_group_commit (
+      bool      enabled);
+
+   /*!
+     \brief Access to whether accepted values are made durable in groups
+    */
+   bool
+   group_commit () const;
+
+   /*!
+     \brief Controls the maximum amount of history sent to a lagging follower at once
+     \param amount The maximum amount of values per catch-up
+     \pre amount > 0
+
+     A follower that lags behind receives the history it misses in batches of at most this
+     many values, so that a single follower that has been away for a long time does not make
+     the leader load its entire history at once.
+
+     A follower that lags behind less than this amount is caught up as part of the next
+     accept command. A follower that lags behind more is left out of new proposals, and is
+     caught up in the background instead, so the rest of the quorum does not have to wait
+     for it.
+
+     Defaults to 1000.
+    */
+   void
+   set_catch_up_size (
+      int64_t   amount);
+
+   /*!
+     \brief Access to the maximum amount of history sent to a lagging follower at once
+    */
+   int64_t
+   catch_up_size () const;
+
+   /*!
+     \brief Controls the maximum size (in bytes) of the history sent to a lagging follower at once
+
+     A single value that is larger than this limit is always sent on its own.
+
+     Defaults to 4194304 (4 MiB)
+    */
+   void
+   set_catch_up_bytes (
+      uint64_t  bytes);
+
+   /*!
+     \brief Access to the maximum size (in bytes) of the history sent to a lagging follower at once
+    */
+   uint64_t
+   catch_up_bytes () const;
+
+   /*!
+     \brief Makes all values stored since the previous flush durable
+
+     This is only called when group commit is enabled; storage components that always make
+     values durable as part of store () do not need to override this.
+    */
+   virtual void
+   flush ();
    
 
    /*!
@@ -82,6 +156,25 @@ public:
    retrieve (
       int64_t                   proposal_id) = 0;
 
+   /*!
+     \brief Looks up a bounded range of recently accepted values higher than \c proposal_id
+     \param proposal_id         Values with an id higher than this are returned
+     \param max_entries         Maximum amount of values to return
+     \param max_bytes           Maximum combined size (in bytes) of the values to return
+
+     Returns consecutive values, starting with the lowest value higher than \c proposal_id we
+     have. The first value is always returned, even if it is larger than \c max_bytes, so that
+     a caller that repeatedly asks for the next range always makes progress.
+
+     The default implementation calls retrieve () and discards what is outside of the range;
+     storage components should override this to avoid loading their entire history.
+    */
+   virtual std::map <int64_t, std::string>
+   retrieve_range (
+      int64_t                   proposal_id,
+      int64_t                   max_entries,
+      uint64_t                  max_bytes);
+
    /*!
      \brief Looks up the highest proposal id currently stored
      \returns Returns highest proposal id in history, or 0 if no previous proposals are stored
@@ -98,6 +191,39 @@ public:
    virtual int64_t
    lowest_proposal_id () = 0;
 
+   /*!
+     \brief Discards all history, after which history continues at \c proposal_id + 1
+     \param proposal_id The proposal id the application's state has been restored to
+
+     This is called when a follower has installed a snapshot of the application's state,
+     because the history it missed is no longer available anywhere.
+
+     This is only called when supports_reset () returns true. The default implementation
+     throws exception::storage_error; storage components that override this must override
+     supports_reset () as well.
+
+     \par Postconditions
+
+     highest_proposal_id () == proposal_id
+
+     lowest_proposal_id () == 0
+    */
+   virtual void
+   reset (
+      int64_t                   proposal_id);
+
+   /*!
+     \brief Returns true if this storage component implements reset ()
+
+     A follower whose storage component does not cannot install snapshots, and instead
+     rejects them; it can then only be caught up as long as the history it misses is still
+     available at the leader.
+
+     Defaults to false.
+    */
+   virtual bool
+   supports_reset () const;
+
 protected:
 
    /*!
@@ -130,6 +256,9 @@ protected:
 private:
 
    int64_t      history_size_;
+   bool         group_commit_;
+   int64_t      catch_up_size_;
+   uint64_t     catch_up_bytes_;
 
 };
 
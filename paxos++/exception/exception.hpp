@@ -82,6 +82,12 @@ class connection_close : virtual public exception {};
  */
 class storage_error : virtual public exception {};
 
+/*!
+  \brief Thrown when a malformed command, or a command encoded with an unsupported version
+         of the wire format, is received
+ */
+class protocol_error : virtual public exception {};
+
 } };
 
 #endif  //! LIBPAXOS_CPP_EXCEPTION_EXCEPTION_HPP
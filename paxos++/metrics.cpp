@@ -0,0 +1,54 @@
+#include <algorithm>
+#include <cmath>
+
+#include "metrics.hpp"
+
+namespace paxos {
+
+metrics::histogram::histogram ()
+   : count (0),
+     sum (0),
+     min (0),
+     max (0)
+{
+}
+
+uint64_t
+metrics::histogram::percentile (
+   double               fraction) const
+{
+   if (count == 0)
+   {
+      return 0;
+   }
+
+   uint64_t rank = static_cast <uint64_t> (std::ceil (fraction * count));
+   rank = std::min (std::max <uint64_t> (rank, 1), count);
+
+   uint64_t seen = 0;
+
+   for (auto const & i : buckets)
+   {
+      seen += i.second;
+
+      if (seen >= rank)
+      {
+         return std::min (i.first, max);
+      }
+   }
+
+   return max;
+}
+
+double
+metrics::histogram::mean () const
+{
+   if (count == 0)
+   {
+      return 0;
+   }
+
+   return static_cast <double> (sum) / count;
+}
+
+};
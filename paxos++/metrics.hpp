@@ -0,0 +1,81 @@
+/*!
+  Copyright (c) 2012, Leon Mergen, all rights reserved.
+ */
+
+#ifndef LIBPAXOS_CPP_METRICS_HPP
+#define LIBPAXOS_CPP_METRICS_HPP
+
+#include <stdint.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace paxos {
+
+/*!
+  \brief Copy of the measurements a paxos::server has taken, see paxos::server::metrics ()
+
+  All metrics are identified by name. Latencies are measured in microseconds, and sizes in
+  bytes. Metrics that are kept for each follower or connection contain its endpoint in their
+  name, for example "prepare.127.0.0.1:1338.latency_us".
+ */
+struct metrics
+{
+   /*!
+     \brief Distribution of recorded values
+
+     Values are counted in buckets, of which the width grows with the values they hold, so
+     that every value is counted with a precision of about 6%.
+    */
+   struct histogram
+   {
+      /*!
+        \brief Default constructor, an empty histogram
+       */
+      histogram ();
+
+      /*!
+        \brief Returns the value below which \c fraction of all recorded values fall
+        \param fraction    A number between 0 and 1, for example 0.99 for the 99th percentile
+
+        The result is rounded up to the upper bound of the bucket that holds the value, and
+        never exceeds max.
+       */
+      uint64_t
+      percentile (
+         double         fraction) const;
+
+      /*!
+        \brief Average of all recorded values
+       */
+      double
+      mean () const;
+
+      uint64_t                                          count;
+      uint64_t                                          sum;
+      uint64_t                                          min;
+      uint64_t                                          max;
+
+      /*!
+        \brief Upper bound and amount of values of all buckets that are not empty, in order
+       */
+      std::vector <std::pair <uint64_t, uint64_t> >     buckets;
+   };
+
+   /*!
+     \brief Values that only ever increase, such as the amount of bytes received
+    */
+   std::map <std::string, uint64_t>                     counters;
+
+   /*!
+     \brief Values that go up and down, such as the amount of proposals in flight
+    */
+   std::map <std::string, int64_t>                      gauges;
+
+   std::map <std::string, histogram>                    histograms;
+};
+
+}
+
+#endif  //! LIBPAXOS_CPP_METRICS_HPP
@@ -37,7 +37,7 @@ server::server (
              processor,
              configuration)
 {
-   io_thread_.launch ();
+   io_thread_.launch (configuration.io_threads ());
 }
 
 server::server (
@@ -82,6 +82,12 @@ server::server (
 server::~server ()
 {
    stop ();
+
+   /*!
+     Handlers that are still running on any of our threads must complete before our members
+     are destroyed.
+    */
+   io_thread_.join ();
 }
 
 void
@@ -98,6 +104,28 @@ server::stop ()
 }
 
 
+void
+server::set_snapshot (
+   snapshot_callback_type const &       snapshot,
+   restore_callback_type const &        restore)
+{
+   state_.set_snapshot (snapshot,
+                        restore);
+}
+
+void
+server::set_read (
+   read_callback_type const &           read)
+{
+   state_.set_read (read);
+}
+
+paxos::metrics
+server::metrics ()
+{
+   return state_.metrics ().snapshot ();
+}
+
 void
 server::add (
    std::initializer_list <std::pair <std::string, uint16_t> > const &        servers)
@@ -124,13 +152,15 @@ void
 server::accept ()
 {
    detail::tcp_connection_ptr connection = 
-      detail::tcp_connection::create (acceptor_.get_io_service ());
+      detail::tcp_connection::create (acceptor_.get_io_service (),
+                                      quorum_.strand ());
 
    acceptor_.async_accept (connection->socket (),
-                           std::bind (&server::handle_accept,
-                                      this,
-                                      connection,
-                                      std::placeholders::_1));
+                           quorum_.strand ().wrap (
+                              std::bind (&server::handle_accept,
+                                         this,
+                                         connection,
+                                         std::placeholders::_1)));
 }
 
 
@@ -145,6 +175,8 @@ server::handle_accept (
       return;
    }
 
+   state_.metrics ().add_connection (new_connection);
+
    new_connection->read_command_loop (
       std::bind (&detail::command_dispatcher::dispatch_command,
                  std::placeholders::_1,
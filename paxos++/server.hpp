@@ -18,6 +18,7 @@
 #include "detail/tcp_connection_fwd.hpp"
 
 #include "configuration.hpp"
+#include "metrics.hpp"
 
 namespace paxos {
 
@@ -33,7 +34,7 @@ namespace paxos {
 
   \par Thread Safety
   \e Distinct \e objects: Safe\n
-  \e Shared \e objects: Unsafe\n
+  \e Shared \e objects: Unsafe, except for metrics ()\n
 
   \par Examples
 
@@ -129,6 +130,38 @@ public:
    */
    typedef boost::function <std::string (int64_t proposal_id, std::string const & message)> callback_type;
 
+   /*!
+     \brief Callback function that returns a snapshot of the application's state
+     \returns The state after processing all proposals passed to the callback_type so far
+
+     The snapshot is a binary-safe byte array, of which the format is up to the application.
+    */
+   typedef boost::function <std::string ()> snapshot_callback_type;
+
+   /*!
+     \brief Callback function that replaces the application's state with a snapshot
+     \param proposal_id The last proposal id processed by the server that took the snapshot
+     \param snapshot    The snapshot, as returned by a snapshot_callback_type at another server
+
+     After this call, the application must behave as if it has processed all proposals up to
+     and including \c proposal_id, and the callback_type is called again starting with
+     proposal id \c proposal_id + 1.
+    */
+   typedef boost::function <void (int64_t proposal_id, std::string const & snapshot)> restore_callback_type;
+
+   /*!
+     \brief Callback function that answers a read-only request
+     \param message The message that is sent from the client with client::read () or
+                    client::follower_read ()
+     \returns The output that should be returned to the client
+
+     This can be called at any server, once the proposals it has processed cover the highest
+     proposal id the client has seen: for client::read () this server is the leader, for
+     client::follower_read () it can be any server in the quorum. It must not modify the
+     application's state, and is called from the same thread as the callback_type.
+    */
+   typedef boost::function <std::string (std::string const & message)> read_callback_type;
+
 public:
 
    /*!
@@ -152,7 +185,8 @@ public:
      \param callback      Callback used to process workload
      \param configuration (Optional) Runtime configuration
 
-     This constructor launches its own background thread with i/o context.
+     This constructor launches its own background threads with i/o context, see
+     configuration::set_io_threads ().
    */
    server (
       std::string const &               server,
@@ -181,6 +215,8 @@ public:
      \param port          Port we're listening at to new connections
      \param callback      Callback used to process workload
      \param configuration (Optional) Runtime configuration
+
+     The io_service can safely be run by multiple threads at the same time.
    */
    server (
       boost::asio::io_service &         io_service,
@@ -214,6 +250,55 @@ public:
    add (
       std::initializer_list <std::pair <std::string, uint16_t> > const &        servers);
 
+   /*!
+     \brief Enables catching up servers using snapshots of the application's state
+     \param snapshot    Callback used to take a snapshot of the application's state
+     \param restore     Callback used to replace the application's state with a snapshot
+
+     Servers only keep a limited amount of history (see durable::storage::set_history_size ()),
+     so a server that has been away for a long time might miss history that is not available
+     anywhere anymore. When snapshots are enabled, the leader sends such a server a snapshot
+     instead, after which it is caught up with the history that follows.
+
+     This must be called before any servers are added, and all servers in the quorum should
+     use the same callbacks.
+    */
+   void
+   set_snapshot (
+      snapshot_callback_type const &            snapshot,
+      restore_callback_type const &             restore);
+
+   /*!
+     \brief Enables answering read-only requests from a server's local state
+     \param read        Callback used to answer read-only requests
+
+     Without this callback, read-only requests are processed by the callback_type at all
+     servers, like any other request. See configuration::set_leader_leases () for how the
+     leader confirms it is still the leader before it answers a read.
+    */
+   void
+   set_read (
+      read_callback_type const &                read);
+
+   /*!
+     \brief Returns a copy of the measurements this server has taken so far
+
+     Can be called from any thread, at any time. The following metrics are kept:
+
+     - "request_queue.wait_us": time requests wait in line before they are proposed;
+     - "proposals", "proposals.requests" and "proposals.in_flight": amount of proposals
+       started, requests proposed and proposals currently in flight as a leader;
+     - "proposals.latency_us": time from starting a proposal until its responses are sent;
+     - "prepare.<follower>.latency_us" and "accept.<follower>.latency_us": round trip of
+       the prepare and accept phase, for each follower;
+     - "storage.accept.latency_us" and "storage.flush.latency_us": time spent writing to
+       durable storage, see durable::storage::accept () and durable::storage::flush ();
+     - "connection.<endpoint>.bytes_in" and "connection.<endpoint>.bytes_out": traffic of
+       each open connection with a client or another server.
+    */
+   paxos::metrics
+   metrics ();
+
    /*!
      \brief Blocks until internal worker thread has stoppped
 
@@ -0,0 +1,110 @@
+/*!
+  Validates that servers processing their workloads on a separate apply thread still process
+  all proposals strictly in order, and reply with the processed results.
+ */
+
+#include <atomic>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <paxos++/client.hpp>
+#include <paxos++/server.hpp>
+#include <paxos++/configuration.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+int main ()
+{
+   std::atomic <uint16_t> response_count (0);
+   std::atomic <uint16_t> out_of_order (0);
+
+   boost::mutex         mutex;
+   std::vector <int64_t> highest_proposal_ids (3, 0);
+
+   std::vector <paxos::server::callback_type> callbacks;
+
+   for (std::size_t server = 0; server < 3; ++server)
+   {
+      callbacks.push_back (
+         [server, & mutex, & highest_proposal_ids, & response_count, & out_of_order]
+         (int64_t proposal_id, std::string const & workload) -> std::string
+         {
+            boost::mutex::scoped_lock lock (mutex);
+
+            if (proposal_id != highest_proposal_ids[server] + 1)
+            {
+               ++out_of_order;
+            }
+
+            highest_proposal_ids[server] = proposal_id;
+            ++response_count;
+
+            /*!
+              A slow state machine
+             */
+            boost::this_thread::sleep (
+               boost::posix_time::milliseconds (1));
+
+            return workload + "bar";
+         });
+   }
+
+   paxos::configuration configuration1;
+   paxos::configuration configuration2;
+   paxos::configuration configuration3;
+
+   configuration1.set_apply_thread (true);
+   configuration2.set_apply_thread (true);
+   configuration3.set_apply_thread (true);
+
+   configuration1.set_pipeline_window (8);
+   configuration2.set_pipeline_window (8);
+   configuration3.set_pipeline_window (8);
+
+   paxos::server server1 ("127.0.0.1", 1337, callbacks[0], configuration1);
+   paxos::server server2 ("127.0.0.1", 1338, callbacks[1], configuration2);
+   paxos::server server3 ("127.0.0.1", 1339, callbacks[2], configuration3);
+
+   server1.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server2.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server3.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   std::vector <boost::shared_ptr <paxos::client> > clients;
+
+   for (std::size_t i = 0; i < 4; ++i)
+   {
+      boost::shared_ptr <paxos::client> client (new paxos::client ());
+      client->add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+      clients.push_back (client);
+   }
+
+   /*!
+     Ensure everyone agrees on a leader before we start sending concurrent requests
+    */
+   PAXOS_ASSERT_EQ (clients[0]->send ("foo").get (), "foobar");
+
+   uint16_t calls = 1;
+
+   for (std::size_t round = 0; round < 25; ++round)
+   {
+      std::vector <std::future <std::string> > futures;
+
+      for (auto & client : clients)
+      {
+         futures.push_back (client->send ("foo"));
+      }
+
+      for (auto & future : futures)
+      {
+         PAXOS_ASSERT_EQ (future.get (), "foobar");
+         ++calls;
+      }
+   }
+
+   PAXOS_ASSERT_EQ (response_count, 3 * calls);
+   PAXOS_ASSERT_EQ (out_of_order, 0);
+
+   PAXOS_INFO ("test succeeded");
+}
@@ -0,0 +1,136 @@
+/*!
+  Validates that a leader batches concurrent requests from multiple clients into a single
+  proposal, and that every client receives the response to its own request.
+ */
+
+#include <atomic>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+
+#include <paxos++/client.hpp>
+#include <paxos++/server.hpp>
+#include <paxos++/configuration.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+#include <paxos++/detail/strategy/factory.hpp>
+#include <paxos++/detail/strategy/basic_paxos/protocol/strategy.hpp>
+
+static std::atomic <uint32_t> accept_count (0);
+
+/*!
+  Counts the amount of accept requests received by followers
+ */
+class test_strategy : public paxos::detail::strategy::basic_paxos::protocol::strategy
+{
+public:
+   test_strategy (
+      paxos::durable::storage & storage)
+      : paxos::detail::strategy::basic_paxos::protocol::strategy::strategy (storage) {}
+
+   virtual void
+   accept (
+      paxos::detail::tcp_connection_ptr         leader_connection,
+      paxos::detail::command const &            command,
+      paxos::detail::quorum::server_view &      quorum,
+      paxos::detail::paxos_context &            state)
+      {
+         ++accept_count;
+
+         paxos::detail::strategy::basic_paxos::protocol::strategy::accept (leader_connection,
+                                                                           command,
+                                                                           quorum,
+                                                                           state);
+      }
+};
+
+class test_strategy_factory : public paxos::detail::strategy::factory
+{
+public:
+
+   test_strategy_factory (
+      paxos::durable::storage & storage)
+      : storage_ (storage)
+      {
+      }
+
+   virtual paxos::detail::strategy::strategy *
+   create () const
+      {
+         return new test_strategy (storage_);
+      }
+
+private:
+   paxos::durable::storage &    storage_;
+
+};
+
+int main ()
+{
+   std::atomic <uint16_t> response_count (0);
+
+   paxos::server::callback_type callback =
+      [& response_count](int64_t, std::string const & workload) -> std::string
+      {
+         ++response_count;
+         return workload + "bar";
+      };
+
+   paxos::configuration configuration1;
+   paxos::configuration configuration2;
+
+   configuration1.set_batch_size (8);
+   configuration2.set_batch_size (8);
+
+   configuration1.set_strategy_factory (new test_strategy_factory (configuration1.durable_storage ()));
+   configuration2.set_strategy_factory (new test_strategy_factory (configuration2.durable_storage ()));
+
+   paxos::server server1 ("127.0.0.1", 1337, callback, configuration1);
+   paxos::server server2 ("127.0.0.1", 1338, callback, configuration2);
+
+   server1.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}});
+   server2.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}});
+
+   std::vector <boost::shared_ptr <paxos::client> > clients;
+
+   for (std::size_t i = 0; i < 8; ++i)
+   {
+      boost::shared_ptr <paxos::client> client (new paxos::client ());
+      client->add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}});
+
+      clients.push_back (client);
+   }
+
+   /*!
+     Ensure everyone agrees on a leader before we start sending concurrent requests
+    */
+   PAXOS_ASSERT_EQ (clients[0]->send ("foo").get (), "foobar");
+
+   uint16_t calls = 1;
+
+   for (std::size_t round = 0; round < 25; ++round)
+   {
+      std::vector <std::future <std::string> > futures;
+
+      for (std::size_t i = 0; i < clients.size (); ++i)
+      {
+         futures.push_back (clients[i]->send (boost::lexical_cast <std::string> (i)));
+      }
+
+      for (std::size_t i = 0; i < futures.size (); ++i)
+      {
+         PAXOS_ASSERT_EQ (futures[i].get (), boost::lexical_cast <std::string> (i) + "bar");
+         ++calls;
+      }
+   }
+
+   PAXOS_ASSERT_EQ (response_count, 2 * calls);
+
+   /*!
+     Every accept is received by both servers, so if no requests were batched at all, we
+     would have received exactly twice as many accepts as calls.
+    */
+   PAXOS_ASSERT_LT (accept_count, 2 * calls);
+
+   PAXOS_INFO ("test succeeded");
+}
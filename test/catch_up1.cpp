@@ -0,0 +1,171 @@
+/*!
+  Tests whether history is retrieved in bounded ranges, and whether a server that is down
+  for a while gets properly catched up when only a few proposals are sent at a time.
+ */
+
+#include <stdlib.h>
+
+#include <boost/thread/mutex.hpp>
+
+#include <paxos++/client.hpp>
+#include <paxos++/server.hpp>
+#include <paxos++/durable/heap.hpp>
+#include <paxos++/durable/ring_buffer.hpp>
+#include <paxos++/durable/segmented_log.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+static void
+validate_range (
+   paxos::durable::storage &    storage)
+{
+   for (int64_t i = 1; i <= 100; ++i)
+   {
+      storage.accept (i, std::string (i, 'a'), i);
+   }
+
+   /*!
+     Bounded by the amount of entries
+    */
+   std::map <int64_t, std::string> range = storage.retrieve_range (10, 5, 1000000);
+   PAXOS_ASSERT_EQ (range.size (), 5);
+   PAXOS_ASSERT_EQ (range.begin ()->first, 11);
+   PAXOS_ASSERT_EQ (range.rbegin ()->first, 15);
+   PAXOS_ASSERT_EQ (range.rbegin ()->second, std::string (15, 'a'));
+
+   /*!
+     Bounded by the amount of bytes: 21 + 22 + 23 fit within 70 bytes, 24 more do not
+    */
+   range = storage.retrieve_range (20, 100, 70);
+   PAXOS_ASSERT_EQ (range.size (), 3);
+   PAXOS_ASSERT_EQ (range.rbegin ()->first, 23);
+
+   /*!
+     The first value is always returned, even if it is larger than the amount of bytes
+    */
+   range = storage.retrieve_range (50, 100, 10);
+   PAXOS_ASSERT_EQ (range.size (), 1);
+   PAXOS_ASSERT_EQ (range.begin ()->first, 51);
+
+   PAXOS_ASSERT_EQ (storage.retrieve_range (98, 100, 1000000).size (), 2);
+   PAXOS_ASSERT_EQ (storage.retrieve_range (100, 100, 1000000).empty (), true);
+}
+
+bool
+all_responses_equal (
+   std::map <int64_t, uint16_t> const & responses,
+   uint16_t                             count)
+{
+   for (auto const & i : responses)
+   {
+      if (i.second != count)
+      {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+int main ()
+{
+   {
+      paxos::durable::heap storage;
+      validate_range (storage);
+   }
+
+   {
+      paxos::durable::ring_buffer storage;
+      validate_range (storage);
+   }
+
+   {
+      PAXOS_ASSERT_EQ (system ("rm -rf catch_up1.log"), 0);
+
+      paxos::durable::segmented_log storage ("catch_up1.log", 1024, false);
+      validate_range (storage);
+   }
+
+   PAXOS_ASSERT_EQ (system ("rm -rf catch_up1.log"), 0);
+
+
+   std::map <int64_t, uint16_t> responses;
+
+   /*!
+     Synchronizes access to responses
+    */
+   boost::mutex mutex;
+
+   paxos::configuration configuration1;
+   paxos::configuration configuration2;
+   paxos::configuration configuration3;
+
+   /*!
+     Only catch up a lagging server with 5 proposals at a time.
+    */
+   configuration1.durable_storage ().set_catch_up_size (5);
+   configuration2.durable_storage ().set_catch_up_size (5);
+   configuration3.durable_storage ().set_catch_up_size (5);
+
+   paxos::server::callback_type callback = 
+      [& responses,
+       & mutex](
+         int64_t                promise_id,
+         std::string const &    workload) -> std::string
+      {
+         boost::mutex::scoped_lock lock (mutex);
+
+         if (responses.find (promise_id) == responses.end ())
+         {
+            responses[promise_id] = 1;
+         }
+         else
+         {
+            responses[promise_id]++;
+         }
+
+         PAXOS_ASSERT (responses[promise_id] <= 3);
+
+         return "bar";
+      };
+
+   paxos::server server1 ("127.0.0.1", 1337, callback, configuration1);
+   paxos::server server2 ("127.0.0.1", 1338, callback, configuration2);
+
+   server1.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server2.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   paxos::client client;
+   client.add  ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   {
+      paxos::server server3 ("127.0.0.1", 1339, callback, configuration3);
+
+      server3.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+      PAXOS_ASSERT_EQ (all_responses_equal (responses, 3), true);
+   }
+
+   for (std::size_t i = 0; i < 10; ++i)
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+   }
+
+   PAXOS_ASSERT_EQ (all_responses_equal (responses, 3), false);
+
+   paxos::server server3 ("127.0.0.1", 1339, callback, configuration3);
+
+   server3.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   boost::this_thread::sleep (
+      boost::posix_time::milliseconds (
+         paxos::configuration ().timeout ()));
+
+   do
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");   
+      
+   } while (all_responses_equal (responses, 3) == false);
+
+   PAXOS_INFO ("test succeeded");
+}
@@ -0,0 +1,118 @@
+/*!
+  Tests whether a server that has been down for a long time is caught up in the background,
+  while the rest of the quorum keeps processing requests without waiting for it.
+ */
+
+#include <boost/thread/mutex.hpp>
+
+#include <paxos++/client.hpp>
+#include <paxos++/server.hpp>
+#include <paxos++/durable/storage.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+bool
+all_responses_equal (
+   std::map <int64_t, uint16_t> const & responses,
+   uint16_t                             count)
+{
+   for (auto const & i : responses)
+   {
+      if (i.second != count)
+      {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+int main ()
+{
+   std::map <int64_t, uint16_t> responses;
+
+   /*!
+     Synchronizes access to responses
+    */
+   boost::mutex mutex;
+
+   paxos::configuration configuration1;
+   paxos::configuration configuration2;
+   paxos::configuration configuration3;
+
+   /*!
+     Our lagging server misses far more proposals than can be caught up at once, which
+     would make every request fail if it was caught up as part of our proposals.
+    */
+   configuration1.durable_storage ().set_catch_up_size (5);
+   configuration2.durable_storage ().set_catch_up_size (5);
+   configuration3.durable_storage ().set_catch_up_size (5);
+
+   paxos::server::callback_type callback = 
+      [& responses,
+       & mutex](
+         int64_t                promise_id,
+         std::string const &    workload) -> std::string
+      {
+         boost::mutex::scoped_lock lock (mutex);
+
+         if (responses.find (promise_id) == responses.end ())
+         {
+            responses[promise_id] = 1;
+         }
+         else
+         {
+            responses[promise_id]++;
+         }
+
+         PAXOS_ASSERT (responses[promise_id] <= 3);
+
+         return "bar";
+      };
+
+   paxos::server server1 ("127.0.0.1", 1337, callback, configuration1);
+   paxos::server server2 ("127.0.0.1", 1338, callback, configuration2);
+
+   server1.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server2.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   paxos::client client;
+   client.add  ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   {
+      paxos::server server3 ("127.0.0.1", 1339, callback, configuration3);
+
+      server3.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+      PAXOS_ASSERT_EQ (all_responses_equal (responses, 3), true);
+   }
+
+   for (std::size_t i = 0; i < 100; ++i)
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+   }
+
+   PAXOS_ASSERT_EQ (all_responses_equal (responses, 3), false);
+
+   paxos::server server3 ("127.0.0.1", 1339, callback, configuration3);
+
+   server3.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   boost::this_thread::sleep (
+      boost::posix_time::milliseconds (
+         paxos::configuration ().timeout ()));
+
+   /*!
+     Every request must succeed while our server is being caught up.
+    */
+   do
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");   
+      
+   } while (all_responses_equal (responses, 3) == false);
+
+   PAXOS_ASSERT_EQ (configuration3.durable_storage ().highest_proposal_id (),
+                    configuration1.durable_storage ().highest_proposal_id ());
+
+   PAXOS_INFO ("test succeeded");
+}
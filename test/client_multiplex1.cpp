@@ -0,0 +1,94 @@
+/*!
+  Validates that many application threads can share a single client, and that each of
+  them receives the response to its own request.
+ */
+
+#include <atomic>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <paxos++/client.hpp>
+#include <paxos++/server.hpp>
+#include <paxos++/configuration.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+int main ()
+{
+   std::atomic <uint16_t> response_count (0);
+
+   paxos::server::callback_type callback = 
+      [& response_count](int64_t proposal_id, std::string const & workload) -> std::string
+      {
+         ++response_count;
+         return workload + "bar";
+      };
+
+   paxos::configuration configuration1;
+   paxos::configuration configuration2;
+   paxos::configuration configuration3;
+
+   configuration1.set_pipeline_window (8);
+   configuration2.set_pipeline_window (8);
+   configuration3.set_pipeline_window (8);
+
+   paxos::server server1 ("127.0.0.1", 1337, callback, configuration1);
+   paxos::server server2 ("127.0.0.1", 1338, callback, configuration2);
+   paxos::server server3 ("127.0.0.1", 1339, callback, configuration3);
+
+   server1.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server2.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server3.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   /*!
+     Fewer requests can be in flight than our threads send at once, so some of them have to
+     wait for a slot inside the client
+    */
+   paxos::configuration client_configuration;
+   client_configuration.set_request_window (16);
+
+   paxos::client client (client_configuration);
+   client.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   /*!
+     Ensure everyone agrees on a leader before we start sending concurrent requests
+    */
+   PAXOS_ASSERT_EQ (client.send ("foo").get (), "foobar");
+
+   std::atomic <uint16_t> mismatches (0);
+
+   boost::thread_group threads;
+
+   for (std::size_t thread = 0; thread < 4; ++thread)
+   {
+      threads.create_thread (
+         [thread, & client, & mismatches]
+         {
+            std::vector <std::string>                 workloads;
+            std::vector <std::future <std::string> > futures;
+
+            for (std::size_t i = 0; i < 50; ++i)
+            {
+               workloads.push_back (boost::lexical_cast <std::string> (thread) + "-" +
+                                    boost::lexical_cast <std::string> (i));
+               futures.push_back (client.send (workloads.back ()));
+            }
+
+            for (std::size_t i = 0; i < futures.size (); ++i)
+            {
+               if (futures[i].get () != workloads[i] + "bar")
+               {
+                  ++mismatches;
+               }
+            }
+         });
+   }
+
+   threads.join_all ();
+
+   PAXOS_ASSERT_EQ (mismatches, 0);
+   PAXOS_ASSERT_EQ (response_count, 3 * (1 + 4 * 50));
+
+   PAXOS_INFO ("test succeeded");
+}
@@ -0,0 +1,110 @@
+/*!
+  Validates that commands survive a round trip through the wire format, and that malformed
+  input is rejected instead of being misinterpreted.
+ */
+
+#include <boost/uuid/uuid_generators.hpp>
+
+#include <paxos++/exception/exception.hpp>
+#include <paxos++/detail/command.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+void
+validate_round_trip (
+   boost::asio::ip::tcp::endpoint const &       endpoint)
+{
+   boost::uuids::basic_random_generator <boost::mt19937> gen;
+   boost::uuids::uuid id = gen ();
+
+   paxos::detail::command input;
+   input.set_type (paxos::detail::command::type_request_accept);
+   input.set_error_code (paxos::detail::error_incorrect_proposal);
+   input.set_host_id (id);
+   input.set_host_endpoint (endpoint);
+   input.set_next_proposal_id (-1);
+   input.set_highest_proposal_id (1ll << 40);
+   input.set_lowest_proposal_id (42);
+   input.set_request_id (~0ull);
+   input.set_workload (std::string ("binary\0safe", 11));
+   input.add_proposed_workload (43, "foo");
+   input.add_proposed_workload (44, std::string ());
+   input.add_proposed_workload (45, std::string (70000, 'x'));
+
+   std::string encoded = paxos::detail::command::to_string (input);
+   paxos::detail::command output = paxos::detail::command::from_string (encoded);
+
+   PAXOS_ASSERT_EQ (output.type (), input.type ());
+   PAXOS_ASSERT_EQ (output.error_code (), input.error_code ());
+   PAXOS_ASSERT (output.host_id () == id);
+   PAXOS_ASSERT (output.host_endpoint () == endpoint);
+   PAXOS_ASSERT_EQ (output.next_proposal_id (), -1);
+   PAXOS_ASSERT_EQ (output.highest_proposal_id (), 1ll << 40);
+   PAXOS_ASSERT_EQ (output.lowest_proposal_id (), 42);
+   PAXOS_ASSERT_EQ (output.request_id (), ~0ull);
+   PAXOS_ASSERT (output.workload () == input.workload ());
+   PAXOS_ASSERT (output.proposed_workload () == input.proposed_workload ());
+}
+
+int main ()
+{
+   validate_round_trip (
+      boost::asio::ip::tcp::endpoint (
+         boost::asio::ip::address::from_string ("127.0.0.1"), 1337));
+
+   validate_round_trip (
+      boost::asio::ip::tcp::endpoint (
+         boost::asio::ip::address::from_string ("fe80::1"), 65535));
+
+   /*!
+     A default constructed command must be encodable too, since that is what we use for
+     commands without any host information.
+    */
+   paxos::detail::command empty;
+   paxos::detail::command::from_string (
+      paxos::detail::command::to_string (empty));
+
+#ifndef PAXOS_TEXT_CODEC
+   paxos::detail::command input;
+   input.set_workload ("foo");
+
+   std::string encoded = paxos::detail::command::to_string (input);
+
+   /*!
+     Truncated commands should never be decoded
+    */
+   for (std::size_t i = 0; i < encoded.size (); ++i)
+   {
+      PAXOS_ASSERT_THROW (paxos::detail::command::from_string (encoded.substr (0, i)),
+                          paxos::exception::protocol_error);
+   }
+
+   /*!
+     Neither should commands with an unknown version or trailing garbage
+    */
+   std::string wrong_version = encoded;
+   wrong_version[0] = paxos::detail::command::wire_version + 1;
+
+   PAXOS_ASSERT_THROW (paxos::detail::command::from_string (wrong_version),
+                       paxos::exception::protocol_error);
+   PAXOS_ASSERT_THROW (paxos::detail::command::from_string (encoded + "x"),
+                       paxos::exception::protocol_error);
+
+   /*!
+     Or commands with an unknown type or error code, even though they are otherwise well
+     formed
+    */
+   std::string unknown_type = encoded;
+   unknown_type[1] = paxos::detail::command::type_request_follower_read + 1;
+
+   PAXOS_ASSERT_THROW (paxos::detail::command::from_string (unknown_type),
+                       paxos::exception::protocol_error);
+
+   std::string unknown_error_code = encoded;
+   unknown_error_code[2] = paxos::detail::error_no_majority + 1;
+
+   PAXOS_ASSERT_THROW (paxos::detail::command::from_string (unknown_error_code),
+                       paxos::exception::protocol_error);
+#endif //! PAXOS_TEXT_CODEC
+
+   PAXOS_INFO ("test succeeded");
+}
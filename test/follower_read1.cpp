@@ -0,0 +1,77 @@
+/*!
+  Validates that read-only requests are spread across all servers, and that each of them
+  reflects at least the requests the client has received the result of.
+ */
+
+#include <atomic>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+
+#include <paxos++/client.hpp>
+#include <paxos++/server.hpp>
+#include <paxos++/configuration.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+int main ()
+{
+   std::atomic <uint16_t> response_count (0);
+   std::vector <int64_t>  highest_proposal_ids (3, 0);
+   std::vector <uint16_t> read_counts (3, 0);
+
+   std::vector <paxos::server::callback_type>           callbacks;
+   std::vector <paxos::server::read_callback_type>      reads;
+
+   for (std::size_t server = 0; server < 3; ++server)
+   {
+      callbacks.push_back (
+         [server, & highest_proposal_ids, & response_count]
+         (int64_t proposal_id, std::string const & workload) -> std::string
+         {
+            highest_proposal_ids[server] = proposal_id;
+            ++response_count;
+
+            return workload + "bar";
+         });
+
+      reads.push_back (
+         [server, & highest_proposal_ids, & read_counts]
+         (std::string const & workload) -> std::string
+         {
+            ++read_counts[server];
+            return boost::lexical_cast <std::string> (highest_proposal_ids[server]);
+         });
+   }
+
+   paxos::server server1 ("127.0.0.1", 1337, callbacks[0]);
+   paxos::server server2 ("127.0.0.1", 1338, callbacks[1]);
+   paxos::server server3 ("127.0.0.1", 1339, callbacks[2]);
+
+   server1.set_read (reads[0]);
+   server2.set_read (reads[1]);
+   server3.set_read (reads[2]);
+
+   server1.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server2.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server3.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   paxos::client client;
+   client.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   for (int64_t i = 1; i <= 30; ++i)
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "foobar");
+      PAXOS_ASSERT_GE (boost::lexical_cast <int64_t> (client.follower_read ("foo").get ()), i);
+   }
+
+   /*!
+     Reads are never proposed to the quorum.
+    */
+   PAXOS_ASSERT_EQ (response_count, 3 * 30);
+
+   PAXOS_ASSERT_GE (read_counts[0], 1);
+   PAXOS_ASSERT_GE (read_counts[1], 1);
+   PAXOS_ASSERT_GE (read_counts[2], 1);
+
+   PAXOS_INFO ("test succeeded");
+}
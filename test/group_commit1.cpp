@@ -0,0 +1,150 @@
+/*!
+  Validates that with group commit enabled, requests are processed as usual, that no value
+  is processed before it has been flushed, and that a follower which is caught up with a
+  large history flushes that history at once.
+ */
+
+#include <atomic>
+
+#include <boost/date_time/posix_time/posix_time_duration.hpp>
+
+#include <paxos++/client.hpp>
+#include <paxos++/server.hpp>
+#include <paxos++/configuration.hpp>
+#include <paxos++/durable/heap.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+/*!
+  Counts the amount of values stored and the amount of flushes
+ */
+class test_storage : public paxos::durable::heap
+{
+public:
+
+   test_storage ()
+      : stores_ (0),
+        flushes_ (0),
+        flushed_ (0)
+      {
+         this->set_group_commit (true);
+      }
+
+   virtual void
+   flush ()
+      {
+         ++flushes_;
+         flushed_ = this->highest_proposal_id ();
+      }
+
+   uint32_t
+   stores () const
+      {
+         return stores_;
+      }
+
+   uint32_t
+   flushes () const
+      {
+         return flushes_;
+      }
+
+   /*!
+     \brief Highest proposal id that was stored at the time of the last flush
+    */
+   int64_t
+   flushed () const
+      {
+         return flushed_;
+      }
+
+protected:
+
+   virtual void
+   store (
+      int64_t                   proposal_id,
+      std::string const &       byte_array)
+      {
+         ++stores_;
+
+         paxos::durable::heap::store (proposal_id,
+                                      byte_array);
+      }
+
+private:
+
+   std::atomic <uint32_t>       stores_;
+   std::atomic <uint32_t>       flushes_;
+   std::atomic <int64_t>        flushed_;
+};
+
+int main ()
+{
+   std::atomic <uint16_t> response_count (0);
+   uint16_t calls = 0;
+
+   /*!
+     A value must only be processed once it has been flushed, otherwise a crash could leave
+     the application with values that are missing from durable storage.
+    */
+   auto callback =
+      [& response_count](test_storage const * storage) -> paxos::server::callback_type
+      {
+         return [& response_count, storage](int64_t proposal_id, std::string const &) -> std::string
+         {
+            PAXOS_ASSERT_LE (proposal_id, storage->flushed ());
+
+            ++response_count;
+            return "bar";
+         };
+      };
+
+   paxos::configuration configuration1;
+   paxos::configuration configuration2;
+   paxos::configuration configuration3;
+
+   test_storage * storage1 = new test_storage ();
+   test_storage * storage2 = new test_storage ();
+   test_storage * storage3 = new test_storage ();
+
+   configuration1.set_durable_storage (storage1);
+   configuration2.set_durable_storage (storage2);
+   configuration3.set_durable_storage (storage3);
+
+   paxos::server server1 ("127.0.0.1", 1337, callback (storage1), configuration1);
+   paxos::server server2 ("127.0.0.1", 1338, callback (storage2), configuration2);
+   paxos::client client;
+
+   server1.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server2.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   client.add  ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   for (; calls < 20; ++calls)
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+   }
+
+   PAXOS_ASSERT_EQ (response_count, 2 * calls);
+
+   /*!
+     The third server joins late, and is caught up with the whole history using a single
+     accept command.
+    */
+   paxos::server server3 ("127.0.0.1", 1339, callback (storage3), configuration3);
+   server3.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   do
+   {
+      boost::this_thread::sleep (
+         boost::posix_time::milliseconds (100));
+
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+      ++calls;
+
+   } while (response_count != 3 * calls && calls < 100);
+
+   PAXOS_ASSERT_EQ (response_count, 3 * calls);
+   PAXOS_ASSERT_EQ (storage3->stores (), calls);
+   PAXOS_ASSERT_LT (storage3->flushes (), storage3->stores ());
+
+   PAXOS_INFO ("test succeeded");
+}
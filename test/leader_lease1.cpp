@@ -0,0 +1,99 @@
+/*!
+  Validates that read-only requests are answered by the leader from its local state, and
+  always reflect all requests that completed before them, both with and without leases.
+ */
+
+#include <atomic>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+
+#include <paxos++/client.hpp>
+#include <paxos++/server.hpp>
+#include <paxos++/configuration.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+void
+run (
+   bool leases)
+{
+   std::atomic <uint16_t> response_count (0);
+   std::vector <int64_t>  highest_proposal_ids (3, 0);
+
+   std::vector <paxos::server::callback_type>           callbacks;
+   std::vector <paxos::server::read_callback_type>      reads;
+
+   for (std::size_t server = 0; server < 3; ++server)
+   {
+      callbacks.push_back (
+         [server, & highest_proposal_ids, & response_count]
+         (int64_t proposal_id, std::string const & workload) -> std::string
+         {
+            highest_proposal_ids[server] = proposal_id;
+            ++response_count;
+
+            return workload + "bar";
+         });
+
+      reads.push_back (
+         [server, & highest_proposal_ids]
+         (std::string const & workload) -> std::string
+         {
+            return workload + boost::lexical_cast <std::string> (highest_proposal_ids[server]);
+         });
+   }
+
+   paxos::configuration configuration1;
+   paxos::configuration configuration2;
+   paxos::configuration configuration3;
+
+   configuration1.set_leader_leases (leases);
+   configuration2.set_leader_leases (leases);
+   configuration3.set_leader_leases (leases);
+
+   paxos::server server1 ("127.0.0.1", 1337, callbacks[0], configuration1);
+   paxos::server server2 ("127.0.0.1", 1338, callbacks[1], configuration2);
+   paxos::server server3 ("127.0.0.1", 1339, callbacks[2], configuration3);
+
+   server1.set_read (reads[0]);
+   server2.set_read (reads[1]);
+   server3.set_read (reads[2]);
+
+   server1.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server2.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server3.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   paxos::client client;
+   client.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   for (std::size_t i = 1; i <= 20; ++i)
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "foobar");
+      PAXOS_ASSERT_EQ (client.read ("foo").get (), "foo" + boost::lexical_cast <std::string> (i));
+   }
+
+   std::vector <std::future <std::string> > futures;
+
+   for (std::size_t i = 0; i < 50; ++i)
+   {
+      futures.push_back (client.read ("foo"));
+   }
+
+   for (auto & future : futures)
+   {
+      PAXOS_ASSERT_EQ (future.get (), "foo20");
+   }
+
+   /*!
+     Reads are never proposed to the quorum.
+    */
+   PAXOS_ASSERT_EQ (response_count, 3 * 20);
+}
+
+int main ()
+{
+   run (false);
+   run (true);
+
+   PAXOS_INFO ("test succeeded");
+}
@@ -0,0 +1,255 @@
+/*!
+  Validates that with majority commit enabled, the leader replies to the client as soon as a
+  majority of the quorum has accepted a proposal, and that a follower lagging behind is
+  brought up to date afterwards. Finally validates that the client receives an error when
+  a proposal fails even though a majority promised.
+ */
+
+#include <atomic>
+
+#include <boost/date_time/posix_time/posix_time_duration.hpp>
+
+#include <paxos++/client.hpp>
+#include <paxos++/server.hpp>
+#include <paxos++/configuration.hpp>
+#include <paxos++/exception/exception.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+#include <paxos++/detail/strategy/factory.hpp>
+#include <paxos++/detail/strategy/basic_paxos/protocol/strategy.hpp>
+
+static std::atomic <bool> blocking (false);
+static std::atomic <bool> claimed (false);
+
+static std::atomic <bool> failing (false);
+static std::atomic <uint16_t> failing_roles (0);
+static std::atomic <uint16_t> failing_accept_port (0);
+
+/*!
+  While blocking, stalls every accept request received by a single follower.
+
+  While failing, one follower rejects the prepare right away, and the other follower
+  promises a while later, only to reject the accept that follows.
+ */
+class test_strategy : public paxos::detail::strategy::basic_paxos::protocol::strategy
+{
+public:
+   test_strategy (
+      paxos::durable::storage & storage)
+      : paxos::detail::strategy::basic_paxos::protocol::strategy::strategy (storage,
+                                                                            true),
+        slow_ (false) {}
+
+   virtual void
+   prepare (
+      paxos::detail::tcp_connection_ptr         leader_connection,
+      paxos::detail::command const &            command,
+      paxos::detail::quorum::server_view &      quorum,
+      paxos::detail::paxos_context &            state)
+      {
+         if (failing == true
+             && command.host_endpoint () != quorum.our_endpoint ())
+         {
+            if (failing_roles++ == 0)
+            {
+               this->process_remote_host_information (command,
+                                                      quorum);
+
+               this->reject (leader_connection,
+                             quorum);
+               return;
+            }
+
+            failing_accept_port = quorum.our_endpoint ().port ();
+
+            boost::this_thread::sleep (
+               boost::posix_time::milliseconds (100));
+         }
+
+         paxos::detail::strategy::basic_paxos::protocol::strategy::prepare (leader_connection,
+                                                                            command,
+                                                                            quorum,
+                                                                            state);
+      }
+
+   virtual void
+   accept (
+      paxos::detail::tcp_connection_ptr         leader_connection,
+      paxos::detail::command const &            command,
+      paxos::detail::quorum::server_view &      quorum,
+      paxos::detail::paxos_context &            state)
+      {
+         boost::optional <boost::asio::ip::tcp::endpoint> leader = quorum.who_is_our_leader ();
+
+         if (blocking == true
+             && leader.is_initialized () == true
+             && *leader != quorum.our_endpoint ()
+             && claimed.exchange (true) == false)
+         {
+            slow_ = true;
+         }
+
+         if (failing == true
+             && failing_accept_port == quorum.our_endpoint ().port ())
+         {
+            this->process_remote_host_information (command,
+                                                   quorum);
+
+            this->reject (leader_connection,
+                          quorum);
+            return;
+         }
+
+         while (slow_ == true && blocking == true)
+         {
+            boost::this_thread::sleep (
+               boost::posix_time::milliseconds (10));
+         }
+
+         paxos::detail::strategy::basic_paxos::protocol::strategy::accept (leader_connection,
+                                                                           command,
+                                                                           quorum,
+                                                                           state);
+      }
+
+private:
+
+   void
+   reject (
+      paxos::detail::tcp_connection_ptr         leader_connection,
+      paxos::detail::quorum::server_view &      quorum)
+      {
+         paxos::detail::command response;
+         response.set_type (paxos::detail::command::type_request_fail);
+         response.set_error_code (paxos::detail::error_incorrect_proposal);
+         response.set_next_proposal_id (this->proposal_id ());
+
+         this->add_local_host_information (quorum, response);
+
+         this->write_response (leader_connection,
+                               response);
+      }
+
+   bool slow_;
+};
+
+class test_strategy_factory : public paxos::detail::strategy::factory
+{
+public:
+
+   test_strategy_factory (
+      paxos::durable::storage & storage)
+      : storage_ (storage)
+      {
+      }
+
+   virtual paxos::detail::strategy::strategy *
+   create () const
+      {
+         return new test_strategy (storage_);
+      }
+
+private:
+   paxos::durable::storage &    storage_;
+
+};
+
+int main ()
+{
+   std::atomic <uint16_t> response_count (0);
+   uint16_t calls = 0;
+
+   paxos::server::callback_type callback =
+      [& response_count](int64_t, std::string const &) -> std::string
+      {
+         ++response_count;
+         return "bar";
+      };
+
+   paxos::configuration configuration1;
+   paxos::configuration configuration2;
+   paxos::configuration configuration3;
+
+   configuration1.set_strategy_factory (new test_strategy_factory (configuration1.durable_storage ()));
+   configuration2.set_strategy_factory (new test_strategy_factory (configuration2.durable_storage ()));
+   configuration3.set_strategy_factory (new test_strategy_factory (configuration3.durable_storage ()));
+
+   paxos::server server1 ("127.0.0.1", 1337, callback, configuration1);
+   paxos::server server2 ("127.0.0.1", 1338, callback, configuration2);
+   paxos::server server3 ("127.0.0.1", 1339, callback, configuration3);
+   paxos::client client;
+
+   server1.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server2.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server3.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   client.add  ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   for (; calls < 10; ++calls)
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+   }
+
+   /*!
+     The client might receive its response before the last server has processed it
+    */
+   for (uint16_t i = 0; i < 100 && response_count != 3 * calls; ++i)
+   {
+      boost::this_thread::sleep (
+         boost::posix_time::milliseconds (10));
+   }
+
+   PAXOS_ASSERT_EQ (response_count, 3 * calls);
+
+   /*!
+     Now one of the followers stops processing any requests, which should not affect the
+     client at all.
+    */
+   uint16_t previous_calls = calls;
+   blocking = true;
+
+   for (; calls < 20; ++calls)
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+   }
+
+   PAXOS_ASSERT_EQ (claimed, true);
+   PAXOS_ASSERT_EQ (response_count, 3 * previous_calls + 2 * (calls - previous_calls));
+
+   /*!
+     Once the follower continues, it should be caught up with everything it missed.
+    */
+   blocking = false;
+
+   do
+   {
+      boost::this_thread::sleep (
+         boost::posix_time::milliseconds (100));
+
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+      ++calls;
+
+   } while (response_count != 3 * calls && calls < 100);
+
+   boost::this_thread::sleep (
+      boost::posix_time::milliseconds (100));
+
+   PAXOS_ASSERT_EQ (response_count, 3 * calls);
+
+   /*!
+     Now one follower rejects the prepare before a majority promised, and the other one
+     rejects the accept: the proposal fails, and the client must be told so.
+    */
+   failing = true;
+
+   std::future <std::string> future = client.send ("foo", 0);
+
+   PAXOS_ASSERT (future.wait_for (std::chrono::seconds (5)) == std::future_status::ready);
+   PAXOS_ASSERT_THROW (future.get (), paxos::exception::incorrect_proposal);
+   PAXOS_ASSERT_EQ (failing_roles, 2);
+
+   failing = false;
+
+   PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+
+   PAXOS_INFO ("test succeeded");
+}
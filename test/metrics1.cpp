@@ -0,0 +1,126 @@
+/*!
+  Validates that histograms report percentiles within their precision, and that a server
+  records the latency of each phase of a proposal and the traffic of its connections.
+ */
+
+#include <boost/lexical_cast.hpp>
+
+#include <paxos++/client.hpp>
+#include <paxos++/server.hpp>
+#include <paxos++/configuration.hpp>
+#include <paxos++/detail/metrics/histogram.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+static void
+validate_histogram ()
+{
+   paxos::detail::metrics::histogram histogram;
+
+   PAXOS_ASSERT_EQ (histogram.snapshot ().count, 0);
+   PAXOS_ASSERT_EQ (histogram.snapshot ().percentile (0.5), 0);
+
+   for (uint64_t i = 1; i <= 1000; ++i)
+   {
+      histogram.record (i);
+   }
+
+   paxos::metrics::histogram snapshot = histogram.snapshot ();
+
+   PAXOS_ASSERT_EQ (snapshot.count, 1000);
+   PAXOS_ASSERT_EQ (snapshot.min, 1);
+   PAXOS_ASSERT_EQ (snapshot.max, 1000);
+   PAXOS_ASSERT_EQ (snapshot.sum, 500500);
+
+   /*!
+     Small values are exact, larger ones are rounded up by less than 1/16th
+    */
+   PAXOS_ASSERT_EQ (snapshot.percentile (0.005), 5);
+   PAXOS_ASSERT (snapshot.percentile (0.5) >= 500);
+   PAXOS_ASSERT (snapshot.percentile (0.5) <= 500 + 500 / 16);
+   PAXOS_ASSERT (snapshot.percentile (0.99) >= 990);
+   PAXOS_ASSERT (snapshot.percentile (0.99) <= 990 + 990 / 16);
+   PAXOS_ASSERT_EQ (snapshot.percentile (1.0), 1000);
+
+   /*!
+     The full range of 64 bits is covered
+    */
+   histogram.record (~0ull);
+
+   snapshot = histogram.snapshot ();
+
+   PAXOS_ASSERT_EQ (snapshot.count, 1001);
+   PAXOS_ASSERT_EQ (snapshot.max, ~0ull);
+   PAXOS_ASSERT_EQ (snapshot.percentile (1.0), ~0ull);
+}
+
+int main ()
+{
+   validate_histogram ();
+
+   paxos::server::callback_type callback =
+      [](int64_t proposal_id, std::string const & workload) -> std::string
+      {
+         return "bar";
+      };
+
+   paxos::server server1 ("127.0.0.1", 1337, callback);
+   paxos::server server2 ("127.0.0.1", 1338, callback);
+   paxos::server server3 ("127.0.0.1", 1339, callback);
+
+   server1.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server2.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server3.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   paxos::client client;
+   client.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   for (std::size_t i = 0; i < 10; ++i)
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+   }
+
+   std::vector <paxos::metrics> metrics = {server1.metrics (),
+                                           server2.metrics (),
+                                           server3.metrics ()};
+
+   std::size_t leaders = 0;
+
+   for (paxos::metrics & i : metrics)
+   {
+      /*!
+        Every server stores every proposal, including the leader
+       */
+      PAXOS_ASSERT_EQ (i.histograms["storage.accept.latency_us"].count, 10);
+
+      /*!
+        Until the servers agree on a leader, all of them might attempt to propose the first
+        request, but only the leader succeeds
+       */
+      if (i.histograms["proposals.latency_us"].count == 0)
+      {
+         continue;
+      }
+
+      ++leaders;
+
+      PAXOS_ASSERT_EQ (i.histograms["proposals.latency_us"].count, 10);
+      PAXOS_ASSERT (i.counters["proposals"] >= 10);
+      PAXOS_ASSERT (i.counters["proposals.requests"] >= 10);
+      PAXOS_ASSERT (i.histograms["request_queue.wait_us"].count >= 10);
+      PAXOS_ASSERT_EQ (i.gauges.count ("proposals.in_flight"), 1);
+
+      for (uint16_t port = 1337; port <= 1339; ++port)
+      {
+         std::string const follower = "127.0.0.1:" + boost::lexical_cast <std::string> (port);
+
+         PAXOS_ASSERT (i.histograms["prepare." + follower + ".latency_us"].count >= 10);
+         PAXOS_ASSERT_EQ (i.histograms["accept." + follower + ".latency_us"].count, 10);
+         PAXOS_ASSERT (i.counters["connection." + follower + ".bytes_out"] > 0);
+         PAXOS_ASSERT (i.counters["connection." + follower + ".bytes_in"] > 0);
+      }
+   }
+
+   PAXOS_ASSERT_EQ (leaders, 1);
+
+   PAXOS_INFO ("test succeeded");
+}
@@ -0,0 +1,159 @@
+/*!
+  Validates that the Multi-Paxos strategy only runs the prepare phase when the leader's ballot
+  must be (re-)established, and otherwise processes requests exactly like basic Paxos.
+ */
+
+#include <atomic>
+
+#include <boost/date_time/posix_time/posix_time_duration.hpp>
+
+#include <paxos++/client.hpp>
+#include <paxos++/server.hpp>
+#include <paxos++/configuration.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+#include <paxos++/detail/strategy/factory.hpp>
+#include <paxos++/detail/strategy/multi_paxos/protocol/strategy.hpp>
+
+static std::atomic <uint32_t> prepare_count (0);
+
+/*!
+  Counts the amount of prepare requests received by followers
+ */
+class test_strategy : public paxos::detail::strategy::multi_paxos::protocol::strategy
+{
+public:
+   test_strategy (
+      paxos::durable::storage & storage)
+      : paxos::detail::strategy::multi_paxos::protocol::strategy::strategy (storage) {}
+
+   virtual void
+   prepare (
+      paxos::detail::tcp_connection_ptr         leader_connection,
+      paxos::detail::command const &            command,
+      paxos::detail::quorum::server_view &      quorum,
+      paxos::detail::paxos_context &            state)
+      {
+         ++prepare_count;
+
+         paxos::detail::strategy::multi_paxos::protocol::strategy::prepare (leader_connection,
+                                                                             command,
+                                                                             quorum,
+                                                                             state);
+      }
+};
+
+class test_strategy_factory : public paxos::detail::strategy::factory
+{
+public:
+
+   test_strategy_factory (
+      paxos::durable::storage & storage)
+      : storage_ (storage)
+      {
+      }
+
+   virtual paxos::detail::strategy::strategy *
+   create () const
+      {
+         return new test_strategy (storage_);
+      }
+
+private:
+   paxos::durable::storage &    storage_;
+
+};
+
+int main ()
+{
+   std::atomic <uint16_t> response_count (0);
+   uint16_t calls = 0;
+
+   paxos::server::callback_type callback =
+      [& response_count](int64_t, std::string const &) -> std::string
+      {
+         ++response_count;
+         return "bar";
+      };
+
+   paxos::configuration configuration1;
+   paxos::configuration configuration2;
+   paxos::configuration configuration3;
+
+   configuration1.set_strategy_factory (new test_strategy_factory (configuration1.durable_storage ()));
+   configuration2.set_strategy_factory (new test_strategy_factory (configuration2.durable_storage ()));
+   configuration3.set_strategy_factory (new test_strategy_factory (configuration3.durable_storage ()));
+
+   paxos::server server1 ("127.0.0.1", 1337, callback, configuration1);
+   paxos::server server2 ("127.0.0.1", 1338, callback, configuration2);
+   paxos::client client;
+
+   server1.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server2.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   client.add  ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   for (; calls < 10; ++calls)
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+   }
+
+   PAXOS_ASSERT_EQ (response_count, 2 * calls);
+
+   /*!
+     Once the ballot has been established, no more prepares should be necessary
+    */
+   uint32_t prepares = prepare_count;
+
+   for (; calls < 20; ++calls)
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+   }
+
+   PAXOS_ASSERT_EQ (response_count, 2 * calls);
+   PAXOS_ASSERT_EQ (prepare_count, prepares);
+
+   /*!
+     A new server joining the quorum should invalidate the ballot, and thus cause a
+     new prepare round. The new server should be caught up as usual.
+    */
+   paxos::server server3 ("127.0.0.1", 1339, callback, configuration3);
+   server3.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   boost::this_thread::sleep (
+      boost::posix_time::milliseconds (
+         paxos::configuration ().timeout ()));
+
+   /*!
+     Reconnects to dead servers are only attempted once every few seconds, and requests
+     inside a ballot are fast, so give the leader some time to notice the new server.
+    */
+   do
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+      ++calls;
+
+      boost::this_thread::sleep (
+         boost::posix_time::milliseconds (100));
+
+   } while (response_count != 3 * calls && calls < 100);
+
+   PAXOS_ASSERT_EQ (response_count, 3 * calls);
+   PAXOS_ASSERT_GT (prepare_count, prepares);
+
+   for (uint16_t i = 0; i < 10; ++i, ++calls)
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+   }
+
+   prepares = prepare_count;
+
+   for (uint16_t i = 0; i < 10; ++i, ++calls)
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+   }
+
+   PAXOS_ASSERT_EQ (response_count, 3 * calls);
+   PAXOS_ASSERT_EQ (prepare_count, prepares);
+
+   PAXOS_INFO ("test succeeded");
+}
@@ -0,0 +1,106 @@
+/*!
+  Validates the ring buffer storage backend: growing and compacting its arena, removing
+  history, and continuing from a memory-mapped file after it has been reopened and
+  rewritten.
+ */
+
+#include <stdio.h>
+
+#include <boost/lexical_cast.hpp>
+
+#include <paxos++/durable/ring_buffer.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+static char const * filename = "ring_buffer1.ring";
+
+static std::string
+value (
+   int64_t      proposal_id)
+{
+   /*!
+     Large enough values to make the arena grow and wrap a few times
+    */
+   return std::string (10000, 'a' + proposal_id % 26) + boost::lexical_cast <std::string> (proposal_id);
+}
+
+static void
+validate (
+   paxos::durable::storage &    storage,
+   int64_t                      lowest,
+   int64_t                      highest)
+{
+   PAXOS_ASSERT_EQ (storage.lowest_proposal_id (), lowest);
+   PAXOS_ASSERT_EQ (storage.highest_proposal_id (), highest);
+
+   std::map <int64_t, std::string> history = storage.retrieve (0);
+   PAXOS_ASSERT_EQ (history.size (), highest - lowest + 1);
+
+   for (auto const & i : history)
+   {
+      PAXOS_ASSERT_EQ (i.second, value (i.first));
+   }
+
+   history = storage.retrieve (highest - 1);
+   PAXOS_ASSERT_EQ (history.size (), 1);
+   PAXOS_ASSERT_EQ (history.begin ()->first, highest);
+   PAXOS_ASSERT_EQ (storage.retrieve (highest).empty (), true);
+}
+
+int main ()
+{
+   remove (filename);
+
+   {
+      paxos::durable::ring_buffer storage;
+      storage.set_history_size (100);
+
+      PAXOS_ASSERT_EQ (storage.highest_proposal_id (), 0);
+      PAXOS_ASSERT_EQ (storage.lowest_proposal_id (), 0);
+      PAXOS_ASSERT_EQ (storage.retrieve (0).empty (), true);
+
+      for (int64_t i = 1; i <= 2050; ++i)
+      {
+         storage.accept (i, value (i), i);
+      }
+
+      /*!
+        The last cleanup at proposal 2000 removed everything up to 1900
+       */
+      validate (storage, 1901, 2050);
+   }
+
+   {
+      paxos::durable::ring_buffer storage (filename);
+      storage.set_history_size (100);
+
+      for (int64_t i = 1; i <= 2050; ++i)
+      {
+         storage.accept (i, value (i), i);
+      }
+
+      validate (storage, 1901, 2050);
+   }
+
+   /*!
+     Compacting the arena of a file replaces the file, which must not leave anything behind
+    */
+   PAXOS_ASSERT (fopen ((std::string (filename) + ".rewrite").c_str (), "r") == NULL);
+
+   {
+      paxos::durable::ring_buffer storage (filename);
+      storage.set_history_size (100);
+
+      validate (storage, 1901, 2050);
+
+      for (int64_t i = 2051; i <= 2100; ++i)
+      {
+         storage.accept (i, value (i), i);
+      }
+
+      validate (storage, 2001, 2100);
+   }
+
+   remove (filename);
+
+   PAXOS_INFO ("test succeeded");
+}
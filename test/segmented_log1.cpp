@@ -0,0 +1,147 @@
+/*!
+  Validates the segmented log durable storage backend: history spanning multiple segments,
+  removal of whole segments, recovery from a partially written record, and discarding a
+  record that could only be written partially.
+ */
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+#include <boost/lexical_cast.hpp>
+
+#include <paxos++/durable/segmented_log.hpp>
+#include <paxos++/exception/exception.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+static char const * directory = "segmented_log1.log";
+
+int main ()
+{
+   PAXOS_ASSERT_EQ (system ("rm -rf segmented_log1.log"), 0);
+
+   {
+      /*!
+        Each record is 16 bytes of header plus the value, so this starts a new segment
+        every 10 proposals.
+       */
+      paxos::durable::segmented_log storage (directory, 10 * (16 + 5), false);
+      storage.set_history_size (50);
+
+      PAXOS_ASSERT_EQ (storage.highest_proposal_id (), 0);
+      PAXOS_ASSERT_EQ (storage.lowest_proposal_id (), 0);
+      PAXOS_ASSERT_EQ (storage.retrieve (0).empty (), true);
+
+      for (int64_t i = 1; i <= 125; ++i)
+      {
+         storage.accept (i,
+                         "foo" + boost::lexical_cast <std::string> (i % 100),
+                         i);
+      }
+
+      PAXOS_ASSERT_EQ (storage.highest_proposal_id (), 125);
+
+      /*!
+        Proposal 100 triggered a cleanup of everything below 50, which lives inside the
+        segment starting at 41.
+       */
+      PAXOS_ASSERT_EQ (storage.lowest_proposal_id (), 41);
+
+      std::map <int64_t, std::string> history = storage.retrieve (99);
+      PAXOS_ASSERT_EQ (history.size (), 26);
+      PAXOS_ASSERT_EQ (history.begin ()->first, 100);
+      PAXOS_ASSERT_EQ (history.begin ()->second, "foo0");
+      PAXOS_ASSERT_EQ (history.rbegin ()->first, 125);
+      PAXOS_ASSERT_EQ (history.rbegin ()->second, "foo25");
+
+      PAXOS_ASSERT_EQ (storage.retrieve (0).size (), 85);
+      PAXOS_ASSERT_EQ (storage.retrieve (125).empty (), true);
+   }
+
+   /*!
+     Simulate a crash while writing a record
+    */
+   FILE * file = fopen ("segmented_log1.log/00000000000000000121.log", "a");
+   PAXOS_ASSERT (file != NULL);
+   fputs ("garbage", file);
+   fclose (file);
+
+   {
+      paxos::durable::segmented_log storage (directory, 10 * (16 + 5), false);
+
+      PAXOS_ASSERT_EQ (storage.highest_proposal_id (), 125);
+      PAXOS_ASSERT_EQ (storage.lowest_proposal_id (), 41);
+
+      storage.accept (126, "foo26", 126);
+
+      std::map <int64_t, std::string> history = storage.retrieve (123);
+      PAXOS_ASSERT_EQ (history.size (), 3);
+      PAXOS_ASSERT_EQ (history[124], "foo24");
+      PAXOS_ASSERT_EQ (history[126], "foo26");
+   }
+
+   {
+      /*!
+        Installing a snapshot discards all history, and we continue after the snapshot
+        even after a restart.
+       */
+      paxos::durable::segmented_log storage (directory, 10 * (16 + 5), false);
+      storage.reset (500);
+
+      PAXOS_ASSERT_EQ (storage.highest_proposal_id (), 500);
+      PAXOS_ASSERT_EQ (storage.lowest_proposal_id (), 0);
+      PAXOS_ASSERT_EQ (storage.retrieve (0).empty (), true);
+   }
+
+   {
+      paxos::durable::segmented_log storage (directory, 10 * (16 + 5), false);
+
+      PAXOS_ASSERT_EQ (storage.highest_proposal_id (), 500);
+
+      storage.accept (501, "foo1", 501);
+
+      PAXOS_ASSERT_EQ (storage.lowest_proposal_id (), 501);
+      PAXOS_ASSERT_EQ (storage.retrieve (0).size (), 1);
+
+      /*!
+        Simulate a full disk: the segment cannot grow beyond half of the next record, so
+        that record is written partially before writing fails.
+       */
+      signal (SIGXFSZ, SIG_IGN);
+
+      struct rlimit original;
+      PAXOS_ASSERT_EQ (getrlimit (RLIMIT_FSIZE, &original), 0);
+
+      struct rlimit limit = original;
+      limit.rlim_cur = 21 + 10;
+      PAXOS_ASSERT_EQ (setrlimit (RLIMIT_FSIZE, &limit), 0);
+
+      PAXOS_ASSERT_THROW (storage.accept (502, "foo2", 501),
+                          paxos::exception::storage_error);
+
+      PAXOS_ASSERT_EQ (setrlimit (RLIMIT_FSIZE, &original), 0);
+
+      PAXOS_ASSERT_EQ (storage.highest_proposal_id (), 501);
+
+      storage.accept (502, "foo2", 501);
+      storage.accept (503, "foo3", 501);
+
+      std::map <int64_t, std::string> history = storage.retrieve (500);
+      PAXOS_ASSERT_EQ (history.size (), 3);
+      PAXOS_ASSERT_EQ (history[501], "foo1");
+      PAXOS_ASSERT_EQ (history[502], "foo2");
+      PAXOS_ASSERT_EQ (history[503], "foo3");
+   }
+
+   {
+      paxos::durable::segmented_log storage (directory, 10 * (16 + 5), false);
+
+      PAXOS_ASSERT_EQ (storage.highest_proposal_id (), 503);
+      PAXOS_ASSERT_EQ (storage.retrieve (500).size (), 3);
+   }
+
+   PAXOS_ASSERT_EQ (system ("rm -rf segmented_log1.log"), 0);
+
+   PAXOS_INFO ("test succeeded");
+}
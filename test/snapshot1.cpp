@@ -0,0 +1,149 @@
+/*!
+  Tests whether a server that is replaced by a fresh server, after the history it needs has
+  been removed by the rest of the quorum, is caught up using a snapshot.
+ */
+
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <paxos++/client.hpp>
+#include <paxos++/server.hpp>
+#include <paxos++/durable/heap.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+/*!
+  The state of our application: the amount of workloads processed
+ */
+struct application
+{
+   application ()
+      : count (0)
+   {
+   }
+
+   paxos::server::callback_type
+   callback ()
+   {
+      return [this] (int64_t proposal_id, std::string const & workload) -> std::string
+         {
+            boost::mutex::scoped_lock lock (mutex);
+            ++count;
+            return "bar";
+         };
+   }
+
+   paxos::server::snapshot_callback_type
+   snapshot ()
+   {
+      return [this] () -> std::string
+         {
+            boost::mutex::scoped_lock lock (mutex);
+            return boost::lexical_cast <std::string> (count);
+         };
+   }
+
+   paxos::server::restore_callback_type
+   restore ()
+   {
+      return [this] (int64_t proposal_id, std::string const & snapshot)
+         {
+            boost::mutex::scoped_lock lock (mutex);
+            count = boost::lexical_cast <int64_t> (snapshot);
+         };
+   }
+
+   int64_t
+   processed ()
+   {
+      boost::mutex::scoped_lock lock (mutex);
+      return count;
+   }
+
+   boost::mutex mutex;
+   int64_t      count;
+};
+
+int main ()
+{
+   application application1;
+   application application2;
+   application application3;
+
+   paxos::configuration configuration1;
+   paxos::configuration configuration2;
+
+   /*!
+     Keep very little history, so that our replaced server cannot be caught up without
+     a snapshot.
+    */
+   configuration1.set_durable_storage (new paxos::durable::heap ());
+   configuration2.set_durable_storage (new paxos::durable::heap ());
+   configuration1.durable_storage ().set_history_size (10);
+   configuration2.durable_storage ().set_history_size (10);
+
+   paxos::server server1 ("127.0.0.1", 1337, application1.callback (), configuration1);
+   paxos::server server2 ("127.0.0.1", 1338, application2.callback (), configuration2);
+
+   server1.set_snapshot (application1.snapshot (), application1.restore ());
+   server2.set_snapshot (application2.snapshot (), application2.restore ());
+
+   server1.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server2.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   paxos::client client;
+   client.add  ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   {
+      paxos::configuration configuration3;
+      paxos::server server3 ("127.0.0.1", 1339, application3.callback (), configuration3);
+
+      server3.set_snapshot (application3.snapshot (), application3.restore ());
+      server3.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+      for (std::size_t i = 0; i < 5; ++i)
+      {
+         PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+      }
+
+      PAXOS_ASSERT_EQ (application3.processed (), 5);
+   }
+
+   for (std::size_t i = 0; i < 50; ++i)
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+   }
+
+   /*!
+     The quorum never removes history our stopped server has not processed yet, but it
+     did process the first proposals; a fresh server cannot be caught up from the history.
+    */
+   PAXOS_ASSERT_GT (configuration1.durable_storage ().lowest_proposal_id (), 1);
+
+   /*!
+     Replace our server with a completely fresh one, both its storage and application.
+    */
+   application application4;
+
+   paxos::configuration configuration4;
+   configuration4.set_durable_storage (new paxos::durable::heap ());
+
+   paxos::server server4 ("127.0.0.1", 1339, application4.callback (), configuration4);
+
+   server4.set_snapshot (application4.snapshot (), application4.restore ());
+   server4.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   boost::this_thread::sleep (
+      boost::posix_time::milliseconds (
+         paxos::configuration ().timeout ()));
+
+   do
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");   
+      
+   } while (application4.processed () != application1.processed ());
+
+   PAXOS_ASSERT_EQ (configuration4.durable_storage ().highest_proposal_id (),
+                    configuration1.durable_storage ().highest_proposal_id ());
+
+   PAXOS_INFO ("test succeeded");
+}
@@ -0,0 +1,67 @@
+/*!
+  Validates the sqlite durable storage backend, both with its default settings and with
+  write-ahead logging, and that its history survives reopening the database.
+ */
+
+#include <stdio.h>
+
+#include <boost/lexical_cast.hpp>
+
+#include <paxos++/durable/sqlite.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+static char const * filename = "sqlite1.sqlite";
+
+int main ()
+{
+   remove (filename);
+
+   {
+      paxos::durable::sqlite storage (filename,
+                                      paxos::durable::sqlite::journal_mode_wal,
+                                      paxos::durable::sqlite::synchronous_normal);
+      storage.set_history_size (10);
+
+      PAXOS_ASSERT_EQ (storage.highest_proposal_id (), 0);
+      PAXOS_ASSERT_EQ (storage.lowest_proposal_id (), 0);
+      PAXOS_ASSERT_EQ (storage.retrieve (0).empty (), true);
+
+      for (int64_t i = 1; i <= 25; ++i)
+      {
+         storage.accept (i,
+                         "foo" + boost::lexical_cast <std::string> (i),
+                         i);
+      }
+
+      PAXOS_ASSERT_EQ (storage.highest_proposal_id (), 25);
+
+      /*!
+        Proposal 20 triggered a cleanup of everything below 10
+       */
+      PAXOS_ASSERT_EQ (storage.lowest_proposal_id (), 10);
+
+      std::map <int64_t, std::string> history = storage.retrieve (20);
+      PAXOS_ASSERT_EQ (history.size (), 5);
+      PAXOS_ASSERT_EQ (history.begin ()->first, 21);
+      PAXOS_ASSERT_EQ (history.begin ()->second, "foo21");
+      PAXOS_ASSERT_EQ (history.rbegin ()->first, 25);
+      PAXOS_ASSERT_EQ (history.rbegin ()->second, "foo25");
+   }
+
+   {
+      paxos::durable::sqlite storage (filename);
+
+      PAXOS_ASSERT_EQ (storage.highest_proposal_id (), 25);
+      PAXOS_ASSERT_EQ (storage.lowest_proposal_id (), 10);
+
+      storage.accept (26, "foo26", 26);
+
+      std::map <int64_t, std::string> history = storage.retrieve (24);
+      PAXOS_ASSERT_EQ (history.size (), 2);
+      PAXOS_ASSERT_EQ (history[26], "foo26");
+   }
+
+   remove (filename);
+
+   PAXOS_INFO ("test succeeded");
+}
@@ -0,0 +1,152 @@
+/*!
+  Validates that a follower which accepts a proposal but never replies to it does not stall
+  the leader: once the deadline of the Paxos instance passes, the follower is treated as
+  dead and later requests are served by the remaining majority.
+ */
+
+#include <atomic>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+#include <paxos++/client.hpp>
+#include <paxos++/server.hpp>
+#include <paxos++/configuration.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+#include <paxos++/detail/strategy/factory.hpp>
+#include <paxos++/detail/strategy/basic_paxos/protocol/strategy.hpp>
+
+static std::atomic <bool> hanging (false);
+static std::atomic <bool> claimed (false);
+
+/*!
+  Milliseconds a follower has to reply, and how long the hung follower stalls
+ */
+static uint32_t const timeout = 300;
+static uint32_t const stall   = 3000;
+
+/*!
+  While hanging, a single follower stalls on the first accept request it receives
+ */
+class test_strategy : public paxos::detail::strategy::basic_paxos::protocol::strategy
+{
+public:
+   test_strategy (
+      paxos::durable::storage & storage)
+      : paxos::detail::strategy::basic_paxos::protocol::strategy::strategy (storage,
+                                                                            false,
+                                                                            false,
+                                                                            0,
+                                                                            timeout) {}
+
+   virtual void
+   accept (
+      paxos::detail::tcp_connection_ptr         leader_connection,
+      paxos::detail::command const &            command,
+      paxos::detail::quorum::server_view &      quorum,
+      paxos::detail::paxos_context &            state)
+      {
+         boost::optional <boost::asio::ip::tcp::endpoint> leader = quorum.who_is_our_leader ();
+
+         if (hanging == true
+             && leader.is_initialized () == true
+             && *leader != quorum.our_endpoint ()
+             && claimed.exchange (true) == false)
+         {
+            boost::this_thread::sleep (
+               boost::posix_time::milliseconds (stall));
+         }
+
+         paxos::detail::strategy::basic_paxos::protocol::strategy::accept (leader_connection,
+                                                                           command,
+                                                                           quorum,
+                                                                           state);
+      }
+};
+
+class test_strategy_factory : public paxos::detail::strategy::factory
+{
+public:
+
+   test_strategy_factory (
+      paxos::durable::storage & storage)
+      : storage_ (storage)
+      {
+      }
+
+   virtual paxos::detail::strategy::strategy *
+   create () const
+      {
+         return new test_strategy (storage_);
+      }
+
+private:
+   paxos::durable::storage &    storage_;
+
+};
+
+int main ()
+{
+   paxos::server::callback_type callback =
+      [](int64_t, std::string const &) -> std::string
+      {
+         return "bar";
+      };
+
+   paxos::configuration configuration1;
+   paxos::configuration configuration2;
+   paxos::configuration configuration3;
+
+   configuration1.set_strategy_factory (new test_strategy_factory (configuration1.durable_storage ()));
+   configuration2.set_strategy_factory (new test_strategy_factory (configuration2.durable_storage ()));
+   configuration3.set_strategy_factory (new test_strategy_factory (configuration3.durable_storage ()));
+
+   paxos::server server1 ("127.0.0.1", 1337, callback, configuration1);
+   paxos::server server2 ("127.0.0.1", 1338, callback, configuration2);
+   paxos::server server3 ("127.0.0.1", 1339, callback, configuration3);
+   paxos::client client;
+
+   server1.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server2.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server3.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   client.add  ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   for (std::size_t i = 0; i < 5; ++i)
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+   }
+
+   /*!
+     One of the followers now hangs on the next proposal. The client might see that
+     proposal fail and retry it, but must not wait for the follower to recover.
+    */
+   hanging = true;
+
+   boost::posix_time::ptime const started = boost::posix_time::microsec_clock::universal_time ();
+
+   PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+
+   boost::posix_time::time_duration const elapsed =
+      boost::posix_time::microsec_clock::universal_time () - started;
+
+   PAXOS_ASSERT_EQ (claimed, true);
+   PAXOS_ASSERT (elapsed < boost::posix_time::milliseconds (stall - 500));
+
+   for (std::size_t i = 0; i < 5; ++i)
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+   }
+
+   /*!
+     Once the follower recovers, the quorum keeps working
+    */
+   boost::this_thread::sleep (
+      boost::posix_time::milliseconds (stall));
+
+   for (std::size_t i = 0; i < 5; ++i)
+   {
+      PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+   }
+
+   PAXOS_INFO ("test succeeded");
+}
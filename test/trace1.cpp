@@ -0,0 +1,101 @@
+/*!
+  Validates that trace events of all threads survive a round trip through the binary trace
+  format, that each thread only keeps its most recent events, and, when tracing is enabled,
+  that a proposal leaves its trail inside the trace.
+ */
+
+#include <sstream>
+
+#include <boost/thread/thread.hpp>
+
+#include <paxos++/client.hpp>
+#include <paxos++/server.hpp>
+#include <paxos++/exception/exception.hpp>
+#include <paxos++/detail/error.hpp>
+#include <paxos++/detail/util/trace.hpp>
+#include <paxos++/detail/util/debug.hpp>
+
+using paxos::detail::util::trace;
+
+static std::string
+decode_trace ()
+{
+   std::stringstream binary;
+   trace::write (binary);
+
+   std::ostringstream text;
+   trace::decode (binary, text);
+
+   return text.str ();
+}
+
+int main ()
+{
+   boost::asio::ip::tcp::endpoint const endpoint (boost::asio::ip::address::from_string ("127.0.0.1"),
+                                                  1337);
+
+   trace::record (trace::prepare_received,
+                  42,
+                  trace::endpoint (endpoint),
+                  paxos::detail::error_no_leader);
+
+   /*!
+     Events of threads that have exited are kept
+    */
+   boost::thread thread (
+      []
+      {
+         for (int64_t i = 0; i < 100000; ++i)
+         {
+            trace::record (trace::responses_flushed, i, 0);
+         }
+      });
+   thread.join ();
+
+   std::string text = decode_trace ();
+
+   PAXOS_ASSERT (text.find ("prepare_received proposal_id=42 leader=127.0.0.1:1337 error="
+                            + paxos::detail::to_string (paxos::detail::error_no_leader)) != std::string::npos);
+
+   PAXOS_ASSERT (text.find ("responses_flushed responses=99999 latency_us=0") != std::string::npos);
+   PAXOS_ASSERT (text.find ("responses_flushed responses=0 ") == std::string::npos);
+
+   /*!
+     Garbage is not a trace
+    */
+   std::istringstream garbage ("PAXOSTRC garbage");
+   std::ostringstream ignored;
+
+   PAXOS_ASSERT_THROW (trace::decode (garbage, ignored),
+                       paxos::exception::protocol_error);
+
+#ifdef PAXOS_TRACE
+   paxos::server::callback_type callback =
+      [](int64_t proposal_id, std::string const & workload) -> std::string
+      {
+         return "bar";
+      };
+
+   paxos::server server1 ("127.0.0.1", 1337, callback);
+   paxos::server server2 ("127.0.0.1", 1338, callback);
+   paxos::server server3 ("127.0.0.1", 1339, callback);
+
+   server1.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server2.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+   server3.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   paxos::client client;
+   client.add ({{"127.0.0.1", 1337}, {"127.0.0.1", 1338}, {"127.0.0.1", 1339}});
+
+   PAXOS_ASSERT_EQ (client.send ("foo").get (), "bar");
+
+   text = decode_trace ();
+
+   PAXOS_ASSERT (text.find ("proposal_start") != std::string::npos);
+   PAXOS_ASSERT (text.find ("accept_sent") != std::string::npos);
+   PAXOS_ASSERT (text.find ("accept_received") != std::string::npos);
+   PAXOS_ASSERT (text.find ("proposal_committed") != std::string::npos);
+#endif //! PAXOS_TRACE
+
+   PAXOS_INFO ("test succeeded");
+}
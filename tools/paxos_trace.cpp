@@ -0,0 +1,58 @@
+/*!
+  Decodes a trace written by paxos::detail::util::trace::write () into one line of text per
+  event, ordered by time. Reads the trace from standard input when no file is given.
+
+  Usage:
+
+  \code
+  paxos_trace [file]
+  \endcode
+ */
+
+#include <fstream>
+#include <iostream>
+
+#include <paxos++/exception/exception.hpp>
+#include <paxos++/detail/util/trace.hpp>
+
+static void
+usage (
+   char const * program)
+{
+   std::cerr << "usage: " << program << " [file]" << std::endl;
+}
+
+int main (int argc, char ** argv)
+{
+   if (argc > 2)
+   {
+      usage (argv[0]);
+      return 1;
+   }
+
+   std::ifstream file;
+
+   if (argc == 2)
+   {
+      file.open (argv[1], std::ios::in | std::ios::binary);
+
+      if (file.is_open () == false)
+      {
+         std::cerr << "unable to open " << argv[1] << std::endl;
+         return 1;
+      }
+   }
+
+   try
+   {
+      paxos::detail::util::trace::decode (argc == 2 ? file : std::cin,
+                                          std::cout);
+   }
+   catch (paxos::exception::protocol_error const &)
+   {
+      std::cerr << "not a valid trace" << std::endl;
+      return 1;
+   }
+
+   return 0;
+}